@@ -0,0 +1,451 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Parallel multi-seed sweep runner for the training data generation
+ *
+ * Runs the (already built) scenario binary once per mobility run, in
+ * parallel worker processes. Every run gets its own output directory and
+ * RNG run number, so the runs do not interfere through the *.txt files
+ * they write in the working directory.
+ *
+ *   ./dataset_sweep_runner --program=build/scratch/ns3.40-lstm_trajectory_estimation_scenario_train-default \
+ *                          --runs=5 --jobs=5 --out=sweep -- --compressTraces=true
+ *
+ * <out>/manifest.csv keeps the state of every run (pending, running, done,
+ * failed). With --resume the runs already done are skipped and the others
+ * are queued again. Failed runs are retried up to --retries times.
+ *
+ * Build: g++ -std=c++17 -O2 -o dataset_sweep_runner dataset_sweep_runner.cc
+ *
+ * Copyright (c) 2025 WITLAB
+ */
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct RunEntry
+{
+  uint32_t run;          // index in the sweep
+  uint32_t mobRun;       // --mobRun
+  uint32_t rngRun;       // --rngRun
+  std::string status;    // pending, running, done, failed
+  int exitCode;
+  uint32_t attempts;
+  double wallSeconds;
+  std::string dir;
+};
+
+struct Options
+{
+  std::string program;
+  std::string outDir = "sweep";
+  uint32_t firstRun = 1;
+  uint32_t runs = 5;
+  uint32_t jobs = 0;
+  uint32_t retries = 1;
+  uint32_t rngRunOffset = 0;
+  bool resume = false;
+  std::vector<std::string> extraArgs;
+};
+
+volatile sig_atomic_t g_stopRequested = 0;
+
+void
+HandleStopSignal (int)
+{
+  g_stopRequested = 1;
+}
+
+void
+PrintUsage (const char *name)
+{
+  std::cerr << "Usage: " << name
+            << " --program=<scenario binary> [--runs=5] [--first=1] [--jobs=<cores>]"
+               " [--out=sweep] [--retries=1] [--rngRunOffset=0] [--resume] [-- <scenario args>]"
+            << std::endl;
+}
+
+bool
+StartsWith (const std::string &s, const std::string &prefix)
+{
+  return s.compare (0, prefix.size (), prefix) == 0;
+}
+
+bool
+ParseOptions (int argc, char *argv[], Options &opt)
+{
+  for (int i = 1; i < argc; i++)
+    {
+      std::string arg = argv[i];
+      if (arg == "--")
+        {
+          for (int j = i + 1; j < argc; j++)
+            {
+              opt.extraArgs.push_back (argv[j]);
+            }
+          break;
+        }
+      else if (StartsWith (arg, "--program="))
+        {
+          opt.program = arg.substr (10);
+        }
+      else if (StartsWith (arg, "--out="))
+        {
+          opt.outDir = arg.substr (6);
+        }
+      else if (StartsWith (arg, "--first="))
+        {
+          opt.firstRun = std::stoul (arg.substr (8));
+        }
+      else if (StartsWith (arg, "--runs="))
+        {
+          opt.runs = std::stoul (arg.substr (7));
+        }
+      else if (StartsWith (arg, "--jobs="))
+        {
+          opt.jobs = std::stoul (arg.substr (7));
+        }
+      else if (StartsWith (arg, "--retries="))
+        {
+          opt.retries = std::stoul (arg.substr (10));
+        }
+      else if (StartsWith (arg, "--rngRunOffset="))
+        {
+          opt.rngRunOffset = std::stoul (arg.substr (15));
+        }
+      else if (arg == "--resume")
+        {
+          opt.resume = true;
+        }
+      else
+        {
+          std::cerr << "Unknown option " << arg << std::endl;
+          return false;
+        }
+    }
+  if (opt.program.empty ())
+    {
+      return false;
+    }
+  if (opt.jobs == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      opt.jobs = cores > 0 ? cores : 1;
+    }
+  return true;
+}
+
+bool
+MakeDir (const std::string &path)
+{
+  if (mkdir (path.c_str (), 0755) != 0 && errno != EEXIST)
+    {
+      std::cerr << "Can't create directory " << path << ": " << strerror (errno) << std::endl;
+      return false;
+    }
+  return true;
+}
+
+// remove the regular files left by a previous (failed) attempt
+void
+CleanDir (const std::string &path)
+{
+  DIR *dir = opendir (path.c_str ());
+  if (!dir)
+    {
+      return;
+    }
+  struct dirent *entry;
+  while ((entry = readdir (dir)) != nullptr)
+    {
+      std::string file = path + "/" + entry->d_name;
+      struct stat st;
+      if (stat (file.c_str (), &st) == 0 && S_ISREG (st.st_mode))
+        {
+          unlink (file.c_str ());
+        }
+    }
+  closedir (dir);
+}
+
+std::string
+ManifestPath (const Options &opt)
+{
+  return opt.outDir + "/manifest.csv";
+}
+
+void
+WriteManifest (const Options &opt, const std::vector<RunEntry> &entries)
+{
+  // write + rename, so an interrupted runner never leaves a truncated manifest
+  std::string tmp = ManifestPath (opt) + ".tmp";
+  std::ofstream out (tmp.c_str (), std::ios_base::out | std::ios_base::trunc);
+  out << "run,mobRun,rngRun,status,exitCode,attempts,wallSeconds,dir\n";
+  for (const RunEntry &e : entries)
+    {
+      out << e.run << "," << e.mobRun << "," << e.rngRun << "," << e.status << "," << e.exitCode
+          << "," << e.attempts << "," << e.wallSeconds << "," << e.dir << "\n";
+    }
+  out.close ();
+  rename (tmp.c_str (), ManifestPath (opt).c_str ());
+}
+
+// status of the runs of a previous sweep, by mobRun
+std::map<uint32_t, RunEntry>
+ReadManifest (const Options &opt)
+{
+  std::map<uint32_t, RunEntry> previous;
+  std::ifstream in (ManifestPath (opt).c_str ());
+  std::string line;
+  std::getline (in, line); // header
+  while (std::getline (in, line))
+    {
+      std::stringstream ss (line);
+      std::vector<std::string> fields;
+      std::string field;
+      while (std::getline (ss, field, ','))
+        {
+          fields.push_back (field);
+        }
+      if (fields.size () < 8)
+        {
+          continue;
+        }
+      RunEntry e;
+      e.run = std::stoul (fields[0]);
+      e.mobRun = std::stoul (fields[1]);
+      e.rngRun = std::stoul (fields[2]);
+      e.status = fields[3];
+      e.exitCode = std::stoi (fields[4]);
+      e.attempts = std::stoul (fields[5]);
+      e.wallSeconds = std::stod (fields[6]);
+      e.dir = fields[7];
+      previous[e.mobRun] = e;
+    }
+  return previous;
+}
+
+pid_t
+LaunchRun (const Options &opt, const RunEntry &e)
+{
+  pid_t pid = fork ();
+  if (pid != 0)
+    {
+      return pid;
+    }
+
+  // child: isolated working directory, output to run.log
+  if (chdir (e.dir.c_str ()) != 0)
+    {
+      _exit (126);
+    }
+  int fd = open ("run.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0)
+    {
+      dup2 (fd, STDOUT_FILENO);
+      dup2 (fd, STDERR_FILENO);
+      close (fd);
+    }
+
+  std::vector<std::string> args;
+  args.push_back (opt.program);
+  args.push_back ("--mobRun=" + std::to_string (e.mobRun));
+  args.push_back ("--rngRun=" + std::to_string (e.rngRun));
+  args.insert (args.end (), opt.extraArgs.begin (), opt.extraArgs.end ());
+
+  std::vector<char *> argv;
+  for (std::string &a : args)
+    {
+      argv.push_back (&a[0]);
+    }
+  argv.push_back (nullptr);
+  execv (opt.program.c_str (), argv.data ());
+  _exit (127);
+}
+
+} // namespace
+
+int
+main (int argc, char *argv[])
+{
+  Options opt;
+  if (!ParseOptions (argc, argv, opt))
+    {
+      PrintUsage (argv[0]);
+      return 1;
+    }
+
+  // the runs chdir into their own directory
+  char resolved[PATH_MAX];
+  if (!realpath (opt.program.c_str (), resolved))
+    {
+      std::cerr << "Can't find program " << opt.program << std::endl;
+      return 1;
+    }
+  opt.program = resolved;
+  if (!MakeDir (opt.outDir))
+    {
+      return 1;
+    }
+
+  std::map<uint32_t, RunEntry> previous;
+  if (opt.resume)
+    {
+      previous = ReadManifest (opt);
+    }
+
+  std::vector<RunEntry> entries;
+  std::deque<size_t> queue;
+  for (uint32_t i = 0; i < opt.runs; i++)
+    {
+      RunEntry e;
+      e.run = i;
+      e.mobRun = opt.firstRun + i;
+      e.rngRun = e.mobRun + opt.rngRunOffset;
+      e.status = "pending";
+      e.exitCode = -1;
+      e.attempts = 0;
+      e.wallSeconds = 0;
+      e.dir = opt.outDir + "/run_" + std::to_string (e.mobRun);
+
+      auto it = previous.find (e.mobRun);
+      if (it != previous.end () && it->second.status == "done")
+        {
+          e = it->second;
+          e.run = i;
+          std::cout << "✅ mobRun " << e.mobRun << " already done, skipped" << std::endl;
+        }
+      else
+        {
+          queue.push_back (entries.size ());
+        }
+      entries.push_back (e);
+    }
+  WriteManifest (opt, entries);
+
+  struct sigaction sa;
+  memset (&sa, 0, sizeof (sa));
+  sa.sa_handler = HandleStopSignal;
+  sigaction (SIGINT, &sa, nullptr);
+  sigaction (SIGTERM, &sa, nullptr);
+
+  std::cout << "🚀 " << queue.size () << " runs queued, " << opt.jobs << " parallel jobs"
+            << std::endl;
+
+  std::map<pid_t, size_t> running;
+  std::map<pid_t, std::chrono::steady_clock::time_point> startTimes;
+  auto sweepStart = std::chrono::steady_clock::now ();
+
+  while (!queue.empty () || !running.empty ())
+    {
+      while (!g_stopRequested && !queue.empty () && running.size () < opt.jobs)
+        {
+          size_t idx = queue.front ();
+          queue.pop_front ();
+          RunEntry &e = entries[idx];
+          if (!MakeDir (e.dir))
+            {
+              e.status = "failed";
+              continue;
+            }
+          CleanDir (e.dir);
+          e.attempts++;
+          e.status = "running";
+          pid_t pid = LaunchRun (opt, e);
+          if (pid < 0)
+            {
+              std::cerr << "fork failed: " << strerror (errno) << std::endl;
+              e.status = "failed";
+              continue;
+            }
+          running[pid] = idx;
+          startTimes[pid] = std::chrono::steady_clock::now ();
+          std::cout << "▶️  mobRun " << e.mobRun << " (rngRun " << e.rngRun << ", attempt "
+                    << e.attempts << ") in " << e.dir << std::endl;
+          WriteManifest (opt, entries);
+        }
+
+      if (running.empty ())
+        {
+          break; // stop requested with nothing left running
+        }
+
+      int status = 0;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          break;
+        }
+      auto it = running.find (pid);
+      if (it == running.end ())
+        {
+          continue;
+        }
+      RunEntry &e = entries[it->second];
+      e.wallSeconds =
+          std::chrono::duration<double> (std::chrono::steady_clock::now () - startTimes[pid])
+              .count ();
+      e.exitCode = WIFEXITED (status) ? WEXITSTATUS (status) : 128 + WTERMSIG (status);
+      if (WIFEXITED (status) && e.exitCode == 0)
+        {
+          e.status = "done";
+          std::cout << "✅ mobRun " << e.mobRun << " done in " << e.wallSeconds << " s"
+                    << std::endl;
+        }
+      else if (!g_stopRequested && e.attempts <= opt.retries)
+        {
+          e.status = "pending";
+          queue.push_back (it->second);
+          std::cout << "🔁 mobRun " << e.mobRun << " failed (" << e.exitCode << "), retrying"
+                    << std::endl;
+        }
+      else
+        {
+          e.status = "failed";
+          std::cout << "❌ mobRun " << e.mobRun << " failed (" << e.exitCode << "), see "
+                    << e.dir << "/run.log" << std::endl;
+        }
+      running.erase (it);
+      startTimes.erase (pid);
+      WriteManifest (opt, entries);
+    }
+
+  uint32_t done = 0;
+  for (const RunEntry &e : entries)
+    {
+      done += e.status == "done";
+    }
+  double sweepSeconds =
+      std::chrono::duration<double> (std::chrono::steady_clock::now () - sweepStart).count ();
+  std::cout << "───────────────────────────────────────" << std::endl;
+  std::cout << done << "/" << entries.size () << " runs done in " << sweepSeconds
+            << " s, manifest " << ManifestPath (opt) << std::endl;
+  if (g_stopRequested)
+    {
+      std::cout << "Interrupted, continue with --resume" << std::endl;
+    }
+  return done == entries.size () ? 0 : 1;
+}
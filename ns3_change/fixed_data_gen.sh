@@ -2,13 +2,57 @@
 
 echo "🚀 Starting SINR-based UE Position Tracking Data Generation"
 
+# COMPRESS=1 이면 시뮬레이터가 KPM/위치 trace를 .gz(+.idx)로 직접 기록 → tar 단계 생략
+COMPRESS=${COMPRESS:-0}
+if [ "${COMPRESS}" -eq 1 ]; then
+    COMPRESS_ARG="--compressTraces=true"
+else
+    COMPRESS_ARG=""
+fi
+
+# TRAFFIC_MODE=keepalive|none 이면 UE당 2000 pkt/s CBR 대신 저부하 트래픽 (SINR/위치 수집 전용 런)
+TRAFFIC_MODE=${TRAFFIC_MODE:-cbr}
+# EXECUTION_MODE=analytic 이면 PHY/MAC 스택 없이 path loss 모델로 cu-cp SINR + 위치만 생성
+# fading/beamforming 이 없어 full 런과 다를 수 있으므로, 같은 mobRun 의 full/analytic 쌍을
+# 먼저 검증하고 그 PASS 리포트를 ANALYTIC_VALIDATION 으로 넘겨야 실행된다:
+#   python/validate_analytic_sinr.py --full <full 런> --analytic <analytic 런> --report analytic_validation.txt
+EXECUTION_MODE=${EXECUTION_MODE:-full}
+if [ "${EXECUTION_MODE}" = "analytic" ]; then
+    if [ -z "${ANALYTIC_VALIDATION}" ] || ! grep -q '^result=PASS$' "${ANALYTIC_VALIDATION}" 2>/dev/null; then
+        echo "❌ EXECUTION_MODE=analytic needs ANALYTIC_VALIDATION=<passing validate_analytic_sinr.py --report>"
+        exit 1
+    fi
+    echo "Analytic mode validated by ${ANALYTIC_VALIDATION}:"
+    cat "${ANALYTIC_VALIDATION}"
+fi
+# PATH_GAIN_MAP=path_gain.bin (절대 경로) 이면 Sionna RT 격자로 pathloss/LOS (sionna-rt/export_path_gain.py)
+PATH_GAIN_MAP=${PATH_GAIN_MAP:-}
+SIM_ARGS="${COMPRESS_ARG} --trafficMode=${TRAFFIC_MODE} --executionMode=${EXECUTION_MODE}"
+SIM_ARGS="${SIM_ARGS}${PATH_GAIN_MAP:+ --pathGainMap=${PATH_GAIN_MAP}}"
+# ML_SEQUENCES=1 이면 런마다 ml_sequences.bin (python/ml_sequences.py) 도 출력, 오프라인 병합 불필요
+SIM_ARGS="${SIM_ARGS}${ML_SEQUENCES:+ --mlSequenceFile=ml_sequences.bin}"
+
+# PARALLEL=1 이면 dataset_sweep_runner로 5개 런을 코어 수만큼 병렬 실행
+# (런별 출력 디렉토리 sweep/run_<i>, rngRun 분리, sweep/manifest.csv, 실패 시 --resume)
+PARALLEL=${PARALLEL:-0}
+if [ "${PARALLEL}" -eq 1 ]; then
+    ./ns3 build scratch/lstm_trajectory_estimation_scenario_train.cc || exit 1
+    PROGRAM=$(find build -type f -perm -u+x -name '*lstm_trajectory_estimation_scenario_train*' | head -n 1)
+    SWEEP_RUNNER=${SWEEP_RUNNER:-./dataset_sweep_runner}
+    if [ ! -x "${SWEEP_RUNNER}" ]; then
+        g++ -std=c++17 -O2 -o "${SWEEP_RUNNER}" "${SWEEP_RUNNER_SRC:-dataset_sweep_runner.cc}" || exit 1
+    fi
+    "${SWEEP_RUNNER}" --program="${PROGRAM}" --runs=5 --out=sweep ${RESUME:+--resume} -- ${SIM_ARGS}
+    exit $?
+fi
+
 # 5회 반복 (각기 다른 모빌리티 패턴)
 for i in $(seq 1 5); do
     echo "=== Mobility Run ${i} Simulation ==="
     
     # 1) 시드/모빌리티 런을 바꿔서 시뮬레이션 실행
     echo "Running with mobility run: ${i}"
-    ./ns3 run "scratch/lstm_trajectory_estimation_scenario_train.cc --mobRun=${i}"
+    ./ns3 run "scratch/lstm_trajectory_estimation_scenario_train.cc --mobRun=${i} ${SIM_ARGS}"
     
     # 실행 성공 여부 체크
     if [ $? -ne 0 ]; then
@@ -16,6 +60,18 @@ for i in $(seq 1 5); do
         continue
     fi
     
+    if [ "${COMPRESS}" -eq 1 ]; then
+        # 2') 이미 압축된 출력은 런별 디렉토리로 이동만 (rename, 재기록 없음)
+        RUN_DIR="data_lstm_mobrun_${i}"
+        mkdir -p "${RUN_DIR}"
+        find . -maxdepth 1 -type f \( -name '*.txt.gz' -o -name '*.txt.gz.idx' -o -name '*.txt' \) \
+             ! -name 'CMakeLists.txt' \
+             -exec mv -t "${RUN_DIR}" {} +
+        echo "✅ Run ${i} outputs moved to ${RUN_DIR}/"
+        echo "───────────────────────────────────────"
+        continue
+    fi
+
     # 2) txt 파일 압축 (런 번호 포함)
     ARCHIVE_NAME="data_lstm_mobrun_${i}.tar.gz"
     echo "Archiving txt files ⇒ ${ARCHIVE_NAME}"
@@ -19,6 +19,7 @@
 #include "ns3/applications-module.h"
 #include "ns3/point-to-point-helper.h"
 #include <ns3/lte-ue-net-device.h>
+#include <ns3/lte-enb-rrc.h>
 #include "ns3/mmwave-helper.h"
 #include "ns3/epc-helper.h"
 #include "ns3/mmwave-point-to-point-epc-helper.h"
@@ -34,8 +35,21 @@
 #include <chrono>
 #include <cmath>
 #include <fstream>
+#include <unordered_map>
+#include <sstream>
 #include "ns3/isotropic-antenna-model.h"
 #include "ns3/mmwave-bearer-stats-connector.h"
+#include "ns3/mmwave-trace-file-writer.h"
+#include "ns3/simulation-telemetry.h"
+#include "ns3/three-gpp-propagation-loss-model.h"
+#include "ns3/channel-condition-model.h"
+#include "ns3/sionna-path-gain-model.h"
+#include <ns3/mmwave-indication-message-helper.h>
+#include <numeric>
+#include <deque>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 using namespace ns3;
 using namespace mmwave;
@@ -46,10 +60,18 @@ std::map<uint16_t, std::set<uint64_t>> imsi_list;
 std::map<uint16_t, Ptr<Node>> cellid_node;
 std::map<uint32_t, uint16_t> ue_cellid_usinghandover;
 std::map<uint64_t, uint32_t> ueimsi_nodeid;
-int ue_assoc_list[100] = {0}; // Increased for 56 UEs
+std::unordered_map<uint64_t, uint16_t> ue_serving_cell; // imsi -> serving mmWave cell, from the RRC traces
+std::set<uint16_t> mmwave_cell_ids;
+std::vector<uint64_t> ue_imsi; // imsi of ueNodes.Get(u)
 double maxXAxis;
 double maxYAxis;
 
+// Position/BS trace writers, kept open for the whole run
+TraceFileWriter::Compression trace_compression = TraceFileWriter::NONE;
+Ptr<TraceFileWriter> ue_position_writer;
+Ptr<TraceFileWriter> enb_writer;
+Ptr<TraceFileWriter> gnb_writer;
+
 NS_LOG_COMPONENT_DEFINE ("PositionPredictionScenario");
 
 void
@@ -91,116 +113,498 @@ PrintGnuplottableUeListToFile(std::string filename) {
 }
 
 void
-PrintGnuplottableEnbListToFile(uint64_t m_startTime) {
+PrintGnuplottableEnbListToFile(NetDeviceContainer lteEnbDevs, NetDeviceContainer mmWaveEnbDevs,
+                               uint64_t m_startTime) {
+    // base stations do not move, their positions are written once
     uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now().GetMilliSeconds();
     
-    std::string filename1 = "enbs.txt";
-    std::string filename2 = "gnbs.txt";
+    std::ostringstream enbRows;
+    std::ostringstream gnbRows;
     
-    for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
-        Ptr<Node> node = *it;
-        int nDevs = node->GetNDevices();
-        for (int j = 0; j < nDevs; j++) {
-            Ptr<LteEnbNetDevice> enbdev = node->GetDevice(j)->GetObject<LteEnbNetDevice>();
-            Ptr<MmWaveEnbNetDevice> mmdev = node->GetDevice(j)->GetObject<MmWaveEnbNetDevice>();
-            if (enbdev) {
-                Vector pos = node->GetObject<MobilityModel>()->GetPosition();
-                std::ofstream outFile1;
-                outFile1.open(filename1.c_str(), std::ios_base::out | std::ios_base::app);
-                if (!outFile1.is_open()) {
-                    NS_LOG_ERROR("Can't open file " << filename1);
-                    return;
-                }
-                // Simplified output format (removed energy data)
-                outFile1 << timestamp << "," << enbdev->GetCellId() << "," << pos.x << "," << pos.y << ","
-                         << m_startTime << std::endl;
-                outFile1.close();
-            } else if (mmdev) {
-                Vector pos = node->GetObject<MobilityModel>()->GetPosition();
-                std::ofstream outFile2;
-                outFile2.open(filename2.c_str(), std::ios_base::out | std::ios_base::app);
-                if (!outFile2.is_open()) {
-                    NS_LOG_ERROR("Can't open file " << filename2);
-                    return;
-                }
-                
-                // Track UE associations for position prediction
-                auto ueMap = mmdev->GetUeMap();
-                for (const auto &ue: ueMap) {
-                    uint64_t imsi_assoc = ue.second->GetImsi();
-                    ue_assoc_list[imsi_assoc - 1] = mmdev->GetCellId();
-                }
-                
-                uint16_t cell_id = mmdev->GetCellId();
-                // Simplified output format (removed energy data)
-                outFile2 << timestamp << "," << cell_id << "," << pos.x << "," << pos.y << ","
-                         << m_startTime << std::endl;
-                outFile2.close();
-            }
-        }
+    for (uint32_t i = 0; i < lteEnbDevs.GetN(); i++) {
+        Ptr<LteEnbNetDevice> enbdev = DynamicCast<LteEnbNetDevice>(lteEnbDevs.Get(i));
+        Vector pos = enbdev->GetNode()->GetObject<MobilityModel>()->GetPosition();
+        // Simplified output format (removed energy data)
+        enbRows << timestamp << "," << enbdev->GetCellId() << "," << pos.x << "," << pos.y << ","
+                << m_startTime << "\n";
+    }
+    for (uint32_t i = 0; i < mmWaveEnbDevs.GetN(); i++) {
+        Ptr<MmWaveEnbNetDevice> mmdev = DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(i));
+        Vector pos = mmdev->GetNode()->GetObject<MobilityModel>()->GetPosition();
+        gnbRows << timestamp << "," << mmdev->GetCellId() << "," << pos.x << "," << pos.y << ","
+                << m_startTime << "\n";
     }
+
+    enb_writer->Write(timestamp, enbRows.str());
+    gnb_writer->Write(timestamp, gnbRows.str());
 }
 
+// ConnectionEstablished / HandoverEndOk: fired by the RRC of the new serving cell
 void
-ClearFile(std::string Filename, uint64_t m_startTime) {
-    std::string filename = Filename;
-    std::ofstream outFile;
-    outFile.open(filename.c_str(), std::ios_base::out | std::ios_base::trunc);
-    if (!outFile.is_open()) {
-        NS_LOG_ERROR("Can't open file " << filename);
-        return;
+NotifyUeServingCell(std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti) {
+    // the LTE eNB fires them too, only the mmWave cell is logged
+    if (mmwave_cell_ids.find(cellId) != mmwave_cell_ids.end()) {
+        ue_serving_cell[imsi] = cellId;
     }
-    outFile.close();
+}
+
+// UeContextRemoved: the source context is released after HandoverEndOk at the target,
+// so the entry is dropped only if it still points to this cell (RLF, release)
+void
+NotifyUeServingCellRemoved(std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti) {
+    auto it = ue_serving_cell.find(imsi);
+    if (it != ue_serving_cell.end() && it->second == cellId) {
+        ue_serving_cell.erase(it);
+    }
+}
+
+Ptr<TraceFileWriter>
+ClearFile(std::string Filename, uint64_t m_startTime) {
+    // truncates the file (or <Filename>.gz when compression is on) and writes the header
+    Ptr<TraceFileWriter> writer = Create<TraceFileWriter>(Filename, trace_compression);
     
     uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now().GetMilliSeconds();
-    std::ofstream outFile1;
-    outFile1.open(filename.c_str(), std::ios_base::out | std::ios_base::app);
+    std::ostringstream header;
 
     if (Filename == "ue_position.txt") {
-        outFile1 << "timestamp,id,x,y,type,cell,simid" << std::endl;
+        header << "timestamp,id,x,y,type,cell,simid" << "\n";
     } else {
-        outFile1 << "timestamp,id,x,y,simid" << std::endl;
-        outFile1 << timestamp << "," << "0" << "," << maxXAxis << "," << maxYAxis << std::endl;
+        header << "timestamp,id,x,y,simid" << "\n";
+        header << timestamp << "," << "0" << "," << maxXAxis << "," << maxYAxis << "\n";
     }
-    outFile1.close();
+    writer->Write(timestamp, header.str());
+    return writer;
 }
 
 void
-PrintPosition(Ptr<Node> node, int iterator, std::string Filename, uint64_t m_startTime) {
+SampleUePositions(NodeContainer ueNodes, Time period, uint64_t m_startTime) {
+    // one event per period for all the UEs, rows go to the persistent position sink
     uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now().GetMilliSeconds();
 
-    int imsi;
-    Ptr<Node> node1 = NodeList::GetNode(iterator);
-    int nDevs = node->GetNDevices();
-    std::string filename = Filename;
-    std::ofstream outFile;
-    for (int j = 0; j < nDevs; j++) {
-        Ptr<McUeNetDevice> mcuedev = node1->GetDevice(j)->GetObject<McUeNetDevice>();
-        if (mcuedev) {
-            imsi = int(mcuedev->GetImsi());
-            int serving_cell = ue_assoc_list[imsi - 1];
-            if (serving_cell == 0) {
-                serving_cell = 1;
+    std::ostringstream rows;
+    for (uint32_t u = 0; u < ueNodes.GetN(); u++) {
+        int imsi = int(ue_imsi[u]);
+        auto servingIt = ue_serving_cell.find(imsi);
+        int serving_cell = servingIt != ue_serving_cell.end() ? servingIt->second : 1;
+        Vector position = ueNodes.Get(u)->GetObject<MobilityModel>()->GetPosition();
+        rows << timestamp << "," << imsi << "," << position.x << "," << position.y << ",mc,"
+             << serving_cell << "," << m_startTime << "\n";
+    }
+    ue_position_writer->Write(timestamp, rows.str());
+
+    Simulator::Schedule(period, &SampleUePositions, ueNodes, period, m_startTime);
+}
+
+// sim/wall time, events, queue depth, RSS and report/HO/SINR counters (telemetryFile)
+Ptr<SimulationTelemetry>
+StartTelemetry() {
+    DoubleValue doubleValue;
+    StringValue stringValue;
+    BooleanValue booleanValue;
+    GlobalValue::GetValueByName("telemetryInterval", doubleValue);
+    GlobalValue::GetValueByName("telemetryFile", stringValue);
+    GlobalValue::GetValueByName("telemetryPendingEvents", booleanValue);
+    if (doubleValue.Get() <= 0) {
+        return nullptr;
+    }
+    Ptr<SimulationTelemetry> telemetry =
+        Create<SimulationTelemetry>(stringValue.Get(), Seconds(doubleValue.Get()));
+    telemetry->ConnectTraces();
+    telemetry->Start(booleanValue.Get());
+    return telemetry;
+}
+
+// ML-ready sequences (mlSequenceFile): the join of make_csv_split_offline.py done at
+// every indication period instead of offline. For each UE with a serving cell and at
+// least mlTopK neighbour readings one row of float32 is kept:
+//   t [s], serving x, y, serving SINR 3gpp, top-K neighbour SINR 3gpp, UE x, y
+// where the SINR columns are moving averages over mlSmoothingWindow seconds, as the
+// _ma columns of the offline csv. The file is written after the run:
+//   "MLSQ", uint32 version=1, numUes, numFeatures, topK, reserved, double period
+//   numUes x {uint64 imsi, uint64 numSteps}
+//   float32 rows[numSteps][numFeatures] of each UE, in the same order
+// (python/ml_sequences.py loads it).
+struct MlUeSequence {
+    std::deque<std::vector<double>> window; // SINR columns of the last samples
+    std::vector<double> windowSum;
+    std::vector<float> rows;
+};
+struct MlSinrReading {
+    double db;
+    Time time;
+};
+std::unordered_map<uint64_t, std::map<uint16_t, MlSinrReading>> ml_sinr_db; // imsi -> cell -> latest L3 SINR
+Time ml_sinr_max_age; // MmWaveEnbNetDevice::L3SinrMaxAge, 0 to keep every reading
+std::map<uint16_t, Vector> ml_cell_position;
+std::vector<MlUeSequence> ml_sequences; // index as ue_imsi, empty when disabled
+uint32_t ml_top_k;
+size_t ml_window;
+
+uint32_t
+GetMlNumFeatures() {
+    return 6 + ml_top_k;
+}
+
+// NotifyMmWaveSinr: L3 SINR (linear) reported by the UE for a mmWave cell
+void
+NotifyMlSinr(std::string context, uint64_t imsi, uint16_t cellId, long double sinr) {
+    ml_sinr_db[imsi][cellId] = {10 * std::log10((double) sinr), Simulator::Now()};
+}
+
+// same age-out as the neighbour readings of the CuCp report
+bool
+IsMlSinrFresh(const MlSinrReading &reading) {
+    return ml_sinr_max_age.IsZero() || Simulator::Now() - reading.time <= ml_sinr_max_age;
+}
+
+void
+SampleMlSequences(NodeContainer ueNodes, Time period) {
+    std::vector<double> sinr(1 + ml_top_k);
+    std::vector<double> neighbours;
+    for (uint32_t u = 0; u < ueNodes.GetN(); u++) {
+        uint64_t imsi = ue_imsi[u];
+        auto servingIt = ue_serving_cell.find(imsi);
+        auto sinrIt = ml_sinr_db.find(imsi);
+        if (servingIt == ue_serving_cell.end() || sinrIt == ml_sinr_db.end()) {
+            continue;
+        }
+        auto servingSinr = sinrIt->second.find(servingIt->second);
+        if (servingSinr == sinrIt->second.end() || !IsMlSinrFresh(servingSinr->second)) {
+            continue;
+        }
+
+        neighbours.clear();
+        for (auto &cell : sinrIt->second) {
+            if (cell.first != servingIt->second && IsMlSinrFresh(cell.second)) {
+                neighbours.push_back(cell.second.db);
             }
-            Ptr<MobilityModel> model = node->GetObject<MobilityModel>();
-            Vector position = model->GetPosition();
-            
-            /*NS_LOG_UNCOND("Position of UE with IMSI " << imsi << " is " << model->GetPosition()
-                                                     << " at time "
-                                                     << Simulator::Now().GetSeconds()
-                                                     << ", UE connected to Cell: " << serving_cell);*/
-            
-            outFile.open(filename.c_str(), std::ios_base::out | std::ios_base::app);
-            if (!outFile.is_open()) {
-                NS_LOG_ERROR("Can't open file " << filename);
-                return;
+        }
+        // rows with fewer neighbours are dropped offline as well
+        if (neighbours.size() < ml_top_k) {
+            continue;
+        }
+        std::partial_sort(neighbours.begin(), neighbours.begin() + ml_top_k, neighbours.end(),
+                          std::greater<double>());
+        sinr[0] = L3RrcMeasurements::ThreeGppMapSinr(servingSinr->second.db);
+        for (uint32_t k = 0; k < ml_top_k; k++) {
+            sinr[1 + k] = L3RrcMeasurements::ThreeGppMapSinr(neighbours[k]);
+        }
+
+        MlUeSequence &seq = ml_sequences[u];
+        if (seq.windowSum.empty()) {
+            seq.windowSum.assign(sinr.size(), 0);
+        }
+        seq.window.push_back(sinr);
+        for (size_t i = 0; i < sinr.size(); i++) {
+            seq.windowSum[i] += sinr[i];
+        }
+        if (seq.window.size() > ml_window) {
+            for (size_t i = 0; i < sinr.size(); i++) {
+                seq.windowSum[i] -= seq.window.front()[i];
             }
+            seq.window.pop_front();
+        }
 
-            outFile << timestamp << "," << imsi << "," << position.x << "," << position.y << ",mc,"
-                    << serving_cell << "," << m_startTime << std::endl;
-            outFile.close();
+        Vector cellPos = ml_cell_position[servingIt->second];
+        Vector uePos = ueNodes.Get(u)->GetObject<MobilityModel>()->GetPosition();
+        seq.rows.push_back(Simulator::Now().GetSeconds());
+        seq.rows.push_back(cellPos.x);
+        seq.rows.push_back(cellPos.y);
+        for (size_t i = 0; i < sinr.size(); i++) {
+            seq.rows.push_back(seq.windowSum[i] / seq.window.size());
         }
+        seq.rows.push_back(uePos.x);
+        seq.rows.push_back(uePos.y);
     }
+
+    Simulator::Schedule(period, &SampleMlSequences, ueNodes, period);
+}
+
+// Reads the ml* global values and schedules the sampling, cell positions must be set
+void
+SetupMlSequences(NodeContainer ueNodes, double indicationPeriodicity, double simTime) {
+    StringValue stringValue;
+    UintegerValue uintegerValue;
+    DoubleValue doubleValue;
+    GlobalValue::GetValueByName("mlSequenceFile", stringValue);
+    if (stringValue.Get().empty()) {
+        return;
+    }
+    GlobalValue::GetValueByName("mlTopK", uintegerValue);
+    ml_top_k = uintegerValue.Get();
+    GlobalValue::GetValueByName("mlSmoothingWindow", doubleValue);
+    ml_window = std::max<size_t>(1, size_t(doubleValue.Get() / indicationPeriodicity));
+    ml_sequences.assign(ueNodes.GetN(), MlUeSequence());
+    TypeId::AttributeInformation info;
+    TypeId::LookupByName("ns3::MmWaveEnbNetDevice").LookupAttributeByName("L3SinrMaxAge", &info);
+    ml_sinr_max_age = DynamicCast<const TimeValue>(info.initialValue)->Get();
+    size_t rowsPerUe = (size_t(simTime / indicationPeriodicity) + 1) * GetMlNumFeatures();
+    for (MlUeSequence &seq : ml_sequences) {
+        seq.rows.reserve(rowsPerUe);
+    }
+
+    NS_LOG_UNCOND("ML sequences: " << stringValue.Get() << ", top " << ml_top_k
+                  << " neighbours, moving average over " << ml_window << " samples, readings older than "
+                  << ml_sinr_max_age.GetSeconds() << " s dropped");
+    Simulator::Schedule(Seconds(indicationPeriodicity), &SampleMlSequences, ueNodes,
+                        Seconds(indicationPeriodicity));
+}
+
+void
+WriteMlSequences(double indicationPeriodicity) {
+    if (ml_sequences.empty()) {
+        return;
+    }
+    StringValue stringValue;
+    GlobalValue::GetValueByName("mlSequenceFile", stringValue);
+    std::string filename = stringValue.Get();
+    std::ofstream out(filename.c_str(), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+    if (!out.is_open()) {
+        NS_FATAL_ERROR("Can't open file " << filename);
+    }
+
+    uint32_t numFeatures = GetMlNumFeatures();
+    uint32_t header[6] = {0, 1, uint32_t(ml_sequences.size()), numFeatures, ml_top_k, 0};
+    std::memcpy(header, "MLSQ", 4);
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(&indicationPeriodicity), sizeof(double));
+
+    uint64_t totalSteps = 0;
+    for (size_t u = 0; u < ml_sequences.size(); u++) {
+        uint64_t entry[2] = {ue_imsi[u], ml_sequences[u].rows.size() / numFeatures};
+        out.write(reinterpret_cast<const char *>(entry), sizeof(entry));
+        totalSteps += entry[1];
+    }
+    for (MlUeSequence &seq : ml_sequences) {
+        out.write(reinterpret_cast<const char *>(seq.rows.data()), seq.rows.size() * sizeof(float));
+    }
+    out.close();
+    NS_LOG_UNCOND("ML sequences saved to: " << filename << " (" << ml_sequences.size() << " UEs, "
+                  << totalSteps << " steps, " << numFeatures << " features)");
+}
+
+// Analytic measurement-only mode (executionMode=analytic): the PHY/MAC/RLC stack is
+// not installed. At every indication period the L3 SINR of each UE towards each gNB
+// is computed from the same ThreeGppUmiStreetCanyon path loss and channel condition
+// models, one isotropic element at both ends and thermal noise. Small-scale fading
+// is not modelled and every other gNB counts as a full-power interferer.
+struct AnalyticCell {
+    uint16_t cellId;
+    Ptr<MobilityModel> mobility;
+    Ptr<TraceFileWriter> cuCpWriter;
+};
+std::vector<AnalyticCell> analytic_cells;
+std::vector<size_t> analytic_serving;   // UE index -> index in analytic_cells
+Ptr<ThreeGppPropagationLossModel> analytic_pathloss;
+double analytic_tx_power_dbm;
+double analytic_noise_mw;
+double analytic_ho_sinr_difference;
+
+void
+SampleAnalyticSinr(NodeContainer ueNodes, Time period, uint64_t m_startTime) {
+    uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now().GetMilliSeconds();
+    uint32_t nUes = ueNodes.GetN();
+    size_t nCells = analytic_cells.size();
+
+    // received power [mW], one row of nCells per UE
+    std::vector<double> rxPower(nUes * nCells);
+    for (uint32_t u = 0; u < nUes; u++) {
+        Ptr<MobilityModel> ueMob = ueNodes.Get(u)->GetObject<MobilityModel>();
+        for (size_t c = 0; c < nCells; c++) {
+            double rxDbm = analytic_pathloss->CalcRxPower(analytic_tx_power_dbm,
+                                                          analytic_cells[c].mobility, ueMob);
+            rxPower[u * nCells + c] = std::pow(10.0, rxDbm / 10.0);
+        }
+    }
+
+    std::vector<std::string> uePms(nUes);
+    std::vector<uint32_t> numActiveUes(nCells, 0);
+    std::vector<double> sinrDb(nCells);
+    std::vector<size_t> order(nCells);
+    for (uint32_t u = 0; u < nUes; u++) {
+        const double *p = &rxPower[u * nCells];
+        double total = std::accumulate(p, p + nCells, 0.0);
+        size_t best = 0;
+        for (size_t c = 0; c < nCells; c++) {
+            sinrDb[c] = 10 * std::log10(p[c] / (analytic_noise_mw + total - p[c]));
+            if (sinrDb[c] > sinrDb[best]) {
+                best = c;
+            }
+        }
+        if (!ml_sequences.empty()) {
+            std::map<uint16_t, MlSinrReading> &mlSinr = ml_sinr_db[ue_imsi[u]];
+            for (size_t c = 0; c < nCells; c++) {
+                mlSinr[analytic_cells[c].cellId] = {sinrDb[c], Simulator::Now()};
+            }
+        }
+
+        // serving cell, with the HoSinrDifference hysteresis of the RRC
+        size_t &serving = analytic_serving[u];
+        if (serving >= nCells || sinrDb[best] - sinrDb[serving] >= analytic_ho_sinr_difference) {
+            serving = best;
+        }
+        numActiveUes[serving]++;
+        uint16_t servingCellId = analytic_cells[serving].cellId;
+        ue_serving_cell[ue_imsi[u]] = servingCellId;
+
+        // numDrb (1, default bearer), 0, serving cell, imsi, SINR, SINR 3gpp
+        std::string servingStr = "1,0," + std::to_string(servingCellId) + "," +
+                                 std::to_string(ue_imsi[u]) + "," + std::to_string(sinrDb[serving]) +
+                                 "," + std::to_string(L3RrcMeasurements::ThreeGppMapSinr(sinrDb[serving]));
+
+        // same neighbour list as BuildRicIndicationMessageCuCp: best first, serving
+        // cell with a negative ID, E2SM_REPORT_MAX_NEIGH entries (or all cells but one)
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&sinrDb](size_t a, size_t b) { return sinrDb[a] > sinrDb[b]; });
+        size_t nNeighbours = MmWaveEnbNetDevice::E2SM_REPORT_MAX_NEIGH;
+        if (nCells < nNeighbours) {
+            nNeighbours = nCells - 1;
+        }
+        std::string neighStr;
+        for (size_t i = 0; i < nNeighbours; i++) {
+            size_t c = order[i];
+            long cellId = analytic_cells[c].cellId;
+            if (c == serving) {
+                cellId *= -1;
+            }
+            neighStr += "," + std::to_string(cellId) + "," + std::to_string(sinrDb[c]) + "," +
+                        std::to_string(L3RrcMeasurements::ThreeGppMapSinr(sinrDb[c]));
+        }
+        for (size_t i = nNeighbours; i < MmWaveEnbNetDevice::E2SM_REPORT_MAX_NEIGH; i++) {
+            neighStr += ",,,";
+        }
+        uePms[u] = servingStr + neighStr;
+    }
+
+    std::vector<std::string> rows(nCells);
+    for (uint32_t u = 0; u < nUes; u++) {
+        size_t c = analytic_serving[u];
+        rows[c] += std::to_string(timestamp) + "," + MmWaveEnbNetDevice::GetImsiString(ue_imsi[u]) + "," +
+                   std::to_string(numActiveUes[c]) + "," + uePms[u] + "\n";
+    }
+    for (size_t c = 0; c < nCells; c++) {
+        if (!rows[c].empty()) {
+            analytic_cells[c].cuCpWriter->Write(timestamp, rows[c]);
+        }
+    }
+
+    Simulator::Schedule(period, &SampleAnalyticSinr, ueNodes, period, m_startTime);
+}
+
+double
+GetDoubleDefault(std::string typeName, std::string attributeName) {
+    // initial value of the attribute, including the Config::SetDefault overrides
+    TypeId::AttributeInformation info;
+    if (!TypeId::LookupByName(typeName).LookupAttributeByName(attributeName, &info)) {
+        NS_FATAL_ERROR("No attribute " << attributeName << " in " << typeName);
+    }
+    return DynamicCast<const DoubleValue>(info.initialValue)->Get();
+}
+
+int
+RunAnalyticMeasurements(NodeContainer ueNodes, NodeContainer lteEnbNodes,
+                        NodeContainer mmWaveEnbNodes, double bandwidth, double hoSinrDifference) {
+    DoubleValue doubleValue;
+    GlobalValue::GetValueByName("simTime", doubleValue);
+    double simTime = doubleValue.Get();
+    GlobalValue::GetValueByName("indicationPeriodicity", doubleValue);
+    double indicationPeriodicity = doubleValue.Get();
+    GlobalValue::GetValueByName("positionSamplingPeriod", doubleValue);
+    double samplingPeriod = doubleValue.Get();
+
+    analytic_tx_power_dbm = GetDoubleDefault("ns3::MmWaveEnbPhy", "TxPower");
+    double noiseFigure = GetDoubleDefault("ns3::MmWaveUePhy", "NoiseFigure");
+    analytic_noise_mw = std::pow(10.0, (-174 + 10 * std::log10(bandwidth) + noiseFigure) / 10.0);
+    analytic_ho_sinr_difference = hoSinrDifference;
+
+    StringValue stringValue;
+    GlobalValue::GetValueByName("pathGainMap", stringValue);
+    if (stringValue.Get().empty()) {
+        analytic_pathloss = CreateObject<ThreeGppUmiStreetCanyonPropagationLossModel>();
+        analytic_pathloss->SetChannelConditionModel(
+            CreateObject<ThreeGppUmiStreetCanyonChannelConditionModel>());
+    } else {
+        // MapFile from the Config::SetDefault in main
+        analytic_pathloss = CreateObject<SionnaPropagationLossModel>();
+        analytic_pathloss->SetChannelConditionModel(CreateObject<SionnaChannelConditionModel>());
+    }
+
+    struct timeval time_now{};
+    gettimeofday(&time_now, nullptr);
+    uint64_t t_startTime_simid = (time_now.tv_sec * 1000) + (time_now.tv_usec / 1000);
+
+    ue_position_writer = ClearFile("ue_position.txt", t_startTime_simid);
+    enb_writer = ClearFile("enbs.txt", t_startTime_simid);
+    gnb_writer = ClearFile("gnbs.txt", t_startTime_simid);
+
+    // cell IDs as assigned by InstallLteEnbDevice + InstallEnbDevice, IMSIs in install order
+    std::ostringstream enbRows;
+    std::ostringstream gnbRows;
+    uint16_t cellId = 1;
+    for (uint32_t i = 0; i < lteEnbNodes.GetN(); i++, cellId++) {
+        Vector pos = lteEnbNodes.Get(i)->GetObject<MobilityModel>()->GetPosition();
+        enbRows << t_startTime_simid << "," << cellId << "," << pos.x << "," << pos.y << ","
+                << t_startTime_simid << "\n";
+    }
+    for (uint32_t i = 0; i < mmWaveEnbNodes.GetN(); i++, cellId++) {
+        Ptr<MobilityModel> mobility = mmWaveEnbNodes.Get(i)->GetObject<MobilityModel>();
+        Vector pos = mobility->GetPosition();
+        gnbRows << t_startTime_simid << "," << cellId << "," << pos.x << "," << pos.y << ","
+                << t_startTime_simid << "\n";
+
+        Ptr<TraceFileWriter> writer =
+            Create<TraceFileWriter>("cu-cp-cell-" + std::to_string(cellId) + ".txt", trace_compression);
+        writer->Write(0, MmWaveEnbNetDevice::GetCuCpTraceHeader());
+        analytic_cells.push_back(AnalyticCell{cellId, mobility, writer});
+        mmwave_cell_ids.insert(cellId);
+        ml_cell_position[cellId] = pos;
+    }
+    enb_writer->Write(t_startTime_simid, enbRows.str());
+    gnb_writer->Write(t_startTime_simid, gnbRows.str());
+
+    for (uint32_t u = 0; u < ueNodes.GetN(); u++) {
+        ue_imsi.push_back(u + 1);
+    }
+    analytic_serving.assign(ueNodes.GetN(), std::numeric_limits<size_t>::max());
+
+    NS_LOG_UNCOND("=== Analytic measurement mode ===");
+    NS_LOG_UNCOND("TxPower " << analytic_tx_power_dbm << " dBm, noise "
+                  << 10 * std::log10(analytic_noise_mw) << " dBm, " << analytic_cells.size()
+                  << " gNBs, SINR every " << indicationPeriodicity << " s");
+
+    // first report at the same time as the E2 periodic report of the full stack
+    Simulator::Schedule(Seconds(indicationPeriodicity), &SampleAnalyticSinr, ueNodes,
+                        Seconds(indicationPeriodicity), t_startTime_simid);
+    // after SampleAnalyticSinr at the same instants
+    SetupMlSequences(ueNodes, indicationPeriodicity, simTime);
+    Simulator::Schedule(Seconds(samplingPeriod + 0.01), &SampleUePositions, ueNodes,
+                        Seconds(samplingPeriod), t_startTime_simid);
+
+    Ptr<SimulationTelemetry> telemetry = StartTelemetry();
+    Simulator::Stop(Seconds(simTime));
+    auto wallStart = std::chrono::steady_clock::now();
+    Simulator::Run();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    NS_LOG_UNCOND("Simulator::Run wall time: " << wallSeconds << " s");
+    uint64_t eventCount = Simulator::GetEventCount();
+    NS_LOG_UNCOND("Events executed: " << eventCount << " (" << eventCount / simTime
+                  << " per simulated s, executionMode analytic)");
+    if (telemetry) {
+        telemetry->Stop();
+    }
+
+    ue_position_writer->Close();
+    enb_writer->Close();
+    gnb_writer->Close();
+    for (AnalyticCell &cell : analytic_cells) {
+        cell.cuCpWriter->Close();
+    }
+    WriteMlSequences(indicationPeriodicity);
+
+    NS_LOG_UNCOND("=== Simulation Completed ===");
+    Simulator::Destroy();
+    return 0;
 }
 
 void LogCurrentSimTime()
@@ -245,6 +649,63 @@ static ns3::GlobalValue g_indicationPeriodicity("indicationPeriodicity",
                              "E2 Indication Periodicity reports (value in seconds)",
                              ns3::DoubleValue(0.1), ns3::MakeDoubleChecker<double>(0.01, 2.0));
 
+static ns3::GlobalValue g_positionSamplingPeriod("positionSamplingPeriod",
+                                   "Period [s] of the UE position (ue_position.txt) and BS logging",
+                                   ns3::DoubleValue(0.1),
+                                   ns3::MakeDoubleChecker<double>(0.001, 100.0));
+
+static ns3::GlobalValue g_telemetryInterval("telemetryInterval",
+                                   "Period [s] of the throughput/memory rows written to "
+                                   "telemetryFile (0 disables the telemetry)",
+                                   ns3::DoubleValue(10),
+                                   ns3::MakeDoubleChecker<double>(0.0, 1000.0));
+
+static ns3::GlobalValue g_telemetryFile("telemetryFile", "Output of the run telemetry",
+                                   ns3::StringValue("telemetry.csv"), ns3::MakeStringChecker());
+
+static ns3::GlobalValue g_telemetryPendingEvents("telemetryPendingEvents",
+                                   "If true, the telemetry replaces the scheduler with a counting "
+                                   "MapScheduler to report the pending events",
+                                   ns3::BooleanValue(false), ns3::MakeBooleanChecker());
+
+static ns3::GlobalValue g_mlSequenceFile("mlSequenceFile",
+                                   "Per-UE float32 training sequences (position, serving cell, "
+                                   "top-K neighbour SINR) joined in the simulator, empty to disable",
+                                   ns3::StringValue(""), ns3::MakeStringChecker());
+
+static ns3::GlobalValue g_mlTopK("mlTopK", "Neighbour SINR columns of mlSequenceFile",
+                                   ns3::UintegerValue(3),
+                                   ns3::MakeUintegerChecker<uint32_t>(1, 8));
+
+static ns3::GlobalValue g_mlSmoothingWindow("mlSmoothingWindow",
+                                   "Moving average window [s] of the SINR columns of mlSequenceFile",
+                                   ns3::DoubleValue(5.0),
+                                   ns3::MakeDoubleChecker<double>(0.0, 100.0));
+
+static ns3::GlobalValue g_executionMode("executionMode",
+                                   "full (mmWave PHY/MAC/RLC stack and E2 file logging) or analytic "
+                                   "(only the cu-cp L3 SINR rows and the positions, computed from "
+                                   "the path loss and channel condition models)",
+                                   ns3::StringValue("full"), ns3::MakeStringChecker());
+
+static ns3::GlobalValue g_pathGainMap("pathGainMap",
+                                   "Sionna path gain grid (sionna-rt/export_path_gain.py) used "
+                                   "instead of the stochastic UMi pathloss and LOS model, empty "
+                                   "to keep the 3GPP models",
+                                   ns3::StringValue(""), ns3::MakeStringChecker());
+
+static ns3::GlobalValue g_trafficMode("trafficMode",
+                                   "DL traffic that keeps the UEs scheduled: cbr (200 B every 500 us), "
+                                   "keepalive (200 B every keepAliveInterval) or none. The SINR "
+                                   "reports do not need data, but with less traffic there is "
+                                   "less interference from the neighbour cells",
+                                   ns3::StringValue("cbr"), ns3::MakeStringChecker());
+
+static ns3::GlobalValue g_keepAliveInterval("keepAliveInterval",
+                                   "Packet interval [s] for trafficMode=keepalive",
+                                   ns3::DoubleValue(0.1),
+                                   ns3::MakeDoubleChecker<double>(0.001, 100.0));
+
 static ns3::GlobalValue g_simTime("simTime", "Simulation time in seconds", 
                                    ns3::DoubleValue(90), 
                                    ns3::MakeDoubleChecker<double>(0.1, 100000.0));
@@ -264,6 +725,15 @@ static ns3::GlobalValue g_handoverMode("handoverMode",
                     "HO heuristic to be used",
                     ns3::StringValue("DynamicTtt"), ns3::MakeStringChecker());
 
+static ns3::GlobalValue g_hoPolicy("hoPolicy",
+                    "Initial HO policy of all the UEs: none (global AllowAutonomousHoWithE2), "
+                    "autonomous, e2only or hybrid. The xApp can change it per UE at run time",
+                    ns3::StringValue("none"), ns3::MakeStringChecker());
+
+static ns3::GlobalValue g_hoPolicyVetoWindow("hoPolicyVetoWindow",
+                    "Veto window [s] of the hybrid HO policy",
+                    ns3::DoubleValue(1.0), ns3::MakeDoubleChecker<double>(0.0));
+
 static ns3::GlobalValue g_e2TermIp("e2TermIp", "The IP address of the RIC E2 termination",
                                     ns3::StringValue("127.0.0.1"), ns3::MakeStringChecker());
 
@@ -271,6 +741,11 @@ static ns3::GlobalValue g_enableE2FileLogging("enableE2FileLogging",
                               "If true, generate offline file logging instead of connecting to RIC",
                               ns3::BooleanValue(true), ns3::MakeBooleanChecker());
 
+static ns3::GlobalValue g_compressTraces("compressTraces",
+                              "If true, write the E2 csv files and the position/BS traces as "
+                              "block-compressed gzip with a timestamp index (<name>.gz, <name>.gz.idx)",
+                              ns3::BooleanValue(false), ns3::MakeBooleanChecker());
+
 static ns3::GlobalValue g_e2_func_id("KPM_E2functionID", "Function ID to subscribe",
                                       ns3::DoubleValue(2),
                                       ns3::MakeDoubleChecker<double>());
@@ -324,10 +799,13 @@ main(int argc, char *argv[]) {
     //진섭 모빌리티시드 설정
     uint32_t mobilityRun = 1;
     cmd.AddValue("mobRun", "Mobility run number", mobilityRun);
+    // 나머지 (채널, 스케줄러 등) RNG run, sweep runner가 run마다 다르게 설정
+    uint32_t rngRun = 1;
+    cmd.AddValue("rngRun", "RNG run number for everything but the UE mobility", rngRun);
     cmd.Parse(argc, argv);
 
     RngSeedManager::SetSeed(1); 
-    RngSeedManager::SetRun(1);
+    RngSeedManager::SetRun(rngRun);
 
     bool harqEnabled = true;
 
@@ -351,6 +829,8 @@ main(int argc, char *argv[]) {
     std::string e2TermIp = stringValue.Get();
     GlobalValue::GetValueByName("enableE2FileLogging", booleanValue);
     bool enableE2FileLogging = booleanValue.Get();
+    GlobalValue::GetValueByName("compressTraces", booleanValue);
+    bool compressTraces = booleanValue.Get();
     GlobalValue::GetValueByName("KPM_E2functionID", doubleValue);
     double g_e2_func_id = doubleValue.Get();
     GlobalValue::GetValueByName("RC_E2functionID", doubleValue);
@@ -404,6 +884,8 @@ main(int argc, char *argv[]) {
 
     Config::SetDefault("ns3::LteEnbNetDevice::EnableE2FileLogging", BooleanValue(enableE2FileLogging));
     Config::SetDefault("ns3::MmWaveEnbNetDevice::EnableE2FileLogging", BooleanValue(enableE2FileLogging));
+    Config::SetDefault("ns3::MmWaveEnbNetDevice::CompressE2FileLogging", BooleanValue(compressTraces));
+    trace_compression = compressTraces ? TraceFileWriter::GZIP_BLOCKS : TraceFileWriter::NONE;
 
     Config::SetDefault("ns3::LteEnbNetDevice::KPM_E2functionID", DoubleValue(g_e2_func_id));
     Config::SetDefault("ns3::MmWaveEnbNetDevice::KPM_E2functionID", DoubleValue(g_e2_func_id));
@@ -453,8 +935,19 @@ main(int argc, char *argv[]) {
     Config::SetDefault("ns3::MmWavePhyMacCommon::CenterFreq", DoubleValue(centerFrequency));
 
     Ptr<MmWaveHelper> mmwaveHelper = CreateObject<MmWaveHelper>();
-    mmwaveHelper->SetPathlossModelType("ns3::ThreeGppUmiStreetCanyonPropagationLossModel");
-    mmwaveHelper->SetChannelConditionModelType("ns3::ThreeGppUmiStreetCanyonChannelConditionModel");
+    GlobalValue::GetValueByName("pathGainMap", stringValue);
+    std::string pathGainMap = stringValue.Get();
+    if (pathGainMap.empty()) {
+        mmwaveHelper->SetPathlossModelType("ns3::ThreeGppUmiStreetCanyonPropagationLossModel");
+        mmwaveHelper->SetChannelConditionModelType("ns3::ThreeGppUmiStreetCanyonChannelConditionModel");
+    } else {
+        // building-aware pathloss/LOS from the Sionna grid, 3GPP UMi fast fading on top
+        Config::SetDefault("ns3::SionnaPropagationLossModel::MapFile", StringValue(pathGainMap));
+        Config::SetDefault("ns3::SionnaChannelConditionModel::MapFile", StringValue(pathGainMap));
+        mmwaveHelper->SetPathlossModelType("ns3::SionnaPropagationLossModel");
+        mmwaveHelper->SetChannelConditionModelType("ns3::SionnaChannelConditionModel");
+        NS_LOG_UNCOND("Path gain map: " << pathGainMap);
+    }
 
     Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper>();
     mmwaveHelper->SetEpcHelper(epcHelper);
@@ -533,6 +1026,10 @@ main(int argc, char *argv[]) {
     enbmobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
     enbmobility.SetPositionAllocator(enbPositionAlloc);
     enbmobility.Install(allEnbNodes);
+    if (!pathGainMap.empty()) {
+        // 그리드가 이 배치로 export 됐는지 한 번만 확인
+        SionnaPathGainMap::Open(pathGainMap)->CheckSites(mmWaveEnbNodes);
+    }
 
     // 모빌리티 설치 직전에만
     NS_LOG_UNCOND("Setting mobility run: " << mobilityRun);
@@ -562,7 +1059,7 @@ main(int argc, char *argv[]) {
     uemobility.Install(ueNodes);
 
     // 설치 후 바로 원복 (나머지는 일관성 유지)
-    RngSeedManager::SetRun(1);  // 🔥 원상복구
+    RngSeedManager::SetRun(rngRun);  // 🔥 원상복구
 
     // 🔥 설치 후 초기 위치 수동 설정
     Ptr<UniformDiscPositionAllocator> initialPos = CreateObject<UniformDiscPositionAllocator>();
@@ -579,11 +1076,46 @@ for (uint32_t i = 0; i < ueNodes.GetN(); ++i) {
     NS_LOG_UNCOND("=== Mobility Configuration ===");
     NS_LOG_UNCOND("UE Speed Range: 1-5 m/s");
 
+    // the same nodes and mobility are created in both modes, so a mobRun has the
+    // same trajectories with and without the full stack
+    GlobalValue::GetValueByName("executionMode", stringValue);
+    std::string executionMode = stringValue.Get();
+    if (executionMode == "analytic") {
+        return RunAnalyticMeasurements(ueNodes, lteEnbNodes, mmWaveEnbNodes, bandwidth,
+                                       hoSinrDifference);
+    } else if (executionMode != "full") {
+        NS_FATAL_ERROR("Unknown executionMode " << executionMode);
+    }
+
     // Install devices
     NetDeviceContainer lteEnbDevs = mmwaveHelper->InstallLteEnbDevice(lteEnbNodes);
     NetDeviceContainer mmWaveEnbDevs = mmwaveHelper->InstallEnbDevice(mmWaveEnbNodes);
     NetDeviceContainer mcUeDevs = mmwaveHelper->InstallMcUeDevice(ueNodes);
 
+    for (uint32_t u = 0; u < mcUeDevs.GetN(); ++u) {
+        ue_imsi.push_back(mcUeDevs.Get(u)->GetObject<McUeNetDevice>()->GetImsi());
+    }
+
+    // initial HO ownership of all the UEs, in one call (the policy table is shared by the cells)
+    GlobalValue::GetValueByName("hoPolicy", stringValue);
+    std::string hoPolicy = stringValue.Get();
+    if (hoPolicy != "none") {
+        LteEnbRrc::UeHoPolicy policy;
+        if (hoPolicy == "autonomous") {
+            policy = LteEnbRrc::HO_AUTONOMOUS;
+        } else if (hoPolicy == "e2only") {
+            policy = LteEnbRrc::HO_E2_ONLY;
+        } else if (hoPolicy == "hybrid") {
+            policy = LteEnbRrc::HO_HYBRID;
+        } else {
+            NS_FATAL_ERROR("Unknown hoPolicy " << hoPolicy);
+        }
+        GlobalValue::GetValueByName("hoPolicyVetoWindow", doubleValue);
+        Ptr<LteEnbRrc> rrc = DynamicCast<LteEnbNetDevice>(lteEnbDevs.Get(0))->GetRrc();
+        rrc->SetUeHoPolicy(ue_imsi, policy, Seconds(doubleValue.Get()));
+        NS_LOG_UNCOND("HO policy " << hoPolicy << " for " << ue_imsi.size() << " UEs");
+    }
+
     // Network configuration
     internet.Install(ueNodes);
     Ipv4InterfaceContainer ueIpIface;
@@ -620,12 +1152,32 @@ for (uint32_t i = 0; i < ueNodes.GetN(); ++i) {
 
     ApplicationContainer clientApp;
 
+    // cbr generates ~2000 packets/s/UE, each going through RLC/MAC/PHY and the
+    // EPC: it dominates the event count while the output we need (SINR reports,
+    // positions) comes from the control channel and the mobility models
+    GlobalValue::GetValueByName("trafficMode", stringValue);
+    std::string trafficMode = stringValue.Get();
+    GlobalValue::GetValueByName("keepAliveInterval", doubleValue);
+    double keepAliveInterval = doubleValue.Get();
+    Time clientInterval = MicroSeconds(500);
+    if (trafficMode == "keepalive") {
+        clientInterval = Seconds(keepAliveInterval);
+    } else if (trafficMode != "cbr" && trafficMode != "none") {
+        NS_FATAL_ERROR("Unknown trafficMode " << trafficMode);
+    }
+    NS_LOG_UNCOND("Traffic mode " << trafficMode << ": "
+                  << (trafficMode == "none" ? 0 : 1 / clientInterval.GetSeconds())
+                  << " packets/s per UE");
+
     for (uint32_t u = 0; u < ueNodes.GetN(); ++u) {
         PacketSinkHelper dlPacketSinkHelper("ns3::UdpSocketFactory",
                                            InetSocketAddress(Ipv4Address::GetAny(), 1234));
         sinkApp.Add(dlPacketSinkHelper.Install(ueNodes.Get(u)));
+        if (trafficMode == "none") {
+            continue;
+        }
         UdpClientHelper dlClient(ueIpIface.GetAddress(u), 1234);
-        dlClient.SetAttribute("Interval", TimeValue(MicroSeconds(500)));
+        dlClient.SetAttribute("Interval", TimeValue(clientInterval));
         dlClient.SetAttribute("MaxPackets", UintegerValue(UINT32_MAX));
         dlClient.SetAttribute("PacketSize", UintegerValue(200)); // Small packets for frequent updates
         clientApp.Add(dlClient.Install(remoteHost));
@@ -644,28 +1196,48 @@ for (uint32_t i = 0; i < ueNodes.GetN(); ++i) {
     uint64_t t_startTime_simid = (time_now.tv_sec * 1000) + (time_now.tv_usec / 1000);
     
     std::string ue_pos_out = "ue_position.txt";
-    ClearFile(ue_pos_out, t_startTime_simid);
-    ClearFile("enbs.txt", t_startTime_simid);
-    ClearFile("gnbs.txt", t_startTime_simid);
+    ue_position_writer = ClearFile(ue_pos_out, t_startTime_simid);
+    enb_writer = ClearFile("enbs.txt", t_startTime_simid);
+    gnb_writer = ClearFile("gnbs.txt", t_startTime_simid);
     
     PrintGnuplottableUeListToFile("ues.txt");
 
-    int nodecount = int(NodeList::GetNNodes());
-    int UE_iterator = nodecount - int(nUeNodes);
+    GlobalValue::GetValueByName("positionSamplingPeriod", doubleValue);
+    double samplingPeriod = doubleValue.Get();
 
-    // Frequent position logging for position prediction (every 3 seconds)
-    int numPrints = int(simTime / 0.1); // Every 0.1 seconds
+    // Frequent position logging for position prediction
+    int numPrints = int(simTime / samplingPeriod);
     NS_LOG_UNCOND("=== Logging Configuration ===");
-    NS_LOG_UNCOND("Position samples: " << numPrints << " (every 0.1 seconds)");
+    NS_LOG_UNCOND("Position samples: " << numPrints << " (every " << samplingPeriod << " seconds)");
     NS_LOG_UNCOND("Total measurement points: " << numPrints * nUeNodes);
-
-    for (int i = 1; i <= numPrints; i++) {
-        double scheduleTime = i * 0.1; // 0.1초마다
-        Simulator::Schedule(Seconds(scheduleTime), &PrintGnuplottableEnbListToFile, t_startTime_simid);
-        for (uint32_t j = 0; j < ueNodes.GetN(); j++) {
-            Simulator::Schedule(Seconds(scheduleTime + 0.01), &PrintPosition, ueNodes.Get(j), // 0.01초 후
-                            j + UE_iterator, ue_pos_out, t_startTime_simid);
-        }
+    // previously one PrintPosition event per UE and sample was inserted up front
+    // (~150 B each: EventImpl with bound arguments + scheduler map node)
+    NS_LOG_UNCOND("Pre-scheduled position events avoided: " << uint64_t(numPrints) * nUeNodes
+                  << " (~" << uint64_t(numPrints) * nUeNodes * 150 / (1024 * 1024) << " MB of event queue)");
+
+    PrintGnuplottableEnbListToFile(lteEnbDevs, mmWaveEnbDevs, t_startTime_simid);
+
+    // serving cell of each UE, maintained from the RRC traces
+    for (uint32_t i = 0; i < mmWaveEnbDevs.GetN(); i++) {
+        Ptr<MmWaveEnbNetDevice> mmdev = DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(i));
+        mmwave_cell_ids.insert(mmdev->GetCellId());
+        ml_cell_position[mmdev->GetCellId()] =
+            mmdev->GetNode()->GetObject<MobilityModel>()->GetPosition();
+    }
+    Config::Connect("/NodeList/*/DeviceList/*/LteEnbRrc/ConnectionEstablished",
+                    MakeCallback(&NotifyUeServingCell));
+    Config::Connect("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverEndOk",
+                    MakeCallback(&NotifyUeServingCell));
+    Config::ConnectFailSafe("/NodeList/*/DeviceList/*/LteEnbRrc/UeContextRemoved",
+                            MakeCallback(&NotifyUeServingCellRemoved));
+
+    Simulator::Schedule(Seconds(samplingPeriod + 0.01), &SampleUePositions, ueNodes,
+                        Seconds(samplingPeriod), t_startTime_simid);
+
+    SetupMlSequences(ueNodes, indicationPeriodicity, simTime);
+    if (!ml_sequences.empty()) {
+        Config::ConnectFailSafe("/NodeList/*/DeviceList/*/LteEnbRrc/NotifyMmWaveSinr",
+                                MakeCallback(&NotifyMlSinr));
     }
 
     if (enableTraces) {
@@ -679,6 +1251,7 @@ for (uint32_t i = 0; i < ueNodes.GetN(); ++i) {
     lteHelper->EnableMacTraces();
 
     Simulator::Schedule(Seconds(10), &LogCurrentSimTime); 
+    Ptr<SimulationTelemetry> telemetry = StartTelemetry();
     // Run simulation
     NS_LOG_UNCOND("=== Starting Position Prediction Simulation ===");
     NS_LOG_UNCOND("Simulation time: " << simTime << " seconds");
@@ -686,11 +1259,40 @@ for (uint32_t i = 0; i < ueNodes.GetN(); ++i) {
     
     Simulator::Stop(Seconds(simTime));
     NS_LOG_INFO("Run Simulation.");
+    auto wallStart = std::chrono::steady_clock::now();
     Simulator::Run();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    NS_LOG_UNCOND("Simulator::Run wall time: " << wallSeconds << " s");
+    uint64_t eventCount = Simulator::GetEventCount();
+    NS_LOG_UNCOND("Events executed: " << eventCount << " (" << eventCount / simTime
+                  << " per simulated s, " << eventCount / std::max(wallSeconds, 1e-3)
+                  << " per wall s, trafficMode " << trafficMode << ")");
+    if (telemetry) {
+        telemetry->Stop();
+        NS_LOG_UNCOND("Telemetry: " << telemetry->GetE2Reports() << " E2 reports, "
+                      << telemetry->GetHandovers() << " HOs, " << telemetry->GetSinrReadings()
+                      << " SINR readings, RSS " << SimulationTelemetry::GetRssKiB() / 1024 << " MiB");
+    }
+    for (uint32_t i = 0; i < lteEnbDevs.GetN(); i++) {
+        Ptr<LteEnbNetDevice> enbdev = DynamicCast<LteEnbNetDevice>(lteEnbDevs.Get(i));
+        Ptr<LteEnbRrc> rrc = enbdev->GetRrc();
+        NS_LOG_UNCOND("LTE cell " << enbdev->GetCellId() << " association evaluations: "
+                      << rrc->GetAssociationEvaluationsRun() << " run, "
+                      << rrc->GetAssociationEvaluationsSkipped() << " skipped, "
+                      << rrc->GetAssociationEvaluationsDeferred() << " deferred, "
+                      << rrc->GetAssociationDeferredReevaluated() << " deferred UEs re-evaluated");
+    }
+
+    // flush the last (partial) blocks before the gNB devices are disposed
+    ue_position_writer->Close();
+    enb_writer->Close();
+    gnb_writer->Close();
+    WriteMlSequences(indicationPeriodicity);
 
     NS_LOG_UNCOND("=== Simulation Completed ===");
-    NS_LOG_UNCOND("Position data saved to: " << ue_pos_out);
-    NS_LOG_UNCOND("Base station data saved to: gnbs.txt, enbs.txt");
+    NS_LOG_UNCOND("Position data saved to: " << ue_position_writer->GetFileName());
+    NS_LOG_UNCOND("Base station data saved to: " << gnb_writer->GetFileName() << ", "
+                                                 << enb_writer->GetFileName());
     NS_LOG_UNCOND("UE layout saved to: ues.txt");
 
     Simulator::Destroy();
@@ -30,3 +30,540 @@ LteEnbRrc::TakeUeHoControl (uint64_t imsi)
 // .h파일에 bool변수 추가
     HandoverMode m_handoverMode;
     bool m_allowAutonomousHoWithE2; // 진섭
+
+// .h파일에 TracedCallback 추가 (UE context 해제 알림)
+    TracedCallback<uint64_t, uint16_t, uint16_t> m_ueContextRemovedTrace; // 진섭
+
+//LteEnbRrc::GetTypeId (void)
+.AddTraceSource ("UeContextRemoved",
+                 "Fired when a UE context is removed from this eNB "
+                 "(context release after handover, RLF or connection release)",
+                 MakeTraceSourceAccessor (&LteEnbRrc::m_ueContextRemovedTrace),
+                 "ns3::LteEnbRrc::HandoverEndOkTracedCallback")
+
+// LteEnbRrc::RemoveUe (uint16_t rnti) 에서 m_ueMap.erase (it) 직전에 추가
+  m_ueContextRemovedTrace (it->second->GetImsi (),
+                           ComponentCarrierToCellId (it->second->GetComponentCarrierId ()),
+                           rnti); // 진섭
+
+// ===================== 이벤트 기반 TriggerUeAssociationUpdate ===================== // 진섭
+// 매 m_crtPeriod마다 모든 UE × 모든 cell을 재평가하지 않고, 마지막 평가 이후 L3 SINR이
+// hysteresis 이상 변한 UE(dirty set)만 재평가한다.
+
+// .h파일에 변수/함수 추가
+    std::set<uint64_t> m_ueAssocDirty; //!< UEs whose L3 SINR crossed the hysteresis since the last evaluation
+    std::map<uint64_t, CellSinrMap> m_lastEvaluatedSinrMap; //!< L3 SINR snapshot used at the last evaluation
+    double m_assocDirtyHysteresis; //!< [dB]
+    uint64_t m_assocEvaluationsRun;
+    uint64_t m_assocEvaluationsSkipped;
+    std::set<uint64_t> m_ueAssocDeferred; //!< UEs skipped by the loop body at their last evaluation
+    uint64_t m_assocEvaluationsDeferred;
+    uint64_t m_assocDeferredReevaluated;
+    /**
+     * \return true if the TriggerUeAssociationUpdate loop body cannot take a decision for
+     *         the UE now (handover in progress, on LTE after an outage, xApp veto window)
+     */
+    bool IsUeAssociationDeferred (uint64_t imsi) const;
+  public:
+    /**
+     * \return the number of per-UE association evaluations run by TriggerUeAssociationUpdate
+     */
+    uint64_t GetAssociationEvaluationsRun () const;
+    /**
+     * \return the number of per-UE association evaluations skipped because the UE was not dirty
+     */
+    uint64_t GetAssociationEvaluationsSkipped () const;
+    /**
+     * \return the number of per-UE evaluations in which the UE was skipped and kept dirty
+     */
+    uint64_t GetAssociationEvaluationsDeferred () const;
+    /**
+     * \return the number of times a UE skipped at its previous evaluation was evaluated again
+     */
+    uint64_t GetAssociationDeferredReevaluated () const;
+    /**
+     * Make TriggerUeAssociationUpdate look at the UE in its next run
+     */
+    void MarkUeAssociationDirty (uint64_t imsi);
+
+// LteEnbRrc::LteEnbRrc () 초기화 리스트
+      m_assocDirtyHysteresis (1.0),
+      m_assocEvaluationsRun (0),
+      m_assocEvaluationsSkipped (0),
+      m_assocEvaluationsDeferred (0),
+      m_assocDeferredReevaluated (0),
+
+//LteEnbRrc::GetTypeId (void)
+.AddAttribute ("AssociationDirtyHysteresis",
+               "Minimum change of a L3 SINR reading [dB], with respect to the value used in the "
+               "last association evaluation, for the UE to be re-evaluated",
+               DoubleValue (1.0),
+               MakeDoubleAccessor (&LteEnbRrc::m_assocDirtyHysteresis),
+               MakeDoubleChecker<double> (0.0))
+
+// LteEnbRrc::DoRecvUeSinrUpdate 에서 m_imsiCellSinrMap[imsi][mmWaveCellId] = sinr; 바로 다음에 추가
+      {
+        auto lastIt = m_lastEvaluatedSinrMap.find (imsi);
+        if (lastIt == m_lastEvaluatedSinrMap.end () ||
+            lastIt->second.find (mmWaveCellId) == lastIt->second.end ())
+          {
+            // first reading of this UE / cell
+            m_ueAssocDirty.insert (imsi);
+          }
+        else
+          {
+            double lastDb = 10 * std::log10 (lastIt->second.at (mmWaveCellId));
+            double newDb = 10 * std::log10 (sinr);
+            if (std::abs (newDb - lastDb) >= m_assocDirtyHysteresis)
+              {
+                m_ueAssocDirty.insert (imsi);
+              }
+          }
+      } // 진섭
+
+// LteEnbRrc::TriggerUeAssociationUpdate () 의 UE loop 교체
+//   기존: for (std::map<uint64_t, CellSinrMap>::iterator imsiIter = m_imsiCellSinrMap.begin ();
+//              imsiIter != m_imsiCellSinrMap.end (); ++imsiIter)
+      std::set<uint64_t> evaluateImsi;
+      evaluateImsi.swap (m_ueAssocDirty);
+      // UEs with a pending TTT event are re-evaluated until the event fires or is cancelled
+      for (auto eventIt = m_imsiHandoverEventsMap.begin ();
+           eventIt != m_imsiHandoverEventsMap.end (); ++eventIt)
+        {
+          evaluateImsi.insert (eventIt->first);
+        }
+      // UEs with a position hint (stored by the mmWave cell that received it) are
+      // re-evaluated until the hint fires or expires
+      if (m_enableProactiveHo)
+        {
+          for (auto hintIt = m_proactiveHoHints.begin (); hintIt != m_proactiveHoHints.end ();
+               ++hintIt)
+            {
+              evaluateImsi.insert (hintIt->first);
+            }
+        }
+
+      uint64_t skipped = 0;
+      for (auto imsiIter = m_imsiCellSinrMap.begin (); imsiIter != m_imsiCellSinrMap.end ();
+           ++imsiIter)
+        {
+          if (evaluateImsi.find (imsiIter->first) == evaluateImsi.end ())
+            {
+              skipped++;
+            }
+        }
+      m_assocEvaluationsSkipped += skipped;
+      m_assocEvaluationsRun += m_imsiCellSinrMap.size () - skipped;
+      NS_LOG_INFO ("TriggerUeAssociationUpdate: evaluate " << m_imsiCellSinrMap.size () - skipped
+                                                          << " UEs, skip " << skipped
+                                                          << ", deferred so far "
+                                                          << m_assocEvaluationsDeferred);
+
+      for (auto dirtyIt = evaluateImsi.begin (); dirtyIt != evaluateImsi.end (); ++dirtyIt)
+        {
+          std::map<uint64_t, CellSinrMap>::iterator imsiIter = m_imsiCellSinrMap.find (*dirtyIt);
+          if (imsiIter == m_imsiCellSinrMap.end ())
+            {
+              continue;
+            }
+          if (IsUeAssociationDeferred (imsiIter->first))
+            {
+              // the loop body skips the UE: keep it dirty and keep the old snapshot, so it
+              // is evaluated again once the handover / outage / veto is over even if its
+              // SINR does not move
+              m_ueAssocDirty.insert (imsiIter->first);
+              m_ueAssocDeferred.insert (imsiIter->first);
+              m_assocEvaluationsDeferred++;
+            }
+          else
+            {
+              if (m_ueAssocDeferred.erase (imsiIter->first) > 0)
+                {
+                  m_assocDeferredReevaluated++;
+                }
+              m_lastEvaluatedSinrMap[imsiIter->first] = imsiIter->second;
+            }
+          // ... 이하 기존 loop body 그대로 (imsiIter 사용)
+        }
+
+// LteEnbRrc::RemoveUe / UE 해제 시 정리
+  m_ueAssocDirty.erase (imsi);
+  m_ueAssocDeferred.erase (imsi);
+  m_lastEvaluatedSinrMap.erase (imsi); // 진섭
+
+// m_mmWaveCellSetupCompleted[imsi] 를 true 로 바꾸는 곳 (DoRecvSecondaryCellHandoverCompleted,
+// DoRecvSecondaryCellInitialAccessSuccessful) 과 m_imsiUsingLte[imsi] 를 false 로 바꾸는 곳
+// (LTE -> mmWave switch) 바로 다음에 추가: HO 완료 후 새 serving cell 기준으로 다시 평가
+  MarkUeAssociationDirty (imsi); // 진섭
+
+bool
+LteEnbRrc::IsUeAssociationDeferred (uint64_t imsi) const
+{
+  // secondary cell handover / switch not completed yet
+  auto setupIt = m_mmWaveCellSetupCompleted.find (imsi);
+  if (setupIt != m_mmWaveCellSetupCompleted.end () && !setupIt->second)
+    {
+      return true;
+    }
+  // on LTE after a mmWave outage
+  auto lteIt = m_imsiUsingLte.find (imsi);
+  if (lteIt != m_imsiUsingLte.end () && lteIt->second)
+    {
+      return true;
+    }
+  // HO_HYBRID UE inside the veto window of an xApp command. HO_E2_ONLY UEs are not
+  // deferred, SetUeHoPolicy / ReleaseUeHoControl mark them dirty when the policy changes
+  auto policyIt = m_ueHoPolicy.find (imsi);
+  return policyIt != m_ueHoPolicy.end () && policyIt->second.policy == HO_HYBRID &&
+         !IsAutonomousHoAllowed (imsi);
+}
+
+void
+LteEnbRrc::MarkUeAssociationDirty (uint64_t imsi)
+{
+  m_ueAssocDirty.insert (imsi);
+}
+
+uint64_t
+LteEnbRrc::GetAssociationEvaluationsRun () const
+{
+  return m_assocEvaluationsRun;
+}
+
+uint64_t
+LteEnbRrc::GetAssociationEvaluationsSkipped () const
+{
+  return m_assocEvaluationsSkipped;
+}
+
+uint64_t
+LteEnbRrc::GetAssociationEvaluationsDeferred () const
+{
+  return m_assocEvaluationsDeferred;
+}
+
+uint64_t
+LteEnbRrc::GetAssociationDeferredReevaluated () const
+{
+  return m_assocDeferredReevaluated;
+}
+
+// ===================== UE별 HO 제어 정책 (autonomous / E2-only / hybrid) ===================== // 진섭
+// 전역 m_allowAutonomousHoWithE2 하나로만 결정하던 것을 UE별 정책 테이블로 분리.
+// 측정 보고마다 호출되는 HO 결정 경로에서 O(1)로 확인한다.
+// IMSI 는 시뮬레이션 전체에서 유일하므로 테이블은 모든 LteEnbRrc 가 공유(static)하고,
+// UE 가 HO 로 다른 cell 에 가도 정책이 그대로 따라간다. 같은 프로세스에서 다음 시뮬레이션으로
+// 넘어가지 않도록 DoDispose 에서 비운다.
+
+// .h파일에 추가 (public)
+    enum UeHoPolicy
+    {
+      HO_AUTONOMOUS = 0, //!< the RRC heuristic decides, E2 commands are still executed
+      HO_E2_ONLY = 1,    //!< only the xApp can trigger a handover
+      HO_HYBRID = 2      //!< the RRC heuristic decides, unless an xApp command was received within the veto window
+    };
+
+    /**
+     * Set the HO policy of a group of UEs
+     * \param imsiList the UEs
+     * \param policy the policy
+     * \param vetoWindow for HO_HYBRID, how long an xApp command blocks the autonomous heuristic
+     */
+    void SetUeHoPolicy (const std::vector<uint64_t> &imsiList, UeHoPolicy policy,
+                        Time vetoWindow = Seconds (0));
+
+    /**
+     * Give a group of UEs back to the autonomous heuristic (policy removed)
+     */
+    void ReleaseUeHoControl (const std::vector<uint64_t> &imsiList);
+
+    /**
+     * Called when an xApp HO command (or veto) for the UE is received
+     */
+    void NotifyE2HoCommand (uint64_t imsi);
+
+    /**
+     * \return true if the RRC heuristic may hand over the UE at this time
+     */
+    bool IsAutonomousHoAllowed (uint64_t imsi) const;
+
+// .h파일에 추가 (private)
+    struct UeHoPolicyEntry
+    {
+      UeHoPolicy policy;
+      Time vetoWindow;
+      Time lastE2Command;
+    };
+    static std::unordered_map<uint64_t, UeHoPolicyEntry> m_ueHoPolicy; //!< shared by all the cells, keyed by IMSI // 진섭
+
+// lte-enb-rrc.cc (namespace ns3) 에 static member 정의 추가
+std::unordered_map<uint64_t, LteEnbRrc::UeHoPolicyEntry> LteEnbRrc::m_ueHoPolicy; // 진섭
+
+// TakeUeHoControl 교체: 기존 set 대신 정책 테이블 사용
+void
+LteEnbRrc::TakeUeHoControl (uint64_t imsi)
+{
+  NS_LOG_FUNCTION (this << imsi);
+  if (!m_allowAutonomousHoWithE2)
+  {
+    NS_LOG_INFO ("UE " << +imsi << " has external HO control");
+    m_e2ControlledUes.insert (imsi);
+    auto it = m_ueHoPolicy.find (imsi);
+    if (it == m_ueHoPolicy.end ())
+    {
+      m_ueHoPolicy[imsi] = UeHoPolicyEntry{HO_E2_ONLY, Seconds (0), Simulator::Now ()};
+    }
+  }
+  else
+  {
+    NS_LOG_INFO ("E2 is active, but autonomous HO is allowed. Ignoring TakeUeHoControl for UE " << imsi);
+  }
+  NotifyE2HoCommand (imsi);
+}
+
+void
+LteEnbRrc::SetUeHoPolicy (const std::vector<uint64_t> &imsiList, UeHoPolicy policy,
+                          Time vetoWindow)
+{
+  NS_LOG_FUNCTION (this << imsiList.size () << policy << vetoWindow);
+  for (uint64_t imsi : imsiList)
+  {
+    // keep the time of the last command if the UE already had a policy
+    Time lastE2Command = Seconds (-1);
+    auto it = m_ueHoPolicy.find (imsi);
+    if (it != m_ueHoPolicy.end ())
+    {
+      lastE2Command = it->second.lastE2Command;
+    }
+    m_ueHoPolicy[imsi] = UeHoPolicyEntry{policy, vetoWindow, lastE2Command};
+    if (policy == HO_E2_ONLY)
+    {
+      m_e2ControlledUes.insert (imsi);
+    }
+    else
+    {
+      m_e2ControlledUes.erase (imsi);
+    }
+    MarkUeAssociationDirty (imsi);
+  }
+}
+
+void
+LteEnbRrc::ReleaseUeHoControl (const std::vector<uint64_t> &imsiList)
+{
+  NS_LOG_FUNCTION (this << imsiList.size ());
+  for (uint64_t imsi : imsiList)
+  {
+    m_ueHoPolicy.erase (imsi);
+    m_e2ControlledUes.erase (imsi);
+    // the heuristic may have been blocked for a while with a stable SINR
+    MarkUeAssociationDirty (imsi);
+  }
+}
+
+void
+LteEnbRrc::NotifyE2HoCommand (uint64_t imsi)
+{
+  auto it = m_ueHoPolicy.find (imsi);
+  if (it != m_ueHoPolicy.end ())
+  {
+    it->second.lastE2Command = Simulator::Now ();
+  }
+}
+
+bool
+LteEnbRrc::IsAutonomousHoAllowed (uint64_t imsi) const
+{
+  auto it = m_ueHoPolicy.find (imsi);
+  if (it == m_ueHoPolicy.end ())
+  {
+    // no per-UE policy, fall back to the global flag
+    return m_allowAutonomousHoWithE2 || m_e2ControlledUes.find (imsi) == m_e2ControlledUes.end ();
+  }
+  switch (it->second.policy)
+  {
+    case HO_AUTONOMOUS:
+      return true;
+    case HO_E2_ONLY:
+      return false;
+    case HO_HYBRID:
+      return it->second.lastE2Command.IsNegative () ||
+             Simulator::Now () - it->second.lastE2Command >= it->second.vetoWindow;
+  }
+  return true;
+}
+
+// HO 결정 경로 (TriggerUeAssociationUpdate, ThresholdBasedSecondaryCellHandover,
+// SecondaryCellHandover, DoRecvMeasurementReport 등) 에서 기존 검사를 교체
+//   기존: if (m_e2ControlledUes.find (imsi) != m_e2ControlledUes.end ()) { ... skip ... }
+    if (!IsAutonomousHoAllowed (imsi)) // 진섭
+    {
+      NS_LOG_INFO ("UE " << imsi << " HO is under xApp control, skip autonomous decision");
+      continue; // (함수 안에서는 return)
+    }
+
+// LteEnbRrc::RemoveUe 에서 정리: HO 로 떠나는 UE (source cell 의 context release) 는 정책을
+// 유지하고, 최종 context release (connection release, RLF) 에서만 지운다
+  if (it->second->GetState () != UeManager::HANDOVER_LEAVING)
+    {
+      m_ueHoPolicy.erase (imsi); // 진섭
+    }
+
+// LteEnbRrc::DoDispose () 에 추가: static 테이블은 프로세스 안에서 다음 시뮬레이션까지 남으므로
+// Simulator::Destroy (모든 RRC 의 DoDispose) 에서 비운다
+  m_ueHoPolicy.clear (); // 진섭
+
+// ===================== 위치 예측 기반 선제적 HO 준비 ===================== // 진섭
+// xApp이 예측한 UE 위치/궤적에서 얻은 target cell을 hint로 받아, SINR crossover 전에
+// (target SINR이 serving보다 ProactiveHoMargin dB 이내로 올라오면) TTT 없이 X2 HO를 시작한다.
+// E2 (Position_Hint_Style) 로는 target cell 만 전달된다. 위치/궤적 입력은
+// MmWaveEnbNetDevice::NotifyPredictedTrajectory (C++ 전용, 시나리오의 trajectoryHorizon) 로만 가능하다.
+// hint 는 E2 메시지를 받은 mmWave cell 의 RRC 에 들어오지만, HO 결정 (TriggerUeAssociationUpdate)
+// 은 LTE coordinator RRC 에서 하므로 테이블은 m_ueHoPolicy 처럼 IMSI 키로 모든 RRC 가 공유(static)한다.
+
+// .h파일에 추가 (public)
+    /**
+     * Store a predicted target cell for the UE
+     * \param imsi the UE
+     * \param targetCellId the mmWave cell the UE is predicted to move to
+     * \param validity how long the hint is kept
+     */
+    void SetProactiveHoHint (uint64_t imsi, uint16_t targetCellId, Time validity);
+
+    /// TracedCallback signature for proactive handovers: imsi, source cell, target cell
+    typedef void (*ProactiveHandoverTracedCallback) (uint64_t imsi, uint16_t sourceCellId,
+                                                     uint16_t targetCellId);
+
+// .h파일에 추가 (private)
+    struct ProactiveHoHint
+    {
+      uint16_t targetCellId;
+      Time expiry;
+    };
+    static std::unordered_map<uint64_t, ProactiveHoHint> m_proactiveHoHints; //!< shared by all the cells, keyed by IMSI // 진섭
+    bool m_enableProactiveHo;
+    double m_proactiveHoMargin; //!< [dB]
+    TracedCallback<uint64_t, uint16_t, uint16_t> m_proactiveHandoverTrace;
+
+// lte-enb-rrc.cc (namespace ns3) 에 static member 정의 추가
+std::unordered_map<uint64_t, LteEnbRrc::ProactiveHoHint> LteEnbRrc::m_proactiveHoHints; // 진섭
+
+// LteEnbRrc::LteEnbRrc () 초기화 리스트
+      m_enableProactiveHo (true),
+      m_proactiveHoMargin (3.0),
+
+//LteEnbRrc::GetTypeId (void)
+.AddAttribute ("EnableProactiveHo",
+               "If true, the predicted target cells received from the xApp start the handover "
+               "before the SINR crossover",
+               BooleanValue (true),
+               MakeBooleanAccessor (&LteEnbRrc::m_enableProactiveHo),
+               MakeBooleanChecker ())
+.AddAttribute ("ProactiveHoMargin",
+               "A hinted handover starts when the target SINR is within this margin [dB] "
+               "of the serving SINR",
+               DoubleValue (3.0),
+               MakeDoubleAccessor (&LteEnbRrc::m_proactiveHoMargin),
+               MakeDoubleChecker<double> (0.0))
+.AddTraceSource ("ProactiveHandover",
+                 "Handover started from a position-based hint",
+                 MakeTraceSourceAccessor (&LteEnbRrc::m_proactiveHandoverTrace),
+                 "ns3::LteEnbRrc::ProactiveHandoverTracedCallback")
+
+void
+LteEnbRrc::SetProactiveHoHint (uint64_t imsi, uint16_t targetCellId, Time validity)
+{
+  NS_LOG_FUNCTION (this << imsi << targetCellId << validity);
+  // read by the coordinator RRC, which checks its own EnableProactiveHo
+  m_proactiveHoHints[imsi] = ProactiveHoHint{targetCellId, Simulator::Now () + validity};
+}
+
+// LteEnbRrc::TriggerUeAssociationUpdate () UE loop body 맨 앞 (imsi, imsiIter 구한 직후)
+      if (m_enableProactiveHo)
+      {
+        auto hintIt = m_proactiveHoHints.find (imsi);
+        if (hintIt != m_proactiveHoHints.end ())
+        {
+          // no serving mmWave cell yet (e.g., still attaching): the hint waits for it
+          auto servingIt = m_lastMmWaveCell.find (imsi);
+          bool servingKnown = servingIt != m_lastMmWaveCell.end ();
+          uint16_t servingCellId = servingKnown ? servingIt->second : 0;
+          uint16_t hintCellId = hintIt->second.targetCellId;
+          if (Simulator::Now () > hintIt->second.expiry ||
+              (servingKnown && hintCellId == servingCellId))
+          {
+            m_proactiveHoHints.erase (hintIt);
+          }
+          else if (servingKnown && imsiIter->second.find (hintCellId) != imsiIter->second.end () &&
+                   imsiIter->second.find (servingCellId) != imsiIter->second.end ())
+          {
+            double targetSinrDb = 10 * std::log10 (imsiIter->second[hintCellId]);
+            double servingSinrDb = 10 * std::log10 (imsiIter->second[servingCellId]);
+            if (targetSinrDb > m_outageThreshold &&
+                targetSinrDb >= servingSinrDb - m_proactiveHoMargin)
+            {
+              NS_LOG_INFO ("Proactive HO of UE " << imsi << " from " << servingCellId << " to "
+                                                 << hintCellId << " target SINR " << targetSinrDb
+                                                 << " serving SINR " << servingSinrDb);
+              m_proactiveHoHints.erase (hintIt);
+              m_proactiveHandoverTrace (imsi, servingCellId, hintCellId);
+              PerformE2RCHO (imsi, hintCellId);
+              continue;
+            }
+            // the hinted UEs are added to evaluateImsi until the hint fires or expires
+          }
+        }
+      } // 진섭
+
+// LteEnbRrc::RemoveUe 에서 정리: m_ueHoPolicy 와 같이 HO 로 떠나는 UE 의 hint 는 유지
+  if (it->second->GetState () != UeManager::HANDOVER_LEAVING)
+    {
+      m_proactiveHoHints.erase (imsi); // 진섭
+    }
+
+// LteEnbRrc::DoDispose () 에 추가
+  m_proactiveHoHints.clear (); // 진섭
+
+// ===================== gNB-gNB X2 lazy 생성 ===================== // 진섭
+// 시나리오에서 gNB 간 X2 전체 mesh(O(N²))를 만들지 않고, 해당 pair 사이 HO가 처음 시도될 때
+// 시나리오 콜백으로 X2 interface를 생성한다.
+
+// .h파일에 추가 (public)
+    /**
+     * Callback invoked with (this cell, target cell) before a handover request is sent
+     * to a cell with no X2 interface yet. It must create the X2 interface synchronously.
+     */
+    typedef Callback<void, uint16_t, uint16_t> X2SetupRequiredCallback;
+    void SetX2SetupRequiredCallback (X2SetupRequiredCallback cb);
+    void EnsureX2Interface (uint16_t targetCellId);
+
+// .h파일에 추가 (private)
+    X2SetupRequiredCallback m_x2SetupRequiredCallback; // 진섭
+    std::set<uint16_t> m_x2NeighbourCells;             //!< cells reachable through X2
+
+void
+LteEnbRrc::SetX2SetupRequiredCallback (X2SetupRequiredCallback cb)
+{
+  m_x2SetupRequiredCallback = cb;
+}
+
+void
+LteEnbRrc::EnsureX2Interface (uint16_t targetCellId)
+{
+  if (m_x2NeighbourCells.find (targetCellId) != m_x2NeighbourCells.end () ||
+      m_x2SetupRequiredCallback.IsNull ())
+  {
+    return;
+  }
+  NS_LOG_INFO ("Cell " << m_cellId << " creates X2 towards " << targetCellId << " on first HO");
+  m_x2SetupRequiredCallback (m_cellId, targetCellId);
+  // AddX2Interface -> AddX2Neighbour fills m_x2NeighbourCells, make sure the callback
+  // is not invoked again for the same pair even if it did nothing
+  m_x2NeighbourCells.insert (targetCellId);
+}
+
+// LteEnbRrc::AddX2Neighbour (uint16_t cellId) 에 추가
+  m_x2NeighbourCells.insert (cellId); // 진섭
+
+// UeManager::PrepareHandover (uint16_t cellId) 에서 m_rrc->m_x2SapProvider->SendHandoverRequest (params); 직전에 추가
+      m_rrc->EnsureX2Interface (cellId); // 진섭
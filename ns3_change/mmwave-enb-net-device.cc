@@ -63,6 +63,7 @@
 #include <ns3/lte-rlc-um.h>
 #include <ns3/lte-rlc-um-lowlat.h>
 #include <ns3/lte-rlc-am.h>
+#include <ns3/mobility-model.h>
 #include "UEID-GNB.h"
 #include "E2SM-RC-ControlMessage-Format1-Item.h"
 #include "RANParameter-ValueType-Choice-ElementFalse.h"
@@ -73,6 +74,7 @@
 #include "encode_e2apv1.hpp"
 #include "ns3/network-module.h"
 #include <any>
+#include <limits>
 
 namespace ns3 {
 
@@ -306,12 +308,46 @@ MmWaveEnbNetDevice::GetTypeId ()
                          BooleanValue (false),
                          MakeBooleanAccessor (&MmWaveEnbNetDevice::m_forceE2FileLogging),
                          MakeBooleanChecker ())
+          .AddAttribute ("CompressE2FileLogging",
+                         "If true, the E2 csv files are written as block-compressed gzip "
+                         "(<name>.gz) with a per-block timestamp index (<name>.gz.idx)",
+                         BooleanValue (false),
+                         MakeBooleanAccessor (&MmWaveEnbNetDevice::m_compressE2FileLogging),
+                         MakeBooleanChecker ())
+          .AddAttribute ("L3SinrMaxAge",
+                         "Neighbour L3 SINR readings older than this are dropped before the CuCp "
+                         "report is built (0 disables the age-out)",
+                         TimeValue (Seconds (1)),
+                         MakeTimeAccessor (&MmWaveEnbNetDevice::m_l3SinrMaxAge),
+                         MakeTimeChecker ())
+          .AddAttribute ("UeStateMaxAge",
+                         "Per-UE throughput and SINR values not updated for this long are dropped "
+                         "before a report is built (0 disables the age-out)",
+                         TimeValue (Seconds (1)),
+                         MakeTimeAccessor (&MmWaveEnbNetDevice::m_ueStateMaxAge),
+                         MakeTimeChecker ())
+          .AddAttribute ("ProactiveHoHintValidity",
+                         "How long a predicted target cell received from the xApp is kept by "
+                         "the RRC",
+                         TimeValue (Seconds (1)),
+                         MakeTimeAccessor (&MmWaveEnbNetDevice::m_proactiveHoHintValidity),
+                         MakeTimeChecker ())
+          .AddAttribute ("HoPolicyVetoWindow",
+                         "Veto window of the HO_HYBRID policies set by the xApp through the "
+                         "Ho_Policy_Style control",
+                         TimeValue (Seconds (1)),
+                         MakeTimeAccessor (&MmWaveEnbNetDevice::m_hoPolicyVetoWindow),
+                         MakeTimeChecker ())
           .AddAttribute ("KPM_E2functionID", "Function ID to subscribe", DoubleValue (2),
                          MakeDoubleAccessor (&MmWaveEnbNetDevice::e2_func_id),
                          MakeDoubleChecker<double> ())
           .AddAttribute ("RC_E2functionID", "Function ID to subscribe", DoubleValue (3),
                          MakeDoubleAccessor (&MmWaveEnbNetDevice::rc_e2_func_id),
-                         MakeDoubleChecker<double> ());
+                         MakeDoubleChecker<double> ())
+          .AddTraceSource ("E2ReportBuilt",
+                           "A CU-UP, CU-CP or DU report was built, for E2 or file logging",
+                           MakeTraceSourceAccessor (&MmWaveEnbNetDevice::m_e2ReportTrace),
+                           "ns3::MmWaveEnbNetDevice::E2ReportTracedCallback");
   return tid;
 }
 
@@ -325,9 +361,14 @@ MmWaveEnbNetDevice::MmWaveEnbNetDevice ()
       m_isReportingEnabled (false),
       m_reducedPmValues (false),
       m_forceE2FileLogging (false),
+      m_compressE2FileLogging (false),
       m_cuUpFileName (),
       m_cuCpFileName (),
       m_duFileName (),
+      m_l3SinrMaxAge (Seconds (1)),
+      m_ueStateMaxAge (Seconds (1)),
+      m_proactiveHoHintValidity (Seconds (1)),
+      m_hoPolicyVetoWindow (Seconds (1)),
       m_prbHistory(),
       m_checkPeriod(MilliSeconds(100)),
       m_hasValidSubscription(false)
@@ -367,6 +408,13 @@ MmWaveEnbNetDevice::DoInitialize (void)
           "/NodeList/*/DeviceList/*/LteEnbRrc/NotifyMmWaveSinr",
           MakeBoundCallback (&MmWaveEnbNetDevice::RegisterNewSinrReadingCallback, this));
     }
+
+  // per-UE state is released when the UE leaves this cell, the throughput
+  // counters also when it (re)attaches to it
+  m_rrc->TraceConnectWithoutContext (
+      "UeContextRemoved", MakeCallback (&MmWaveEnbNetDevice::NotifyUeContextRemoved, this));
+  m_rrc->TraceConnectWithoutContext (
+      "HandoverEndOk", MakeCallback (&MmWaveEnbNetDevice::NotifyHandoverEndOk, this));
 }
 
 void
@@ -374,6 +422,23 @@ MmWaveEnbNetDevice::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
 
+  // write out the pending blocks of the E2 csv files
+  if (m_cuUpWriter)
+    {
+      m_cuUpWriter->Close ();
+      m_cuUpWriter = 0;
+    }
+  if (m_cuCpWriter)
+    {
+      m_cuCpWriter->Close ();
+      m_cuCpWriter = 0;
+    }
+  if (m_duWriter)
+    {
+      m_duWriter->Close ();
+      m_duWriter = 0;
+    }
+
   m_rrc->Dispose ();
   m_rrc = 0;
 
@@ -418,12 +483,139 @@ MmWaveEnbNetDevice::RegisterNewSinrReading (uint64_t imsi, uint16_t cellId, long
     {
       // we only need to save the last value, so we erase if exists already a value nd save the new one
       m_l3sinrMap[imsi][cellId] = sinr;
+      m_l3sinrTimeMap[imsi][cellId] = Simulator::Now ();
       /* NS_LOG_LOGIC (Simulator::Now ().GetSeconds ()
                     << " enbdev " << m_cellId << " UE " << imsi << " report for " << cellId
                     << " SINR " << m_l3sinrMap[imsi][cellId]); */
     }
 }
 
+void
+MmWaveEnbNetDevice::EraseUeState (uint64_t imsi)
+{
+  m_l3sinrMap.erase (imsi);
+  m_l3sinrTimeMap.erase (imsi);
+  m_drbThrDlPdcpBasedComputationUeid.erase (imsi);
+  m_drbThrDlUeid.erase (imsi);
+  m_lastSinrValues.erase (imsi);
+  m_ueStateTimeMap.erase (imsi);
+}
+
+void
+MmWaveEnbNetDevice::NotifyUeContextRemoved (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << imsi << cellId << rnti);
+  EraseUeState (imsi);
+}
+
+void
+MmWaveEnbNetDevice::NotifyHandoverEndOk (uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << imsi << cellId << rnti);
+  // drop the throughput counters left from a previous stay of the UE in this
+  // cell. The L3 SINR readings are kept: the UE reported this cell as a
+  // neighbour before the handover and the serving SINR of the next report
+  // comes from them; stale neighbour readings are aged out by PruneL3SinrMap
+  m_drbThrDlPdcpBasedComputationUeid.erase (imsi);
+  m_drbThrDlUeid.erase (imsi);
+  m_lastSinrValues.erase (imsi);
+  m_ueStateTimeMap.erase (imsi);
+}
+
+void
+MmWaveEnbNetDevice::TouchUeState (uint64_t imsi)
+{
+  m_ueStateTimeMap[imsi] = Simulator::Now ();
+}
+
+void
+MmWaveEnbNetDevice::PruneUeState (void)
+{
+  if (m_ueStateMaxAge.IsZero ())
+    {
+      return;
+    }
+  // UEs that detached or handed over without a notification stop being updated
+  Time now = Simulator::Now ();
+  for (auto timeIt = m_ueStateTimeMap.begin (); timeIt != m_ueStateTimeMap.end ();)
+    {
+      if (now - timeIt->second > m_ueStateMaxAge)
+        {
+          NS_LOG_LOGIC ("enbdev " << m_cellId << " UE " << timeIt->first
+                                  << " drop stale throughput / SINR values");
+          m_drbThrDlPdcpBasedComputationUeid.erase (timeIt->first);
+          m_drbThrDlUeid.erase (timeIt->first);
+          m_lastSinrValues.erase (timeIt->first);
+          timeIt = m_ueStateTimeMap.erase (timeIt);
+        }
+      else
+        {
+          ++timeIt;
+        }
+    }
+  // values written without TouchUeState have no age, treat them as stale
+  for (auto sinrIt = m_lastSinrValues.begin (); sinrIt != m_lastSinrValues.end ();)
+    {
+      if (m_ueStateTimeMap.find (sinrIt->first) == m_ueStateTimeMap.end ())
+        {
+          sinrIt = m_lastSinrValues.erase (sinrIt);
+        }
+      else
+        {
+          ++sinrIt;
+        }
+    }
+}
+
+void
+MmWaveEnbNetDevice::PruneL3SinrMap (const std::map<uint16_t, Ptr<UeManager>> &ueMap)
+{
+  std::set<uint64_t> activeImsi;
+  for (auto ue : ueMap)
+    {
+      activeImsi.insert (ue.second->GetImsi ());
+    }
+
+  Time now = Simulator::Now ();
+  for (auto ueIt = m_l3sinrMap.begin (); ueIt != m_l3sinrMap.end ();)
+    {
+      uint64_t imsi = ueIt->first;
+      // UEs whose context release was missed (e.g., RLF without notification)
+      if (activeImsi.find (imsi) == activeImsi.end ())
+        {
+          m_l3sinrTimeMap.erase (imsi);
+          ueIt = m_l3sinrMap.erase (ueIt);
+          continue;
+        }
+
+      if (!m_l3SinrMaxAge.IsZero ())
+        {
+          auto &timeMap = m_l3sinrTimeMap[imsi];
+          for (auto cellIt = ueIt->second.begin (); cellIt != ueIt->second.end ();)
+            {
+              // the serving cell entry is always kept, it is needed for the report
+              auto timeIt = timeMap.find (cellIt->first);
+              if (cellIt->first != m_cellId &&
+                  (timeIt == timeMap.end () || now - timeIt->second > m_l3SinrMaxAge))
+                {
+                  NS_LOG_LOGIC ("enbdev " << m_cellId << " UE " << imsi
+                                          << " drop stale SINR of cell " << cellIt->first);
+                  if (timeIt != timeMap.end ())
+                    {
+                      timeMap.erase (timeIt);
+                    }
+                  cellIt = ueIt->second.erase (cellIt);
+                }
+              else
+                {
+                  ++cellIt;
+                }
+            }
+        }
+      ++ueIt;
+    }
+}
+
 Ptr<MmWaveEnbPhy>
 MmWaveEnbNetDevice::GetPhy (void) const
 {
@@ -501,6 +693,63 @@ MmWaveEnbNetDevice::GetRrc (void)
   return m_rrc;
 }
 
+void
+MmWaveEnbNetDevice::SetUeHoPolicy (const std::vector<uint64_t> &imsiList,
+                                   LteEnbRrc::UeHoPolicy policy, Time vetoWindow)
+{
+  NS_LOG_FUNCTION (this << imsiList.size () << policy << vetoWindow);
+  m_rrc->SetUeHoPolicy (imsiList, policy, vetoWindow);
+}
+
+uint16_t
+MmWaveEnbNetDevice::GetClosestMmWaveCell (const Vector &pos) const
+{
+  NodeContainer &mmWaveEnbNodes = NodeContainerManager::GetInstance ().GetMmWaveEnbNodes ();
+  uint16_t closestCellId = m_cellId;
+  double minDistance = std::numeric_limits<double>::max ();
+  for (uint32_t i = 0; i < mmWaveEnbNodes.GetN (); i++)
+    {
+      Ptr<Node> node = mmWaveEnbNodes.Get (i);
+      Ptr<MmWaveEnbNetDevice> mmdev = DynamicCast<MmWaveEnbNetDevice> (node->GetDevice (0));
+      Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
+      if (!mmdev || !mobility)
+        {
+          continue;
+        }
+      double distance = CalculateDistance (pos, mobility->GetPosition ());
+      if (distance < minDistance)
+        {
+          minDistance = distance;
+          closestCellId = mmdev->GetCellId ();
+        }
+    }
+  return closestCellId;
+}
+
+void
+MmWaveEnbNetDevice::NotifyPredictedTrajectory (uint64_t imsi, const std::vector<Vector> &trajectory)
+{
+  NS_LOG_FUNCTION (this << imsi << trajectory.size ());
+  for (const Vector &pos : trajectory)
+    {
+      uint16_t predictedCellId = GetClosestMmWaveCell (pos);
+      if (predictedCellId != m_cellId)
+        {
+          NS_LOG_INFO ("UE " << imsi << " predicted to move from cell " << m_cellId << " to "
+                             << predictedCellId << " at " << pos);
+          m_rrc->SetProactiveHoHint (imsi, predictedCellId, m_proactiveHoHintValidity);
+          return;
+        }
+    }
+}
+
+void
+MmWaveEnbNetDevice::ReleaseUeHoControl (const std::vector<uint64_t> &imsiList)
+{
+  NS_LOG_FUNCTION (this << imsiList.size ());
+  m_rrc->ReleaseUeHoControl (imsiList);
+}
+
 bool
 MmWaveEnbNetDevice::DoSend (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber)
 {
@@ -552,45 +801,26 @@ MmWaveEnbNetDevice::UpdateConfig (void)
                   Simulator::Schedule (MicroSeconds (0), &E2Termination::Start, m_e2term);
                 }
               //
+              TraceFileWriter::Compression compression = m_compressE2FileLogging
+                                                              ? TraceFileWriter::GZIP_BLOCKS
+                                                              : TraceFileWriter::NONE;
+
               m_cuUpFileName = "cu-up-cell-" + std::to_string (m_cellId) + ".txt";
-              std::ofstream csv{};
-              csv.open (m_cuUpFileName.c_str ());
-              csv << "timestamp,ueImsiComplete,DRB.PdcpSduDelayDl (cellAverageLatency),"
-                     "m_pDCPBytesUL (0),"
-                     "m_pDCPBytesDL (cellDlTxVolume),DRB.PdcpSduVolumeDl_Filter.UEID (txBytes),"
-                     "Tot.PdcpSduNbrDl.UEID (txDlPackets),DRB.PdcpSduBitRateDl.UEID"
-                     "(pdcpThroughput),"
-                     "DRB.PdcpSduDelayDl.UEID (pdcpLatency),QosFlow.PdcpPduVolumeDL_Filter.UEID"
-                     "(txPdcpPduBytesNrRlc),DRB.PdcpPduNbrDl.Qos.UEID (txPdcpPduNrRlc)\n";
-              csv.close ();
+              m_cuUpWriter = Create<TraceFileWriter> (m_cuUpFileName, compression);
+              m_cuUpWriter->Write (0, "timestamp,ueImsiComplete,DRB.PdcpSduDelayDl (cellAverageLatency),"
+                                      "m_pDCPBytesUL (0),"
+                                      "m_pDCPBytesDL (cellDlTxVolume),DRB.PdcpSduVolumeDl_Filter.UEID (txBytes),"
+                                      "Tot.PdcpSduNbrDl.UEID (txDlPackets),DRB.PdcpSduBitRateDl.UEID"
+                                      "(pdcpThroughput),"
+                                      "DRB.PdcpSduDelayDl.UEID (pdcpLatency),QosFlow.PdcpPduVolumeDL_Filter.UEID"
+                                      "(txPdcpPduBytesNrRlc),DRB.PdcpPduNbrDl.Qos.UEID (txPdcpPduNrRlc)\n");
 
               m_cuCpFileName = "cu-cp-cell-" + std::to_string (m_cellId) + ".txt";
-              csv.open (m_cuCpFileName.c_str ());
-              csv << "timestamp,ueImsiComplete,numActiveUes,DRB.EstabSucc.5QI.UEID (numDrb),"
-                     "DRB.RelActNbr.5QI.UEID (0),L3 serving Id(m_cellId),UE (imsi),L3 serving "
-                     "SINR,"
-                     "L3 serving SINR 3gpp,"
-                     "L3 neigh Id 1 (cellId),L3 neigh SINR 1,L3 neigh SINR 3gpp 1 "
-                     "(convertedSinr),"
-                     "L3 neigh Id 2 (cellId),L3 neigh SINR 2,L3 neigh SINR 3gpp 2 "
-                     "(convertedSinr),"
-                     "L3 neigh Id 3 (cellId),L3 neigh SINR 3,L3 neigh SINR 3gpp 3 "
-                     "(convertedSinr),"
-                     "L3 neigh Id 4 (cellId),L3 neigh SINR 4,L3 neigh SINR 3gpp 4 "
-                     "(convertedSinr),"
-                     "L3 neigh Id 5 (cellId),L3 neigh SINR 5,L3 neigh SINR 3gpp 5 "
-                     "(convertedSinr),"
-                     "L3 neigh Id 6 (cellId),L3 neigh SINR 6,L3 neigh SINR 3gpp 6 "
-                     "(convertedSinr),"
-                     "L3 neigh Id 7 (cellId),L3 neigh SINR 7,L3 neigh SINR 3gpp 7 "
-                     "(convertedSinr),"
-                     "L3 neigh Id 8 (cellId),L3 neigh SINR 8,L3 neigh SINR 3gpp 8 "
-                     "(convertedSinr)"
-                     "\n";
-              csv.close ();
+              m_cuCpWriter = Create<TraceFileWriter> (m_cuCpFileName, compression);
+              m_cuCpWriter->Write (0, GetCuCpTraceHeader ());
 
               m_duFileName = "du-cell-" + std::to_string (m_cellId) + ".txt";
-              csv.open (m_duFileName.c_str ());
+              m_duWriter = Create<TraceFileWriter> (m_duFileName, compression);
 
               std::string header_csv = "timestamp,ueImsiComplete,plmId,nrCellId,dlAvailablePrbs,"
                                        "ulAvailablePrbs,qci,dlPrbUsage,ulPrbUsage";
@@ -621,8 +851,7 @@ MmWaveEnbNetDevice::UpdateConfig (void)
                   "L1M.RS-SINR.Bin94.UEID,L1M.RS-SINR.Bin127.UEID,DRB.BufferSize.Qos.UEID,"
                   "DRB.UEThpDl.UEID, DRB.UEThpDlPdcpBased.UEID";
 
-              csv << header_csv + "," + cell_header + "," + ue_header + "\n";
-              csv.close ();
+              m_duWriter->Write (0, header_csv + "," + cell_header + "," + ue_header + "\n");
               // TODO: Look at RicSubscriptionRequest_rval_s
               std::string plmId = "111";
               std::string gnbId = std::to_string (m_cellId);
@@ -781,6 +1010,38 @@ MmWaveEnbNetDevice::ControlMessageReceivedCallback (E2AP_PDU_t *sub_req_pdu)
           }
         break;
       }
+      case Position_Hint_Style: {
+        UEID_GNB_t *UEgnb = controlMessage->m_e2SmRcControlHeaderFormat1->ueID.choice.gNB_UEID;
+        uint64_t imsi = {0};
+        memcpy (&imsi, UEgnb->ran_UEID->buf, UEgnb->ran_UEID->size);
+        uint16_t targetCellId = controlMessage->GetTargetCell ();
+        NS_LOG_INFO ("Position hint for UE " << imsi << " predicted cell " << targetCellId);
+        m_rrc->SetProactiveHoHint (imsi, targetCellId, m_proactiveHoHintValidity);
+        break;
+      }
+      case Ho_Policy_Style: {
+        UEID_GNB_t *UEgnb = controlMessage->m_e2SmRcControlHeaderFormat1->ueID.choice.gNB_UEID;
+        uint64_t imsi = {0};
+        memcpy (&imsi, UEgnb->ran_UEID->buf, UEgnb->ran_UEID->size);
+        uint16_t policyValue = controlMessage->GetTargetCell ();
+        std::vector<uint64_t> imsiList{imsi};
+        if (policyValue == 0)
+          {
+            NS_LOG_INFO ("HO policy of UE " << imsi << " released");
+            ReleaseUeHoControl (imsiList);
+          }
+        else if (policyValue - 1 <= LteEnbRrc::HO_HYBRID)
+          {
+            LteEnbRrc::UeHoPolicy policy = static_cast<LteEnbRrc::UeHoPolicy> (policyValue - 1);
+            NS_LOG_INFO ("HO policy of UE " << imsi << " set to " << policy);
+            SetUeHoPolicy (imsiList, policy, m_hoPolicyVetoWindow);
+          }
+        else
+          {
+            NS_LOG_WARN ("Unknown HO policy " << policyValue << " for UE " << imsi);
+          }
+        break;
+      }
       case RicControlMessage::ControlMessageServiceStyle::Energy_state: {
         // TODO: Encode the RIC contol request and turn off incoming old cell.
         // int flexric_cell_id = 2; // from control req
@@ -846,6 +1107,32 @@ MmWaveEnbNetDevice::SetE2Termination (Ptr<E2Termination> e2term)
     }
 }
 
+std::string
+MmWaveEnbNetDevice::GetCuCpTraceHeader (void)
+{
+  return "timestamp,ueImsiComplete,numActiveUes,DRB.EstabSucc.5QI.UEID (numDrb),"
+         "DRB.RelActNbr.5QI.UEID (0),L3 serving Id(m_cellId),UE (imsi),L3 serving "
+         "SINR,"
+         "L3 serving SINR 3gpp,"
+         "L3 neigh Id 1 (cellId),L3 neigh SINR 1,L3 neigh SINR 3gpp 1 "
+         "(convertedSinr),"
+         "L3 neigh Id 2 (cellId),L3 neigh SINR 2,L3 neigh SINR 3gpp 2 "
+         "(convertedSinr),"
+         "L3 neigh Id 3 (cellId),L3 neigh SINR 3,L3 neigh SINR 3gpp 3 "
+         "(convertedSinr),"
+         "L3 neigh Id 4 (cellId),L3 neigh SINR 4,L3 neigh SINR 3gpp 4 "
+         "(convertedSinr),"
+         "L3 neigh Id 5 (cellId),L3 neigh SINR 5,L3 neigh SINR 3gpp 5 "
+         "(convertedSinr),"
+         "L3 neigh Id 6 (cellId),L3 neigh SINR 6,L3 neigh SINR 3gpp 6 "
+         "(convertedSinr),"
+         "L3 neigh Id 7 (cellId),L3 neigh SINR 7,L3 neigh SINR 3gpp 7 "
+         "(convertedSinr),"
+         "L3 neigh Id 8 (cellId),L3 neigh SINR 8,L3 neigh SINR 3gpp 8 "
+         "(convertedSinr)"
+         "\n";
+}
+
 std::string
 MmWaveEnbNetDevice::GetImsiString (uint64_t imsi)
 {
@@ -970,6 +1257,7 @@ MmWaveEnbNetDevice::BuildRicIndicationMessageCuUp (std::string plmId)
       double rlcBitrate = (rlcLatency == 0) ? 0 : pduStats / rlcLatency; // unit kbit/s
 
       m_drbThrDlUeid[imsi] = rlcBitrate;
+      TouchUeState (imsi);
 
       NS_LOG_DEBUG (Simulator::Now ().GetSeconds ()
                     << " " << m_cellId << " cell, connected UE with IMSI " << imsi
@@ -1001,12 +1289,7 @@ MmWaveEnbNetDevice::BuildRicIndicationMessageCuUp (std::string plmId)
 
   if (m_forceE2FileLogging)
     {
-      std::ofstream csv{};
-      csv.open (m_cuUpFileName.c_str (), std::ios_base::app);
-      if (!csv.is_open ())
-        {
-          NS_FATAL_ERROR ("Can't open file " << m_cuUpFileName.c_str ());
-        }
+      std::string rows;
 
       uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now ().GetMilliSeconds ();
 
@@ -1026,9 +1309,9 @@ MmWaveEnbNetDevice::BuildRicIndicationMessageCuUp (std::string plmId)
           std::string to_print = std::to_string (timestamp) + "," + ueImsiComplete + "," + "," +
                                  "," + "," + uePms + "\n";
 
-          csv << to_print;
+          rows += to_print;
         }
-      csv.close ();
+      m_cuUpWriter->Write (timestamp, rows);
       return nullptr;
     }
   else
@@ -1064,6 +1347,8 @@ MmWaveEnbNetDevice::BuildRicIndicationMessageCuCp (std::string plmId)
 
   auto ueMap = m_rrc->GetUeMap ();
 
+  PruneL3SinrMap (ueMap);
+
   std::unordered_map<uint64_t, std::string> uePmString{};
 
   for (auto ue : ueMap)
@@ -1185,14 +1470,7 @@ MmWaveEnbNetDevice::BuildRicIndicationMessageCuCp (std::string plmId)
 
   if (m_forceE2FileLogging)
     {
-      std::ofstream csv{};
-      csv.open (m_cuCpFileName.c_str (), std::ios_base::app);
-      if (!csv.is_open ())
-        {
-          NS_FATAL_ERROR ("Can't open file " << m_cuCpFileName.c_str ());
-        }
-
-      NS_LOG_DEBUG ("m_cuCpFileName open " << m_cuCpFileName);
+      std::string rows;
 
       // the string is timestamp, ueImsiComplete, numActiveUes, DRB.EstabSucc.5QI.UEID (numDrb), DRB.RelActNbr.5QI.UEID (0), L3 serving Id (m_cellId), UE (imsi), L3 serving SINR, L3 serving SINR 3gpp, L3 neigh Id (cellId), L3 neigh Sinr, L3 neigh SINR 3gpp (convertedSinr)
       // The values for L3 neighbour cells are repeated for each neighbour (7 times in this implementation)
@@ -1211,9 +1489,9 @@ MmWaveEnbNetDevice::BuildRicIndicationMessageCuCp (std::string plmId)
 
           NS_LOG_DEBUG (to_print);
 
-          csv << to_print;
+          rows += to_print;
         }
-      csv.close ();
+      m_cuCpWriter->Write (timestamp, rows);
       return nullptr;
     }
   else
@@ -1269,6 +1547,8 @@ MmWaveEnbNetDevice::BuildRicIndicationMessageDu (std::string plmId, uint16_t nrC
 
   auto ueMap = m_rrc->GetUeMap ();
 
+  PruneUeState ();
+
   uint32_t macPduCellSpecific = 0;
   uint32_t macPduInitialCellSpecific = 0;
   uint32_t macVolumeCellSpecific = 0;
@@ -1521,12 +1801,7 @@ MmWaveEnbNetDevice::BuildRicIndicationMessageDu (std::string plmId, uint16_t nrC
 
   if (m_forceE2FileLogging)
     {
-      std::ofstream csv{};
-      csv.open (m_duFileName.c_str (), std::ios_base::app);
-      if (!csv.is_open ())
-        {
-          NS_FATAL_ERROR ("Can't open file " << m_duFileName.c_str ());
-        }
+      std::string rows;
 
       uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now ().GetMilliSeconds ();
 
@@ -1572,9 +1847,9 @@ MmWaveEnbNetDevice::BuildRicIndicationMessageDu (std::string plmId, uint16_t nrC
           std::string to_print = std::to_string (timestamp) + "," + ueImsiComplete + "," +
                                  to_print_cell + "," + uePms + "\n";
 
-          csv << to_print;
+          rows += to_print;
         }
-      csv.close ();
+      m_duWriter->Write (timestamp, rows);
 
       return nullptr;
     }
@@ -1600,6 +1875,7 @@ MmWaveEnbNetDevice::BuildAndSendReportMessage (E2Termination::RicSubscriptionReq
       // Create CU-UP
       Ptr<KpmIndicationHeader> header = BuildRicIndicationHeader (plmId, gnbId, m_cellId);
       Ptr<KpmIndicationMessage> cuUpMsg = BuildRicIndicationMessageCuUp (plmId);
+      m_e2ReportTrace (m_cellId, CU_UP_REPORT);
 
       // Send CU-UP only if offline logging is disabled
       if (header != nullptr && cuUpMsg != nullptr)
@@ -1624,6 +1900,7 @@ MmWaveEnbNetDevice::BuildAndSendReportMessage (E2Termination::RicSubscriptionReq
       // Create and send CU-CP
       Ptr<KpmIndicationHeader> header = BuildRicIndicationHeader (plmId, gnbId, m_cellId);
       Ptr<KpmIndicationMessage> cuCpMsg = BuildRicIndicationMessageCuCp (plmId);
+      m_e2ReportTrace (m_cellId, CU_CP_REPORT);
 
       // Send CU-CP only if offline logging is disabled
       if (header != nullptr && cuCpMsg != nullptr)
@@ -1649,6 +1926,7 @@ MmWaveEnbNetDevice::BuildAndSendReportMessage (E2Termination::RicSubscriptionReq
       // Create DU
       Ptr<KpmIndicationHeader> header = BuildRicIndicationHeader (plmId, gnbId, m_cellId);
       Ptr<KpmIndicationMessage> duMsg = BuildRicIndicationMessageDu (plmId, m_cellId);
+      m_e2ReportTrace (m_cellId, DU_REPORT);
 
       // Send DU only if offline logging is disabled
       if (header != nullptr && duMsg != nullptr)
@@ -1697,6 +1975,8 @@ MmWaveEnbNetDevice::BuildGUIDu (std::string plmId, uint16_t nrCellId)
 {
   auto ueMap = m_rrc->GetUeMap ();
 
+  PruneUeState ();
+
   uint32_t macPduCellSpecific = 0;
   uint32_t macPduInitialCellSpecific = 0;
   uint32_t macVolumeCellSpecific = 0;
@@ -1908,12 +2188,7 @@ MmWaveEnbNetDevice::BuildGUIDu (std::string plmId, uint16_t nrCellId)
                               (long) 100); // percentage of used PRBs
   long ulPrbUsage = 0; // TODO for future implementation
 
-  std::ofstream csv{};
-  csv.open (m_duFileName.c_str (), std::ios_base::app);
-  if (!csv.is_open ())
-    {
-      NS_FATAL_ERROR ("Can't open file " << m_duFileName.c_str ());
-    }
+  std::string rows;
 
   uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now ().GetMilliSeconds ();
 
@@ -1956,9 +2231,9 @@ MmWaveEnbNetDevice::BuildGUIDu (std::string plmId, uint16_t nrCellId)
       std::string to_print = std::to_string (timestamp) + "," + ueImsiComplete + "," +
                              to_print_cell + "," + uePms + "\n";
 
-      csv << to_print;
+      rows += to_print;
     }
-  csv.close ();
+  m_duWriter->Write (timestamp, rows);
   Simulator::Schedule (MilliSeconds (100), &MmWaveEnbNetDevice::BuildGUIDu, this, plmId, m_cellId);
 
   return nullptr;
@@ -1970,6 +2245,8 @@ MmWaveEnbNetDevice::BuildGUICuCp (std::string plmId)
 
   auto ueMap = m_rrc->GetUeMap ();
 
+  PruneL3SinrMap (ueMap);
+
   std::unordered_map<uint64_t, std::string> uePmString{};
 
   for (auto ue : ueMap)
@@ -2062,14 +2339,7 @@ MmWaveEnbNetDevice::BuildGUICuCp (std::string plmId)
 
       uePmString.insert (std::make_pair (imsi, servingStr + neighStr));
     }
-  std::ofstream csv{};
-  csv.open (m_cuCpFileName.c_str (), std::ios_base::app);
-  if (!csv.is_open ())
-    {
-      NS_FATAL_ERROR ("Can't open file " << m_cuCpFileName.c_str ());
-    }
-
-  NS_LOG_DEBUG ("m_cuCpFileName open " << m_cuCpFileName);
+  std::string rows;
 
   // the string is timestamp, ueImsiComplete, numActiveUes, DRB.EstabSucc.5QI.UEID (numDrb), DRB.RelActNbr.5QI.UEID (0), L3 serving Id (m_cellId), UE (imsi), L3 serving SINR, L3 serving SINR 3gpp, L3 neigh Id (cellId), L3 neigh Sinr, L3 neigh SINR 3gpp (convertedSinr)
   // The values for L3 neighbour cells are repeated for each neighbour (7 times in this implementation)
@@ -2088,9 +2358,9 @@ MmWaveEnbNetDevice::BuildGUICuCp (std::string plmId)
 
       NS_LOG_DEBUG (to_print);
 
-      csv << to_print;
+      rows += to_print;
     }
-  csv.close ();
+  m_cuCpWriter->Write (timestamp, rows);
   Simulator::Schedule (MilliSeconds (100), &MmWaveEnbNetDevice::BuildGUICuCp, this, plmId);
   return nullptr;
 }
@@ -2167,6 +2437,7 @@ MmWaveEnbNetDevice::BuildGUICuUp (std::string plmId)
       double rlcBitrate = (rlcLatency == 0) ? 0 : pduStats / rlcLatency; // unit kbit/s
 
       m_drbThrDlUeid[imsi] = rlcBitrate;
+      TouchUeState (imsi);
 
       NS_LOG_DEBUG (Simulator::Now ().GetSeconds ()
                     << " " << m_cellId << " cell, connected UE with IMSI " << imsi
@@ -2185,12 +2456,7 @@ MmWaveEnbNetDevice::BuildGUICuUp (std::string plmId)
   NS_LOG_DEBUG (Simulator::Now ().GetSeconds ()
                 << " " << m_cellId << " cell volume " << cellDlTxVolume);
 
-  std::ofstream csv{};
-  csv.open (m_cuUpFileName.c_str (), std::ios_base::app);
-  if (!csv.is_open ())
-    {
-      NS_FATAL_ERROR ("Can't open file " << m_cuUpFileName.c_str ());
-    }
+  std::string rows;
 
   uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now ().GetMilliSeconds ();
 
@@ -2210,9 +2476,9 @@ MmWaveEnbNetDevice::BuildGUICuUp (std::string plmId)
       std::string to_print =
           std::to_string (timestamp) + "," + ueImsiComplete + "," + "," + "," + "," + uePms + "\n";
 
-      csv << to_print;
+      rows += to_print;
     }
-  csv.close ();
+  m_cuUpWriter->Write (timestamp, rows);
   Simulator::Schedule (MilliSeconds (100), &MmWaveEnbNetDevice::BuildGUICuUp, this, plmId);
   return nullptr;
 }
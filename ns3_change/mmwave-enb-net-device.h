@@ -49,10 +49,12 @@
 #include "mmwave-mac-scheduler.h"
 #include <vector>
 #include <map>
+#include <set>
 #include <ns3/lte-enb-rrc.h>
 #include <ns3/oran-interface.h>
 #include "ns3/mmwave-bearer-stats-calculator.h"
 #include <ns3/mmwave-phy-trace.h>
+#include "mmwave-trace-file-writer.h"
 
 
 
@@ -127,6 +129,17 @@ namespace ns3 {
 
             Ptr<LteEnbRrc> GetRrc(void);
 
+            /**
+             * Set the handover policy of a group of UEs served by this cell (forwarded to LteEnbRrc)
+             */
+            void SetUeHoPolicy(const std::vector<uint64_t> &imsiList, LteEnbRrc::UeHoPolicy policy,
+                               Time vetoWindow = Seconds (0));
+
+            /**
+             * Give a group of UEs back to the autonomous handover heuristic
+             */
+            void ReleaseUeHoControl(const std::vector<uint64_t> &imsiList);
+
             void SetE2Termination(Ptr<E2Termination> e2term);
 
             Ptr<E2Termination> GetE2Termination() const;
@@ -138,10 +151,66 @@ namespace ns3 {
             void KpmSubscriptionCallback(E2AP_PDU_t *sub_req_pdu);
 
             void ControlMessageReceivedCallback(E2AP_PDU_t *sub_req_pdu);
+
+            /**
+             * Non-standard RIC control style carrying a predicted target cell for a UE,
+             * not a position: the xApp maps its predicted position to a cell itself.
+             * Same header format 1 (ueID) and target cell RAN parameter as
+             * Connected_Mode_Mobility / Handover_Control. No xApp in ue_localzation
+             * sends it yet. The hint goes to the IMSI-keyed table shared by the
+             * LteEnbRrc instances, where the LTE coordinator RRC reads it.
+             */
+            static const long Position_Hint_Style = 255;
+
+            /**
+             * Non-standard RIC control style used to set the handover policy of the UE
+             * of header format 1 (ueID). The target cell RAN parameter carries the policy:
+             * 0 releases the UE (ReleaseUeHoControl), 1 + LteEnbRrc::UeHoPolicy sets it
+             * (SetUeHoPolicy, with HoPolicyVetoWindow for HO_HYBRID).
+             */
+            static const long Ho_Policy_Style = 254;
+
+            /**
+             * Feed a predicted trajectory of a UE served by this cell. The first
+             * predicted position whose closest mmWave cell differs from this one is
+             * passed to LteEnbRrc as a proactive handover hint. C++ entry point only,
+             * the E2 control messages cannot carry positions. The localization
+             * scenario calls it with a constant-velocity prediction (trajectoryHorizon).
+             * \param imsi the UE
+             * \param trajectory predicted positions, in time order
+             */
+            void NotifyPredictedTrajectory(uint64_t imsi, const std::vector<Vector> &trajectory);
+
+            /**
+             * \return the IMSI as written in the ueImsiComplete column of the E2 csv files
+             */
+            static std::string GetImsiString(uint64_t imsi);
+
+            /**
+             * \return the header row of the cu-cp-cell-<cellId>.txt files
+             */
+            static std::string GetCuCpTraceHeader(void);
             void SetStartTime(uint64_t);
 
             void stopSendingAndCancelSchedule();
 
+            /**
+             * Report type of the E2ReportBuilt trace
+             */
+            enum E2ReportType
+            {
+              CU_UP_REPORT = 0,
+              CU_CP_REPORT = 1,
+              DU_REPORT = 2
+            };
+
+            /**
+             * TracedCallback signature for the E2ReportBuilt trace
+             * \param cellId the reporting cell
+             * \param reportType one of E2ReportType
+             */
+            typedef void (*E2ReportTracedCallback) (uint16_t cellId, uint8_t reportType);
+
         protected:
             virtual void DoInitialize(void) override;
 
@@ -189,8 +258,6 @@ namespace ns3 {
             Ptr<KpmIndicationMessage> BuildGUICuCp(std::string plmId);
             Ptr<KpmIndicationMessage> BuildGUICuUp(std::string plmId);
 
-            std::string GetImsiString(uint64_t imsi);
-
             uint32_t GetRlcBufferOccupancy(Ptr<LteRlc> rlc) const;
 
             bool m_sendCuUp;
@@ -203,7 +270,51 @@ namespace ns3 {
 
             void RegisterNewSinrReading(uint64_t imsi, uint16_t cellId, long double sinr);
 
+            /**
+             * Release all the per-UE state (L3 SINR and throughput maps) of the given UE
+             */
+            void EraseUeState (uint64_t imsi);
+
+            /**
+             * Connected to the LteEnbRrc UeContextRemoved trace
+             */
+            void NotifyUeContextRemoved (uint64_t imsi, uint16_t cellId, uint16_t rnti);
+
+            /**
+             * Connected to the LteEnbRrc HandoverEndOk trace, releases the throughput
+             * state of the UE and keeps its L3 SINR readings
+             */
+            void NotifyHandoverEndOk (uint64_t imsi, uint16_t cellId, uint16_t rnti);
+
+            /**
+             * Drop the L3 SINR entries of UEs no longer attached to this cell, and the
+             * neighbour readings older than m_l3SinrMaxAge
+             */
+            void PruneL3SinrMap (const std::map<uint16_t, Ptr<UeManager>> &ueMap);
+
+            /**
+             * Record that the throughput / SINR values of the UE were updated now
+             */
+            void TouchUeState (uint64_t imsi);
+
+            /**
+             * Drop the throughput and m_lastSinrValues entries of UEs not updated
+             * for more than m_ueStateMaxAge
+             */
+            void PruneUeState (void);
+
             std::map <uint64_t, std::map<uint16_t, long double>> m_l3sinrMap;
+            std::map <uint64_t, std::map<uint16_t, Time>> m_l3sinrTimeMap; //< time of the last reading in m_l3sinrMap
+            Time m_l3SinrMaxAge; //< age-out of the neighbour readings, 0 to disable
+            std::map <uint64_t, Time> m_ueStateTimeMap; //< last update of the throughput / SINR values of the UE
+            Time m_ueStateMaxAge; //< age-out of the per-UE throughput / SINR values, 0 to disable
+
+            /**
+             * \return the cell id of the mmWave gNB closest to the given position
+             */
+            uint16_t GetClosestMmWaveCell(const Vector &pos) const;
+            Time m_proactiveHoHintValidity; //< lifetime of the position-based HO hints
+            Time m_hoPolicyVetoWindow; //< veto window of the HO_HYBRID policies set through Ho_Policy_Style
             uint64_t m_startTime;
             std::map <uint64_t, uint32_t> m_drbThrDlPdcpBasedComputationUeid;
             std::map <uint64_t, uint32_t> m_drbThrDlUeid;
@@ -215,9 +326,14 @@ namespace ns3 {
             double e2_func_id; //to pass kpm function id
             bool m_e2andlog; //if true, both e2 term and e2file logging will work
             bool m_forceE2FileLogging; //< if true log PMs to files
+            bool m_compressE2FileLogging; //< if true write the PM files as indexed gzip blocks
             std::string m_cuUpFileName;
             std::string m_cuCpFileName;
             std::string m_duFileName;
+            Ptr<TraceFileWriter> m_cuUpWriter;
+            Ptr<TraceFileWriter> m_cuCpWriter;
+            Ptr<TraceFileWriter> m_duWriter;
+            TracedCallback<uint16_t, uint8_t> m_e2ReportTrace; //< one call per KPM report built (E2 or file)
 
             double CalculatePrbAverage (void);
             void CheckReportingFlag (void);
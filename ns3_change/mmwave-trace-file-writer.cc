@@ -0,0 +1,200 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2025 WITLAB
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "mmwave-trace-file-writer.h"
+#include <ns3/log.h>
+#include <ns3/fatal-error.h>
+#include <zlib.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TraceFileWriter");
+
+namespace mmwave {
+
+TraceFileWriter::TraceFileWriter (std::string fileName, Compression compression,
+                                  uint32_t blockSize)
+    : m_fileName (fileName),
+      m_compression (compression),
+      m_blockSize (blockSize),
+      m_closed (false),
+      m_blockFirstTimestamp (0),
+      m_rawOffset (0),
+      m_compressedOffset (0),
+      m_blockNumber (0)
+{
+  NS_LOG_FUNCTION (this << fileName << compression << blockSize);
+
+  if (m_compression == GZIP_BLOCKS)
+    {
+      m_fileName += ".gz";
+      m_file.open (m_fileName.c_str (), std::ios_base::out | std::ios_base::trunc |
+                                            std::ios_base::binary);
+      std::string indexName = m_fileName + ".idx";
+      m_index.open (indexName.c_str (), std::ios_base::out | std::ios_base::trunc);
+      if (!m_index.is_open ())
+        {
+          NS_FATAL_ERROR ("Can't open file " << indexName);
+        }
+      m_index << "block,firstTimestamp,rawOffset,rawLength,gzOffset,gzLength\n";
+    }
+  else
+    {
+      m_file.open (m_fileName.c_str (), std::ios_base::out | std::ios_base::trunc);
+    }
+
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("Can't open file " << m_fileName);
+    }
+
+  if (m_compression == GZIP_BLOCKS)
+    {
+      m_block.reserve (m_blockSize);
+    }
+}
+
+TraceFileWriter::~TraceFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+TraceFileWriter::Write (uint64_t timestamp, const std::string &rows)
+{
+  if (m_closed)
+    {
+      return;
+    }
+
+  if (m_compression == NONE)
+    {
+      // plain text rows go straight to the file, as the per-report
+      // open/append/close did, so a killed run keeps everything written so far
+      m_file.write (rows.data (), rows.size ());
+      m_file.flush ();
+      m_rawOffset += rows.size ();
+      return;
+    }
+
+  if (m_block.empty ())
+    {
+      m_blockFirstTimestamp = timestamp;
+    }
+  m_block += rows;
+
+  if (m_block.size () >= m_blockSize)
+    {
+      WriteBlock ();
+    }
+}
+
+void
+TraceFileWriter::WriteBlock ()
+{
+  if (m_block.empty ())
+    {
+      return;
+    }
+
+  // every block is an independent gzip member, so that it can be inflated
+  // on its own starting from the offset stored in the index
+  z_stream strm{};
+  // windowBits 15 + 16 selects the gzip wrapper
+  if (deflateInit2 (&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                    Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      NS_FATAL_ERROR ("deflateInit2 failed for " << m_fileName);
+    }
+
+  m_deflateBuffer.resize (deflateBound (&strm, m_block.size ()));
+  strm.next_in = reinterpret_cast<Bytef *> (const_cast<char *> (m_block.data ()));
+  strm.avail_in = m_block.size ();
+  strm.next_out = m_deflateBuffer.data ();
+  strm.avail_out = m_deflateBuffer.size ();
+
+  int ret = deflate (&strm, Z_FINISH);
+  if (ret != Z_STREAM_END)
+    {
+      deflateEnd (&strm);
+      NS_FATAL_ERROR ("deflate failed for " << m_fileName << " (" << ret << ")");
+    }
+  uint64_t compressedSize = strm.total_out;
+  deflateEnd (&strm);
+
+  m_file.write (reinterpret_cast<const char *> (m_deflateBuffer.data ()), compressedSize);
+
+  m_index << m_blockNumber << "," << m_blockFirstTimestamp << "," << m_rawOffset << ","
+          << m_block.size () << "," << m_compressedOffset << "," << compressedSize << "\n";
+
+  NS_LOG_LOGIC (m_fileName << " block " << m_blockNumber << " raw " << m_block.size ()
+                           << " compressed " << compressedSize);
+
+  m_blockNumber++;
+  m_rawOffset += m_block.size ();
+  m_compressedOffset += compressedSize;
+  m_block.clear ();
+}
+
+void
+TraceFileWriter::Flush ()
+{
+  if (m_closed)
+    {
+      return;
+    }
+  WriteBlock ();
+  m_file.flush ();
+  if (m_index.is_open ())
+    {
+      m_index.flush ();
+    }
+}
+
+void
+TraceFileWriter::Close ()
+{
+  if (m_closed)
+    {
+      return;
+    }
+  Flush ();
+  m_file.close ();
+  if (m_index.is_open ())
+    {
+      m_index.close ();
+    }
+  m_closed = true;
+}
+
+std::string
+TraceFileWriter::GetFileName () const
+{
+  return m_fileName;
+}
+
+bool
+TraceFileWriter::IsCompressed () const
+{
+  return m_compression == GZIP_BLOCKS;
+}
+
+} // namespace mmwave
+
+} // namespace ns3
@@ -0,0 +1,116 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2025 WITLAB
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef SRC_MMWAVE_MODEL_MMWAVE_TRACE_FILE_WRITER_H_
+#define SRC_MMWAVE_MODEL_MMWAVE_TRACE_FILE_WRITER_H_
+
+#include <ns3/simple-ref-count.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * Persistent writer for the csv traces produced by the E2 file logging
+ * (cu-up/cu-cp/du) and by the scenario position logging.
+ *
+ * With compression disabled every Write is appended to a plain text file
+ * and flushed right away, so a run that is killed or times out loses no
+ * rows. With compression enabled rows are accumulated in memory and each
+ * block is deflated into an independent gzip member, so the
+ * output (<name>.gz) is a regular multi-member gzip file readable by zcat
+ * or pandas, and a side index (<name>.gz.idx) records, for every block, the
+ * first timestamp it contains and its offsets in the raw and compressed
+ * streams. A reader can seek to the member covering a given timestamp and
+ * inflate only that block.
+ */
+class TraceFileWriter : public SimpleRefCount<TraceFileWriter>
+{
+public:
+  enum Compression
+  {
+    NONE = 0,
+    GZIP_BLOCKS = 1
+  };
+
+  static const uint32_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+  /**
+   * \param fileName name of the uncompressed trace, ".gz" is appended when
+   *        compression is enabled
+   * \param compression block compression mode
+   * \param blockSize size in bytes of the raw data collected before a block
+   *        is written out (compressed mode only)
+   */
+  TraceFileWriter (std::string fileName, Compression compression,
+                   uint32_t blockSize = DEFAULT_BLOCK_SIZE);
+
+  ~TraceFileWriter ();
+
+  /**
+   * Append one or more complete csv rows.
+   *
+   * \param timestamp timestamp of the first row, stored in the block index
+   * \param rows the rows, terminated by '\n'
+   */
+  void Write (uint64_t timestamp, const std::string &rows);
+
+  /**
+   * Write out the pending block, if any, and flush the file.
+   */
+  void Flush ();
+
+  /**
+   * Flush and close the file. Further writes are ignored.
+   */
+  void Close ();
+
+  /**
+   * \return the name of the file actually written on disk
+   */
+  std::string GetFileName () const;
+
+  bool IsCompressed () const;
+
+private:
+  void WriteBlock ();
+
+  std::string m_fileName;
+  Compression m_compression;
+  uint32_t m_blockSize;
+  bool m_closed;
+
+  std::ofstream m_file;
+  std::ofstream m_index;
+
+  std::string m_block;                 //!< raw rows of the pending block
+  uint64_t m_blockFirstTimestamp;
+  uint64_t m_rawOffset;                //!< raw bytes written before the pending block
+  uint64_t m_compressedOffset;         //!< bytes written on disk before the pending block
+  uint32_t m_blockNumber;
+  std::vector<unsigned char> m_deflateBuffer;
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_MODEL_MMWAVE_TRACE_FILE_WRITER_H_ */
@@ -0,0 +1,271 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2025 WITLAB
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "simulation-telemetry.h"
+#include <ns3/log.h>
+#include <ns3/fatal-error.h>
+#include <ns3/simulator.h>
+#include <ns3/object-factory.h>
+#include <ns3/config.h>
+#include <ns3/callback.h>
+#include <ns3/global-value.h>
+#include <ns3/string.h>
+#include <unistd.h>
+#include <cstdio>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulationTelemetry");
+
+namespace mmwave {
+
+NS_OBJECT_ENSURE_REGISTERED (TelemetryMapScheduler);
+
+uint64_t TelemetryMapScheduler::s_pendingEvents = 0;
+
+TypeId
+TelemetryMapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TelemetryMapScheduler")
+                          .SetParent<MapScheduler> ()
+                          .SetGroupName ("mmwave")
+                          .AddConstructor<TelemetryMapScheduler> ();
+  return tid;
+}
+
+TelemetryMapScheduler::TelemetryMapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TelemetryMapScheduler::~TelemetryMapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TelemetryMapScheduler::Insert (const Event &ev)
+{
+  MapScheduler::Insert (ev);
+  s_pendingEvents++;
+}
+
+Scheduler::Event
+TelemetryMapScheduler::RemoveNext (void)
+{
+  s_pendingEvents--;
+  return MapScheduler::RemoveNext ();
+}
+
+void
+TelemetryMapScheduler::Remove (const Event &ev)
+{
+  MapScheduler::Remove (ev);
+  s_pendingEvents--;
+}
+
+uint64_t
+TelemetryMapScheduler::GetPendingEvents (void)
+{
+  return s_pendingEvents;
+}
+
+SimulationTelemetry::SimulationTelemetry (std::string fileName, Time interval)
+    : m_fileName (fileName),
+      m_interval (interval),
+      m_running (false),
+      m_countPendingEvents (false),
+      m_lastWall (0),
+      m_lastSim (0),
+      m_lastEvents (0),
+      m_e2Reports (0),
+      m_handovers (0),
+      m_sinrReadings (0)
+{
+  NS_LOG_FUNCTION (this << fileName << interval);
+  m_file.open (m_fileName.c_str (), std::ios_base::out | std::ios_base::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("Can't open file " << m_fileName);
+    }
+  m_file << "simTime,wallTime,events,eventsPerWallSecond,simPerWall,pendingEvents,rssKiB,"
+            "e2Reports,handovers,sinrReadings\n";
+}
+
+SimulationTelemetry::~SimulationTelemetry ()
+{
+  NS_LOG_FUNCTION (this);
+  // no last row here: the simulator may already be destroyed
+  m_file.close ();
+}
+
+void
+SimulationTelemetry::Start (bool countPendingEvents)
+{
+  NS_LOG_FUNCTION (this << countPendingEvents);
+  if (m_running || !m_file.is_open ())
+    {
+      return;
+    }
+
+  if (countPendingEvents)
+    {
+      StringValue schedulerType;
+      GlobalValue::GetValueByName ("SchedulerType", schedulerType);
+      if (schedulerType.Get () != "ns3::MapScheduler")
+        {
+          NS_LOG_WARN ("SchedulerType " << schedulerType.Get ()
+                                        << " is replaced by TelemetryMapScheduler");
+        }
+      ObjectFactory factory;
+      factory.SetTypeId (TelemetryMapScheduler::GetTypeId ());
+      Simulator::SetScheduler (factory);
+    }
+  m_countPendingEvents = countPendingEvents;
+
+  m_running = true;
+  m_wallStart = std::chrono::steady_clock::now ();
+  m_lastWall = 0;
+  m_lastSim = Simulator::Now ().GetSeconds ();
+  m_lastEvents = Simulator::GetEventCount ();
+  m_sampleEvent = Simulator::Schedule (m_interval, &SimulationTelemetry::Sample, this);
+}
+
+void
+SimulationTelemetry::Stop (void)
+{
+  if (!m_running)
+    {
+      return;
+    }
+  m_sampleEvent.Cancel ();
+  WriteRow ();
+  m_file.close ();
+  m_running = false;
+}
+
+void
+SimulationTelemetry::ConnectTraces (void)
+{
+  NS_LOG_FUNCTION (this);
+  Config::ConnectFailSafe ("/NodeList/*/DeviceList/*/$ns3::MmWaveEnbNetDevice/E2ReportBuilt",
+                           MakeCallback (&SimulationTelemetry::NotifyE2Report, this));
+  Config::ConnectFailSafe ("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverEndOk",
+                           MakeCallback (&SimulationTelemetry::NotifyHandoverEndOk, this));
+  Config::ConnectFailSafe ("/NodeList/*/DeviceList/*/LteEnbRrc/NotifyMmWaveSinr",
+                           MakeCallback (&SimulationTelemetry::NotifySinr, this));
+}
+
+void
+SimulationTelemetry::Sample (void)
+{
+  WriteRow ();
+  m_sampleEvent = Simulator::Schedule (m_interval, &SimulationTelemetry::Sample, this);
+}
+
+void
+SimulationTelemetry::WriteRow (void)
+{
+  double wall =
+      std::chrono::duration<double> (std::chrono::steady_clock::now () - m_wallStart).count ();
+  double sim = Simulator::Now ().GetSeconds ();
+  uint64_t events = Simulator::GetEventCount ();
+
+  double dWall = wall - m_lastWall;
+  double eventsPerWallSecond = dWall > 0 ? (events - m_lastEvents) / dWall : 0;
+  double simPerWall = dWall > 0 ? (sim - m_lastSim) / dWall : 0;
+
+  m_file << sim << "," << wall << "," << events << "," << eventsPerWallSecond << "," << simPerWall
+         << ",";
+  if (m_countPendingEvents)
+    {
+      m_file << TelemetryMapScheduler::GetPendingEvents ();
+    }
+  m_file << "," << GetRssKiB () << "," << m_e2Reports << "," << m_handovers << ","
+         << m_sinrReadings << "\n";
+  m_file.flush ();
+
+  NS_LOG_INFO ("t=" << sim << " s, " << eventsPerWallSecond << " events/s, sim/wall "
+                    << simPerWall);
+
+  m_lastWall = wall;
+  m_lastSim = sim;
+  m_lastEvents = events;
+}
+
+uint64_t
+SimulationTelemetry::GetRssKiB (void)
+{
+  // second field of /proc/self/statm: resident pages
+  FILE *statm = std::fopen ("/proc/self/statm", "r");
+  if (statm == nullptr)
+    {
+      return 0;
+    }
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  int n = std::fscanf (statm, "%lu %lu", &size, &resident);
+  std::fclose (statm);
+  if (n != 2)
+    {
+      return 0;
+    }
+  return uint64_t (resident) * uint64_t (sysconf (_SC_PAGESIZE)) / 1024;
+}
+
+uint64_t
+SimulationTelemetry::GetE2Reports (void) const
+{
+  return m_e2Reports;
+}
+
+uint64_t
+SimulationTelemetry::GetHandovers (void) const
+{
+  return m_handovers;
+}
+
+uint64_t
+SimulationTelemetry::GetSinrReadings (void) const
+{
+  return m_sinrReadings;
+}
+
+void
+SimulationTelemetry::NotifyE2Report (std::string context, uint16_t cellId, uint8_t reportType)
+{
+  m_e2Reports++;
+}
+
+void
+SimulationTelemetry::NotifyHandoverEndOk (std::string context, uint64_t imsi, uint16_t cellId,
+                                          uint16_t rnti)
+{
+  m_handovers++;
+}
+
+void
+SimulationTelemetry::NotifySinr (std::string context, uint64_t imsi, uint16_t cellId,
+                                 long double sinr)
+{
+  m_sinrReadings++;
+}
+
+} // namespace mmwave
+
+} // namespace ns3
@@ -0,0 +1,145 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2025 WITLAB
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef SRC_MMWAVE_MODEL_SIMULATION_TELEMETRY_H_
+#define SRC_MMWAVE_MODEL_SIMULATION_TELEMETRY_H_
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/map-scheduler.h>
+#include <ns3/nstime.h>
+#include <ns3/event-id.h>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * MapScheduler (the ns-3 default) that also keeps the number of events in the
+ * queue, used by SimulationTelemetry for the pending events column. Cancelled
+ * events stay in the queue until they expire, as in MapScheduler.
+ *
+ * Installing it replaces the scheduler configured for the run, so it is only
+ * used when SimulationTelemetry::Start is asked to count the pending events.
+ */
+class TelemetryMapScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TelemetryMapScheduler ();
+  virtual ~TelemetryMapScheduler ();
+
+  virtual void Insert (const Event &ev) override;
+  virtual Event RemoveNext (void) override;
+  virtual void Remove (const Event &ev) override;
+
+  /**
+   * \return the events in the queue of the scheduler in use (0 if another
+   *         scheduler type is installed)
+   */
+  static uint64_t GetPendingEvents (void);
+
+private:
+  static uint64_t s_pendingEvents;
+};
+
+/**
+ * Periodic throughput/memory telemetry of a simulation run.
+ *
+ * Every interval one csv row is appended to the output file:
+ * simTime,wallTime,events,eventsPerWallSecond,simPerWall,pendingEvents,rssKiB,
+ * e2Reports,handovers,sinrReadings
+ * where the rates refer to the last interval and the counters are cumulative.
+ * pendingEvents is left empty unless Start is asked to count them.
+ * The counters are fed by the MmWaveEnbNetDevice E2ReportBuilt trace and the
+ * LteEnbRrc HandoverEndOk / NotifyMmWaveSinr traces (ConnectTraces).
+ */
+class SimulationTelemetry : public SimpleRefCount<SimulationTelemetry>
+{
+public:
+  /**
+   * \param fileName output csv file
+   * \param interval simulated time between two rows
+   */
+  SimulationTelemetry (std::string fileName, Time interval);
+
+  ~SimulationTelemetry ();
+
+  /**
+   * Schedule the first row
+   *
+   * \param countPendingEvents if true, install TelemetryMapScheduler (pending
+   *        events are moved to it) to fill the pendingEvents column. This
+   *        replaces the scheduler configured for the run, leave it false when
+   *        the run uses another scheduler than MapScheduler.
+   */
+  void Start (bool countPendingEvents = false);
+
+  /**
+   * Write a last row and close the file, to be called before Simulator::Destroy
+   */
+  void Stop (void);
+
+  /**
+   * Connect the report/HO/SINR counters to the traces of all the devices
+   * installed so far
+   */
+  void ConnectTraces (void);
+
+  /**
+   * \return the resident set size of the process in KiB, 0 if unknown
+   */
+  static uint64_t GetRssKiB (void);
+
+  uint64_t GetE2Reports (void) const;
+  uint64_t GetHandovers (void) const;
+  uint64_t GetSinrReadings (void) const;
+
+private:
+  void Sample (void);
+  void WriteRow (void);
+
+  void NotifyE2Report (std::string context, uint16_t cellId, uint8_t reportType);
+  void NotifyHandoverEndOk (std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti);
+  void NotifySinr (std::string context, uint64_t imsi, uint16_t cellId, long double sinr);
+
+  std::string m_fileName;
+  Time m_interval;
+  std::ofstream m_file;
+  EventId m_sampleEvent;
+  bool m_running;
+  bool m_countPendingEvents;  //!< TelemetryMapScheduler installed by Start
+
+  std::chrono::steady_clock::time_point m_wallStart;
+  double m_lastWall;          //!< wall time [s] of the previous row
+  double m_lastSim;           //!< simulated time [s] of the previous row
+  uint64_t m_lastEvents;      //!< executed events at the previous row
+
+  uint64_t m_e2Reports;
+  uint64_t m_handovers;
+  uint64_t m_sinrReadings;
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_MODEL_SIMULATION_TELEMETRY_H_ */
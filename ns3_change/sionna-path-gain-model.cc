@@ -0,0 +1,351 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2025 WITLAB
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "sionna-path-gain-model.h"
+#include <ns3/log.h>
+#include <ns3/fatal-error.h>
+#include <ns3/string.h>
+#include <ns3/mobility-model.h>
+#include <ns3/boolean.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SionnaPathGainModel");
+
+namespace mmwave {
+
+Ptr<SionnaPathGainMap>
+SionnaPathGainMap::Open (std::string fileName)
+{
+  static std::map<std::string, Ptr<SionnaPathGainMap>> maps;
+  auto it = maps.find (fileName);
+  if (it != maps.end ())
+    {
+      return it->second;
+    }
+  Ptr<SionnaPathGainMap> map = Ptr<SionnaPathGainMap> (new SionnaPathGainMap (fileName), false);
+  maps[fileName] = map;
+  return map;
+}
+
+SionnaPathGainMap::SionnaPathGainMap (std::string fileName)
+    : m_fileName (fileName),
+      m_data (nullptr),
+      m_size (0)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  int fd = open (fileName.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_FATAL_ERROR ("Can't open file " << fileName);
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || size_t (st.st_size) < sizeof (Header))
+    {
+      close (fd);
+      NS_FATAL_ERROR ("Path gain map " << fileName << " is too short");
+    }
+  m_size = st.st_size;
+  m_data = mmap (nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (m_data == MAP_FAILED)
+    {
+      NS_FATAL_ERROR ("Can't map file " << fileName);
+    }
+
+  const uint8_t *base = static_cast<const uint8_t *> (m_data);
+  m_header = reinterpret_cast<const Header *> (base);
+  if (std::memcmp (m_header->magic, "SPGM", 4) != 0 || m_header->version != 1)
+    {
+      NS_FATAL_ERROR ("Path gain map " << fileName << " has an unknown format");
+    }
+
+  size_t points = size_t (m_header->nx) * m_header->ny;
+  size_t sitesOffset = sizeof (Header);
+  size_t gainOffset = sitesOffset + m_header->numSites * sizeof (Site);
+  size_t losOffset = gainOffset + m_header->numSites * points * sizeof (float);
+  if (m_header->nx == 0 || m_header->ny == 0 || m_header->step <= 0 ||
+      losOffset + m_header->numSites * points > m_size)
+    {
+      NS_FATAL_ERROR ("Path gain map " << fileName << " is truncated");
+    }
+  m_sites = reinterpret_cast<const Site *> (base + sitesOffset);
+  m_gain = reinterpret_cast<const float *> (base + gainOffset);
+  m_los = base + losOffset;
+
+  NS_LOG_INFO ("Mapped " << fileName << ": " << m_header->numSites << " sites, "
+                         << m_header->nx << "x" << m_header->ny << " points, step "
+                         << m_header->step << " m");
+}
+
+SionnaPathGainMap::~SionnaPathGainMap ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data != nullptr && m_data != MAP_FAILED)
+    {
+      munmap (m_data, m_size);
+    }
+}
+
+int32_t
+SionnaPathGainMap::FindSite (const Vector &position) const
+{
+  for (uint32_t s = 0; s < m_header->numSites; s++)
+    {
+      double dx = position.x - m_sites[s].x;
+      double dy = position.y - m_sites[s].y;
+      double dz = position.z - m_sites[s].z;
+      if (dx * dx + dy * dy + dz * dz < 1.0)
+        {
+          return s;
+        }
+    }
+  return -1;
+}
+
+void
+SionnaPathGainMap::CheckSites (const NodeContainer &enbNodes) const
+{
+  for (uint32_t i = 0; i < enbNodes.GetN (); i++)
+    {
+      Vector position = enbNodes.Get (i)->GetObject<MobilityModel> ()->GetPosition ();
+      if (FindSite (position) < 0)
+        {
+          NS_FATAL_ERROR ("No site of " << m_fileName << " at " << position
+                                        << ": the grid was exported for another layout");
+        }
+    }
+}
+
+double
+SionnaPathGainMap::GetPathGainDb (uint32_t site, double x, double y) const
+{
+  uint32_t nx = m_header->nx;
+  uint32_t ny = m_header->ny;
+  double fx = std::min (std::max ((x - m_header->x0) / m_header->step, 0.0), double (nx - 1));
+  double fy = std::min (std::max ((y - m_header->y0) / m_header->step, 0.0), double (ny - 1));
+  uint32_t i0 = uint32_t (fx);
+  uint32_t j0 = uint32_t (fy);
+  uint32_t i1 = std::min (i0 + 1, nx - 1);
+  uint32_t j1 = std::min (j0 + 1, ny - 1);
+  double wx = fx - i0;
+  double wy = fy - j0;
+
+  const float *grid = m_gain + size_t (site) * nx * ny;
+  double g0 = (1 - wx) * grid[size_t (j0) * nx + i0] + wx * grid[size_t (j0) * nx + i1];
+  double g1 = (1 - wx) * grid[size_t (j1) * nx + i0] + wx * grid[size_t (j1) * nx + i1];
+  return (1 - wy) * g0 + wy * g1;
+}
+
+bool
+SionnaPathGainMap::IsLos (uint32_t site, double x, double y) const
+{
+  uint32_t nx = m_header->nx;
+  uint32_t ny = m_header->ny;
+  double fx = std::round ((x - m_header->x0) / m_header->step);
+  double fy = std::round ((y - m_header->y0) / m_header->step);
+  uint32_t i = uint32_t (std::min (std::max (fx, 0.0), double (nx - 1)));
+  uint32_t j = uint32_t (std::min (std::max (fy, 0.0), double (ny - 1)));
+  return m_los[size_t (site) * nx * ny + size_t (j) * nx + i] != 0;
+}
+
+uint32_t
+SionnaPathGainMap::GetNSites (void) const
+{
+  return m_header->numSites;
+}
+
+uint16_t
+SionnaPathGainMap::GetCellId (uint32_t site) const
+{
+  return m_sites[site].cellId;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (SionnaPropagationLossModel);
+
+TypeId
+SionnaPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid =
+      TypeId ("ns3::SionnaPropagationLossModel")
+          .SetParent<ThreeGppUmiStreetCanyonPropagationLossModel> ()
+          .SetGroupName ("mmwave")
+          .AddConstructor<SionnaPropagationLossModel> ()
+          .AddAttribute ("MapFile", "Path gain grid exported by sionna-rt/export_path_gain.py",
+                         StringValue (""),
+                         MakeStringAccessor (&SionnaPropagationLossModel::SetMapFile,
+                                             &SionnaPropagationLossModel::GetMapFile),
+                         MakeStringChecker ());
+  return tid;
+}
+
+SionnaPropagationLossModel::SionnaPropagationLossModel () : m_fallbackConfigured (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_fallback = CreateObject<ThreeGppUmiStreetCanyonPropagationLossModel> ();
+}
+
+SionnaPropagationLossModel::~SionnaPropagationLossModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SionnaPropagationLossModel::SetMapFile (std::string fileName)
+{
+  m_mapFile = fileName;
+  m_map = fileName.empty () ? nullptr : SionnaPathGainMap::Open (fileName);
+}
+
+std::string
+SionnaPropagationLossModel::GetMapFile (void) const
+{
+  return m_mapFile;
+}
+
+Ptr<SionnaPathGainMap>
+SionnaPropagationLossModel::GetMap (void) const
+{
+  return m_map;
+}
+
+double
+SionnaPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a,
+                                           Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_map, "SionnaPropagationLossModel: MapFile not set");
+  Vector posA = a->GetPosition ();
+  Vector posB = b->GetPosition ();
+
+  // reciprocal: the grid of whichever end is a site
+  int32_t site = m_map->FindSite (posA);
+  Vector other = posB;
+  if (site < 0)
+    {
+      site = m_map->FindSite (posB);
+      other = posA;
+    }
+  if (site < 0)
+    {
+      // not in the grid (UE-UE): same frequency, condition model and shadowing setting
+      if (!m_fallbackConfigured)
+        {
+          BooleanValue shadowing;
+          GetAttribute ("ShadowingEnabled", shadowing);
+          m_fallback->SetAttribute ("ShadowingEnabled", shadowing);
+          m_fallback->SetFrequency (GetFrequency ());
+          m_fallback->SetChannelConditionModel (GetChannelConditionModel ());
+          m_fallbackConfigured = true;
+        }
+      NS_LOG_LOGIC ("no site at " << posA << " or " << posB << ", 3GPP UMi");
+      return m_fallback->CalcRxPower (txPowerDbm, a, b);
+    }
+
+  double gainDb = m_map->GetPathGainDb (site, other.x, other.y);
+  NS_LOG_LOGIC ("site " << site << " to " << other << ": " << gainDb << " dB");
+  return txPowerDbm + gainDb;
+}
+
+int64_t
+SionnaPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  // the grid lookup is deterministic, only the fallback draws random numbers
+  return m_fallback->AssignStreams (stream);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (SionnaChannelConditionModel);
+
+TypeId
+SionnaChannelConditionModel::GetTypeId (void)
+{
+  static TypeId tid =
+      TypeId ("ns3::SionnaChannelConditionModel")
+          .SetParent<ChannelConditionModel> ()
+          .SetGroupName ("mmwave")
+          .AddConstructor<SionnaChannelConditionModel> ()
+          .AddAttribute ("MapFile", "Path gain grid exported by sionna-rt/export_path_gain.py",
+                         StringValue (""),
+                         MakeStringAccessor (&SionnaChannelConditionModel::SetMapFile,
+                                             &SionnaChannelConditionModel::GetMapFile),
+                         MakeStringChecker ());
+  return tid;
+}
+
+SionnaChannelConditionModel::SionnaChannelConditionModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SionnaChannelConditionModel::~SionnaChannelConditionModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SionnaChannelConditionModel::SetMapFile (std::string fileName)
+{
+  m_mapFile = fileName;
+  m_map = fileName.empty () ? nullptr : SionnaPathGainMap::Open (fileName);
+}
+
+std::string
+SionnaChannelConditionModel::GetMapFile (void) const
+{
+  return m_mapFile;
+}
+
+Ptr<ChannelCondition>
+SionnaChannelConditionModel::GetChannelCondition (Ptr<const MobilityModel> a,
+                                                  Ptr<const MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_map, "SionnaChannelConditionModel: MapFile not set");
+  Vector posA = a->GetPosition ();
+  Vector posB = b->GetPosition ();
+
+  int32_t site = m_map->FindSite (posA);
+  Vector other = posB;
+  if (site < 0)
+    {
+      site = m_map->FindSite (posB);
+      other = posA;
+    }
+
+  Ptr<ChannelCondition> condition = CreateObject<ChannelCondition> ();
+  // links without a site end (UE-UE) are not in the grid
+  bool los = site >= 0 && m_map->IsLos (site, other.x, other.y);
+  condition->SetLosCondition (los ? ChannelCondition::LOS : ChannelCondition::NLOS);
+  return condition;
+}
+
+int64_t
+SionnaChannelConditionModel::AssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+} // namespace mmwave
+
+} // namespace ns3
@@ -0,0 +1,197 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2025 WITLAB
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef SRC_MMWAVE_MODEL_SIONNA_PATH_GAIN_MODEL_H_
+#define SRC_MMWAVE_MODEL_SIONNA_PATH_GAIN_MODEL_H_
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/three-gpp-propagation-loss-model.h>
+#include <ns3/channel-condition-model.h>
+#include <ns3/node-container.h>
+#include <ns3/vector.h>
+#include <string>
+
+namespace ns3 {
+
+class MobilityModel;
+
+namespace mmwave {
+
+/**
+ * Read-only, memory-mapped path-gain grid exported from Sionna RT
+ * (sionna-rt/export_path_gain.py).
+ *
+ * File layout (little endian):
+ * - header: "SPGM", uint32 version, numSites, nx, ny, reserved,
+ *   double x0, y0, step (centre of cell (0,0) and grid spacing, ns-3 coordinates)
+ * - numSites x {double x, y, z; uint32 cellId, reserved}: transmitter positions
+ * - float32 pathGainDb[numSites][ny][nx]
+ * - uint8 los[numSites][ny][nx]
+ *
+ * The file is mapped with MAP_SHARED, so parallel runs on the same grid share
+ * the page cache instead of loading one copy each. Open () returns the same
+ * object for the same file within a process.
+ */
+class SionnaPathGainMap : public SimpleRefCount<SionnaPathGainMap>
+{
+public:
+  /**
+   * \param fileName grid file
+   * \return the mapping of the file, created on the first call
+   */
+  static Ptr<SionnaPathGainMap> Open (std::string fileName);
+
+  ~SionnaPathGainMap ();
+
+  /**
+   * \param position position of a node
+   * \return index of the site at that position (1 m tolerance), -1 if none
+   */
+  int32_t FindSite (const Vector &position) const;
+
+  /**
+   * Abort if one of the nodes is not at a site, i.e. the grid was exported
+   * for another layout. Called once after the gNBs are placed.
+   *
+   * \param enbNodes the gNB nodes, with their mobility model installed
+   */
+  void CheckSites (const NodeContainer &enbNodes) const;
+
+  /**
+   * \return path gain [dB] from the site to (x, y), bilinear between the four
+   *         surrounding grid points, clamped to the edge of the grid
+   */
+  double GetPathGainDb (uint32_t site, double x, double y) const;
+
+  /**
+   * \return the LOS flag of the grid point nearest to (x, y)
+   */
+  bool IsLos (uint32_t site, double x, double y) const;
+
+  uint32_t GetNSites (void) const;
+  uint16_t GetCellId (uint32_t site) const;
+
+private:
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t numSites;
+    uint32_t nx;
+    uint32_t ny;
+    uint32_t reserved;
+    double x0;
+    double y0;
+    double step;
+  };
+
+  struct Site
+  {
+    double x;
+    double y;
+    double z;
+    uint32_t cellId;
+    uint32_t reserved;
+  };
+
+  explicit SionnaPathGainMap (std::string fileName);
+
+  std::string m_fileName;
+  void *m_data;
+  size_t m_size;
+  const Header *m_header;
+  const Site *m_sites;
+  const float *m_gain;
+  const uint8_t *m_los;
+};
+
+/**
+ * Propagation loss from a Sionna path-gain grid. When one end of the link is
+ * at one of the sites of the grid, the other end is looked up in the grid of
+ * that site (the same value is used in both directions). Links without a site
+ * end (e.g. UE-UE) are not in the grid and use the 3GPP UMi model.
+ *
+ * It derives from ThreeGppUmiStreetCanyonPropagationLossModel so that
+ * MmWaveHelper configures it, and the 3GPP fast fading on top of it, as the
+ * stochastic UMi model it replaces: only the pathloss and shadowing are
+ * replaced by the lookup.
+ */
+class SionnaPropagationLossModel : public ThreeGppUmiStreetCanyonPropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  SionnaPropagationLossModel ();
+  virtual ~SionnaPropagationLossModel ();
+
+  /**
+   * \param fileName grid file, see SionnaPathGainMap
+   */
+  void SetMapFile (std::string fileName);
+
+  /**
+   * \return the grid in use (0 before SetMapFile)
+   */
+  Ptr<SionnaPathGainMap> GetMap (void) const;
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const override;
+
+  virtual int64_t DoAssignStreams (int64_t stream) override;
+
+  std::string GetMapFile (void) const;
+
+  std::string m_mapFile;
+  Ptr<SionnaPathGainMap> m_map;
+  /// 3GPP UMi model for the links without a site end, configured on first use
+  Ptr<ThreeGppUmiStreetCanyonPropagationLossModel> m_fallback;
+  mutable bool m_fallbackConfigured;
+};
+
+/**
+ * Channel condition (LOS/NLOS) from the LOS flag of a Sionna path-gain grid,
+ * consistent with SionnaPropagationLossModel on the same file.
+ */
+class SionnaChannelConditionModel : public ChannelConditionModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  SionnaChannelConditionModel ();
+  virtual ~SionnaChannelConditionModel ();
+
+  void SetMapFile (std::string fileName);
+
+  virtual Ptr<ChannelCondition> GetChannelCondition (Ptr<const MobilityModel> a,
+                                                     Ptr<const MobilityModel> b) const override;
+
+  virtual int64_t AssignStreams (int64_t stream) override;
+
+private:
+  std::string GetMapFile (void) const;
+
+  std::string m_mapFile;
+  Ptr<SionnaPathGainMap> m_map;
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_MODEL_SIONNA_PATH_GAIN_MODEL_H_ */
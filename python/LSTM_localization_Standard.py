@@ -317,10 +317,10 @@ class LSTMLocalizer:
         
         while self.running:
             try:
-                line = data_queue.get(timeout=0.1)
-                measurement = DataParser.parse_sinr_line(line)
+                item = data_queue.get(timeout=0.1)
                 
-                if measurement:  # 모든 UE 처리
+                # binary frame (indication 하나) 또는 text 한 줄, 모든 UE 처리
+                for measurement in DataParser.parse_queue_item(item):
                     self.stats['processed'] += 1
                     
                     # 모든 UE에 대해 LSTM 위치 추정
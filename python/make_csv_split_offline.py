@@ -18,6 +18,13 @@ cell_ids = [2,3,4,5,6,7,8]
 # 결과를 누적할 리스트
 all_results = []
 
+def trace_path(base_dir, name):
+    """시뮬레이터가 compressTraces=true 로 돌았으면 <name>.gz 를 사용 (pandas가 gzip 자동 해제)"""
+    fp = base_dir / name
+    if not fp.exists() and (base_dir / f"{name}.gz").exists():
+        return base_dir / f"{name}.gz"
+    return fp
+
 def select_top_neighbors_vectorized(df, n_neighbors=3):
     """벡터화된 방식으로 상위 N개 neighbor 선택 (시간 순서 유지)"""
     
@@ -85,7 +92,7 @@ for base_dir in scenario_dirs:
     dfs = []
     t0_cucp = None
     for cid in cell_ids:
-        fp = base_dir / f"cu-cp-cell-{cid}.txt"
+        fp = trace_path(base_dir, f"cu-cp-cell-{cid}.txt")
         tmp = pd.read_csv(fp)
         dfs.append(tmp)
         mt = tmp["timestamp"].min()
@@ -107,7 +114,7 @@ for base_dir in scenario_dirs:
 
 
     # 3) ue_position.txt 처리
-    trace = pd.read_csv(base_dir / "ue_position.txt")
+    trace = pd.read_csv(trace_path(base_dir, "ue_position.txt"))
     trace = trace[["timestamp", "id", "x", "y"]]
     trace.rename(columns={"id": "UE (imsi)"}, inplace=True)
     
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+시뮬레이터가 직접 쓰는 ML 시퀀스 (--mlSequenceFile=ml_sequences.bin) 로더
+
+make_csv_split_offline.py 의 오프라인 병합 (cu-cp 7개 concat + top-3 neighbour + ue_position merge
++ 5초 이동평균) 을 ns-3 안에서 indication 주기마다 수행한 결과.
+UE 별로 float32 [numSteps, numFeatures] 배열이며 컬럼은
+    t, serving_x, serving_y, serving_sinr, neigh_sinr_1..K, UE_x, UE_y
+(SINR 은 3gpp 변환값의 이동평균 = 오프라인 csv 의 *_ma 컬럼)
+
+    from ml_sequences import load_ml_sequences
+    meta, seqs = load_ml_sequences("ml_sequences.bin")
+    X = seqs[imsi][:, 1:-2]; y = seqs[imsi][:, -2:]
+
+    python3 ml_sequences.py ml_sequences.bin --csv scenario.csv   # 오프라인 csv 형식으로 변환 (비교용)
+"""
+
+import argparse
+import struct
+import numpy as np
+import pandas as pd
+
+MAGIC = b"MLSQ"
+HEADER_FMT = "<4sIIIIId"
+
+def feature_names(top_k):
+    return (["t", "serving_x", "serving_y", "serving_sinr"]
+            + [f"neigh_sinr_{k}" for k in range(1, top_k + 1)] + ["UE_x", "UE_y"])
+
+def load_ml_sequences(path):
+    """(meta, {imsi: float32 [numSteps, numFeatures]}) 반환, 배열은 파일을 복사 없이 memmap"""
+    header_size = struct.calcsize(HEADER_FMT)
+    with open(path, "rb") as f:
+        magic, version, num_ues, num_features, top_k, _, period = struct.unpack(
+            HEADER_FMT, f.read(header_size))
+    if magic != MAGIC or version != 1:
+        raise ValueError(f"{path}: not an ML sequence file")
+
+    index = np.fromfile(path, dtype="<u8", count=2 * num_ues, offset=header_size).reshape(num_ues, 2)
+    offset = header_size + index.nbytes
+    total = int(index[:, 1].sum())
+    data = np.memmap(path, dtype="<f4", mode="r", offset=offset, shape=(total, num_features))
+
+    seqs = {}
+    start = 0
+    for imsi, steps in index:
+        seqs[int(imsi)] = data[start:start + int(steps)]
+        start += int(steps)
+
+    meta = {"period": period, "top_k": top_k, "features": feature_names(top_k)}
+    return meta, seqs
+
+def to_dataframe(meta, seqs):
+    """make_csv_split_offline.py 출력과 같은 컬럼 (top-3 기준)"""
+    frames = []
+    for imsi, arr in seqs.items():
+        df = pd.DataFrame(np.asarray(arr), columns=meta["features"])
+        df.insert(1, "imsi", imsi)
+        frames.append(df)
+    df = pd.concat(frames, ignore_index=True)
+    df["relative_timestamp"] = np.round(df.pop("t") / meta["period"]).astype(np.int64)
+    df = df.rename(columns={"serving_sinr": "L3 serving SINR 3gpp_ma"})
+    df = df.rename(columns={f"neigh_sinr_{k}": f"L3 neigh SINR 3gpp {k} (convertedSinr)_ma"
+                            for k in range(1, meta["top_k"] + 1)})
+    cols = ["relative_timestamp"] + [c for c in df.columns if c != "relative_timestamp"]
+    return df[cols].round(3)
+
+def main():
+    parser = argparse.ArgumentParser(description="Inspect / convert an ML sequence file")
+    parser.add_argument("path")
+    parser.add_argument("--csv", help="write the rows in the make_csv_split_offline.py format")
+    args = parser.parse_args()
+
+    meta, seqs = load_ml_sequences(args.path)
+    lengths = np.array([len(a) for a in seqs.values()])
+    print(f"📊 {len(seqs)} UEs, {lengths.sum()} steps (min {lengths.min()}, max {lengths.max()}), "
+          f"{len(meta['features'])} features every {meta['period']} s")
+    if args.csv:
+        to_dataframe(meta, seqs).to_csv(args.csv, index=False)
+        print(f"✅ Saved: {args.csv}")
+
+if __name__ == "__main__":
+    main()
@@ -12,6 +12,7 @@ DNN, RNN, LSTM, 사변측량 모든 방법이 공통으로 사용하는 핵심 
 """
 
 import socket
+import struct
 import threading
 import queue
 import time
@@ -28,9 +29,25 @@ from dataclasses import dataclass
 
 # 설정 상수
 SOCKET_PATH = "/tmp/sinr_localization.sock"
-BUFFER_SIZE = 4096
+BUFFER_SIZE = 65536
 MAX_QUEUE_SIZE = 1000
 
+# 🔥 xApp binary frame (ue_localization_3gpp.c 의 sinr_frame_header_t / sinr_frame_record_t)
+#   header: "SINF", uint16 version, uint16 record_size, uint32 count, uint32 reserved, uint64 epoch
+#   record: 아래 SINR_RECORD_DTYPE, lstm_input_data.csv 한 줄과 같은 값
+SINR_FRAME_MAGIC = b"SINF"
+SINR_FRAME_VERSION = 1
+SINR_FRAME_HEADER = struct.Struct("<4sHHIIQ")
+SINR_RECORD_DTYPE = np.dtype([
+    ("timestamp", "<u8"),          # relative_timestamp
+    ("ue_id", "<u4"),              # imsi
+    ("serving_cell_x", "<i4"),     # serving_x
+    ("serving_cell_y", "<i4"),     # serving_y
+    ("serving_cell_sinr", "<f4"),  # L3 serving SINR 3gpp_ma
+    ("neighbor_sinr", "<f4", (3,)),  # L3 neigh SINR 3gpp 1~3_ma
+    ("reserved", "<u4"),
+])
+
 @dataclass
 class SINRMeasurement:
     """🔥 C xApp 8개 컬럼 출력에 맞춘 데이터 클래스"""
@@ -79,39 +96,70 @@ class SocketReceiver:
                     logging.error("Socket accept error")
                 break
                 
+    def _enqueue(self, item, count=1):
+        """Queue 오버플로우 시 오래된 데이터 제거"""
+        try:
+            self.data_queue.put_nowait(item)
+            self.stats['received'] += count
+        except queue.Full:
+            try:
+                self.data_queue.get_nowait()
+                self.data_queue.put_nowait(item)
+                self.stats['dropped'] += count
+            except queue.Empty:
+                pass
+
     def _handle_connection(self, conn):
-        """클라이언트 연결 처리"""
-        buffer = ""
-        
+        """클라이언트 연결 처리 (binary frame / 기존 text 줄 자동 구분)"""
         try:
-            while self.running:
-                data = conn.recv(BUFFER_SIZE).decode('utf-8')
-                if not data:
-                    break
-                    
-                buffer += data
-                lines = buffer.split('\n')
-                buffer = lines[-1]  # 마지막 불완전한 라인 보관
-                
-                for line in lines[:-1]:
-                    if line.strip():
-                        try:
-                            self.data_queue.put_nowait(line.strip())
-                            self.stats['received'] += 1
-                        except queue.Full:
-                            # Queue 오버플로우 시 오래된 데이터 제거
-                            try:
-                                self.data_queue.get_nowait()
-                                self.data_queue.put_nowait(line.strip())
-                                self.stats['dropped'] += 1
-                            except queue.Empty:
-                                pass
-                                
+            first = conn.recv(BUFFER_SIZE)
+            if first and SINR_FRAME_MAGIC.startswith(first[:len(SINR_FRAME_MAGIC)]):
+                self._handle_frames(conn, bytearray(first))
+            elif first:
+                self._handle_lines(conn, first.decode('utf-8'))
         except Exception as e:
             logging.error(f"Connection error: {e}")
         finally:
             conn.close()
             print("🔌 xApp disconnected")
+
+    def _handle_frames(self, conn, buffer: bytearray):
+        """🔥 frame 하나 = indication 하나 → numpy structured array 로 queue 에"""
+        header_size = SINR_FRAME_HEADER.size
+        while self.running:
+            while len(buffer) >= header_size:
+                magic, version, record_size, count, _, epoch = SINR_FRAME_HEADER.unpack_from(buffer)
+                if (magic != SINR_FRAME_MAGIC or version != SINR_FRAME_VERSION
+                        or record_size != SINR_RECORD_DTYPE.itemsize):
+                    raise ValueError(f"bad frame header: {magic!r} v{version} record {record_size}")
+                frame_size = header_size + count * record_size
+                if len(buffer) < frame_size:
+                    break
+                frame = np.frombuffer(buffer, dtype=SINR_RECORD_DTYPE, count=count,
+                                      offset=header_size).copy()
+                del buffer[:frame_size]
+                self.stats['frames'] += 1
+                self._enqueue(frame, count)
+
+            data = conn.recv(BUFFER_SIZE)
+            if not data:
+                break
+            buffer += data
+
+    def _handle_lines(self, conn, buffer: str):
+        """기존 text 프로토콜 (한 줄 = UE 하나)"""
+        while self.running:
+            lines = buffer.split('\n')
+            buffer = lines[-1]  # 마지막 불완전한 라인 보관
+
+            for line in lines[:-1]:
+                if line.strip():
+                    self._enqueue(line.strip())
+
+            data = conn.recv(BUFFER_SIZE).decode('utf-8')
+            if not data:
+                break
+            buffer += data
             
     def stop(self):
         """소켓 서버 중지"""
@@ -148,6 +196,38 @@ class DataParser:
             logging.error(f"Parse error: {e} for line: {line}")
             return None
     
+    @staticmethod
+    def frame_to_measurements(frame: np.ndarray, ue_id: Optional[int] = None) -> List[SINRMeasurement]:
+        """🔥 binary frame (SINR_RECORD_DTYPE 배열) → SINRMeasurement 목록, ue_id 로 먼저 거름"""
+        if ue_id is not None:
+            frame = frame[frame['ue_id'] == ue_id]
+        # 컬럼 단위로 한 번에 python 값으로 변환 (float32 → 소수점 1자리 그대로)
+        neighbors = np.round(frame['neighbor_sinr'].astype(np.float64), 1).tolist()
+        return [
+            SINRMeasurement(
+                timestamp=t, ue_id=u, serving_cell_x=x, serving_cell_y=y, serving_cell_sinr=sinr,
+                neighbor1_sinr=n[0], neighbor2_sinr=n[1], neighbor3_sinr=n[2],
+            )
+            for t, u, x, y, sinr, n in zip(
+                frame['timestamp'].tolist(),
+                frame['ue_id'].tolist(),
+                frame['serving_cell_x'].tolist(),
+                frame['serving_cell_y'].tolist(),
+                np.round(frame['serving_cell_sinr'].astype(np.float64), 1).tolist(),
+                neighbors,
+            )
+        ]
+
+    @staticmethod
+    def parse_queue_item(item, ue_id: Optional[int] = None) -> List[SINRMeasurement]:
+        """SocketReceiver queue 항목 (text 줄 또는 binary frame) → SINRMeasurement 목록"""
+        if isinstance(item, np.ndarray):
+            return DataParser.frame_to_measurements(item, ue_id)
+        measurement = DataParser.parse_sinr_line(item)
+        if measurement is None or (ue_id is not None and measurement.ue_id != ue_id):
+            return []
+        return [measurement]
+
     @staticmethod
     def measurements_to_dataframe(measurements: List[SINRMeasurement]) -> pd.DataFrame:
         """🔥 수정된 DataFrame 변환"""
@@ -250,10 +330,9 @@ class RealtimeLocalizer:
         
         while self.running:
             try:
-                line = data_queue.get(timeout=0.1)
-                measurement = DataParser.parse_sinr_line(line)
+                item = data_queue.get(timeout=0.1)
                 
-                if measurement and measurement.ue_id == self.ue_id:
+                for measurement in DataParser.parse_queue_item(item, self.ue_id):
                     self.stats['processed'] += 1
                     
                     # 서브클래스에서 구현할 위치 추정 로직
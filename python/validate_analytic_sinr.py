@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""
+executionMode=analytic 결과를 full-stack 결과와 비교 (같은 mobRun 의 cu-cp-cell-*.txt)
+
+    python3 validate_analytic_sinr.py --full data_full_mobrun_1 --analytic data_analytic_mobrun_1
+
+두 런은 같은 mobRun 이면 UE 궤적이 같으므로 (상대 시간, imsi) 로 행을 맞춘 뒤
+- serving cell 일치율
+- serving / 셀별 SINR 오차 (analytic - full) 분포
+- serving SINR 분포 차이 (KS 거리)
+를 출력한다.
+
+analytic 런으로 학습 데이터를 만들기 전에 이 검증을 통과해야 한다 (fixed_data_gen.sh 가
+EXECUTION_MODE=analytic 일 때 --report 로 쓴 PASS 리포트를 요구). 기준:
+serving cell 일치율 >= --min-agreement, |serving SINR 평균 오차| <= --max-bias,
+KS 거리 <= --max-ks. 실패하면 exit code 1.
+"""
+
+import argparse
+from pathlib import Path
+import numpy as np
+import pandas as pd
+
+NUM_NEIGH = 8
+
+def trace_files(base_dir):
+    """compressTraces=true 로 돈 런은 .gz 사용 (pandas가 gzip 자동 해제)"""
+    files = sorted(base_dir.glob("cu-cp-cell-*.txt"))
+    if not files:
+        files = sorted(base_dir.glob("cu-cp-cell-*.txt.gz"))
+    return files
+
+def load_cucp(base_dir, period_ms):
+    files = trace_files(base_dir)
+    if not files:
+        raise SystemExit(f"❌ No cu-cp-cell-*.txt in {base_dir}")
+    df = pd.concat([pd.read_csv(fp) for fp in files], ignore_index=True)
+    df = df.rename(columns={
+        "UE (imsi)": "imsi",
+        "L3 serving Id(m_cellId)": "serving",
+        "L3 serving SINR": "serving_sinr",
+    })
+    # 절대 timestamp 는 런마다 다르므로 첫 보고 기준 상대 시간 (보고 주기 단위)
+    t0 = df["timestamp"].min()
+    df["t"] = ((df["timestamp"] - t0) / period_ms).round().astype(np.int64)
+    return df
+
+def per_cell_sinr(df):
+    """neighbour 컬럼을 (t, imsi, cell, sinr) 로 펼침 (serving 은 음수 ID 로 들어있음)"""
+    parts = []
+    for i in range(1, NUM_NEIGH + 1):
+        id_col = f"L3 neigh Id {i} (cellId)"
+        sinr_col = f"L3 neigh SINR {i}"
+        if id_col not in df.columns:
+            continue
+        part = df[["t", "imsi", id_col, sinr_col]].dropna()
+        part.columns = ["t", "imsi", "cell", "sinr"]
+        parts.append(part)
+    cells = pd.concat(parts, ignore_index=True)
+    cells["cell"] = cells["cell"].abs().astype(np.int64)
+    return cells.drop_duplicates(["t", "imsi", "cell"])
+
+def ks_distance(a, b):
+    a = np.sort(a)
+    b = np.sort(b)
+    grid = np.concatenate([a, b])
+    cdf_a = np.searchsorted(a, grid, side="right") / len(a)
+    cdf_b = np.searchsorted(b, grid, side="right") / len(b)
+    return np.max(np.abs(cdf_a - cdf_b))
+
+def describe(name, err):
+    if len(err) == 0:
+        print(f"{name}: n=0")
+        return float("nan")
+    p5, p50, p95 = np.percentile(err, [5, 50, 95])
+    print(f"{name}: n={len(err)} mean={err.mean():.2f} dB std={err.std():.2f} dB "
+          f"p5={p5:.2f} p50={p50:.2f} p95={p95:.2f} |err|<3dB={np.mean(np.abs(err) < 3) * 100:.1f}%")
+    return err.mean()
+
+def main():
+    parser = argparse.ArgumentParser(description="Analytic vs full-stack L3 SINR validation")
+    parser.add_argument("--full", type=Path, required=True, help="full-stack run directory")
+    parser.add_argument("--analytic", type=Path, required=True, help="analytic run directory")
+    parser.add_argument("--period", type=float, default=100, help="indication period [ms]")
+    parser.add_argument("--min-agreement", type=float, default=80.0,
+                        help="minimum serving cell agreement [%%]")
+    parser.add_argument("--max-bias", type=float, default=2.0,
+                        help="maximum |mean serving SINR error| on the same serving cell [dB]")
+    parser.add_argument("--max-ks", type=float, default=0.1,
+                        help="maximum KS distance of the serving SINR distributions")
+    parser.add_argument("--report", type=Path, help="write the summary and PASS/FAIL to this file")
+    args = parser.parse_args()
+
+    full = load_cucp(args.full, args.period)
+    analytic = load_cucp(args.analytic, args.period)
+
+    merged = full[["t", "imsi", "serving", "serving_sinr"]].merge(
+        analytic[["t", "imsi", "serving", "serving_sinr"]],
+        on=["t", "imsi"], suffixes=("_full", "_analytic"))
+    if merged.empty:
+        raise SystemExit("❌ No common (t, imsi) samples, check --period and the mobRun of the runs")
+
+    print(f"📊 samples full={len(full)} analytic={len(analytic)} matched={len(merged)}")
+    agree = np.mean(merged["serving_full"] == merged["serving_analytic"]) * 100
+    print(f"Serving cell agreement: {agree:.1f}%")
+
+    same_cell = merged[merged["serving_full"] == merged["serving_analytic"]]
+    bias = describe("Serving SINR error (same serving cell)",
+                    (same_cell["serving_sinr_analytic"] - same_cell["serving_sinr_full"]).to_numpy())
+
+    cells = per_cell_sinr(full).merge(per_cell_sinr(analytic), on=["t", "imsi", "cell"],
+                                      suffixes=("_full", "_analytic"))
+    describe("Per-cell SINR error", (cells["sinr_analytic"] - cells["sinr_full"]).to_numpy())
+
+    ks = ks_distance(full["serving_sinr"].to_numpy(), analytic["serving_sinr"].to_numpy())
+    print(f"Serving SINR distribution KS distance: {ks:.3f}")
+    for q in [5, 25, 50, 75, 95]:
+        print(f"  p{q}: full={np.percentile(full['serving_sinr'], q):7.2f} dB "
+              f"analytic={np.percentile(analytic['serving_sinr'], q):7.2f} dB")
+
+    # NaN bias (서로 다른 serving cell 만 있음) 도 실패
+    passed = (agree >= args.min_agreement and abs(bias) <= args.max_bias and ks <= args.max_ks)
+    verdict = "PASS" if passed else "FAIL"
+    print(f"{'✅' if passed else '❌'} {verdict} (agreement >= {args.min_agreement}%, "
+          f"|bias| <= {args.max_bias} dB, KS <= {args.max_ks})")
+    if args.report is not None:
+        with open(args.report, "w") as f:
+            f.write(f"full={args.full}\nanalytic={args.analytic}\nmatched={len(merged)}\n"
+                    f"agreement={agree:.1f}\nbias={bias:.2f}\nks={ks:.3f}\nresult={verdict}\n")
+    raise SystemExit(0 if passed else 1)
+
+if __name__ == "__main__":
+    main()
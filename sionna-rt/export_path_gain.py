@@ -0,0 +1,145 @@
+# 사용법:
+#   python3 export_path_gain.py --scene km2_itu.xml --cell-map cell_map.txt --out path_gain.bin
+# 시나리오 (--pathGainMap=path_gain.bin) 의 SionnaPropagationLossModel / SionnaChannelConditionModel 이
+# mmap 으로 읽는 셀별 path gain + LOS 격자를 Sionna RT RadioMapSolver 로 생성합니다.
+# cell_map.txt 는 ue_localzation 시나리오가 출력 (hexRings=0 이면 _train 시나리오와 같은 배치)
+#
+# 파일 형식 (little endian, ns3_change/sionna-path-gain-model.h 와 동일):
+#   header  "SPGM", uint32 version=1, numSites, nx, ny, reserved, double x0, y0, step
+#   sites   numSites x (double x, y, z, uint32 cellId, reserved)
+#   float32 pathGainDb[numSites][ny][nx]
+#   uint8   los[numSites][ny][nx]
+# 좌표는 모두 ns-3 좌표계 (scene 좌표 = ns-3 좌표 - origin)
+import argparse
+import struct
+from pathlib import Path
+import numpy as np
+
+MAGIC = b"SPGM"
+VERSION = 1
+HEADER_FMT = "<4sIIIIIddd"
+SITE_FMT = "<dddII"
+
+
+def load_cell_map(path):
+    """시나리오가 쓰는 cell_map.txt (cellId,x,y,site,sector,azimuth,image) 에서 실제 셀만"""
+    sites = []
+    with open(path) as f:
+        for line in f:
+            if not line[:1].isdigit():
+                continue
+            fields = line.strip().split(",")
+            image = int(fields[6]) if len(fields) > 6 else 0
+            if image != 0:
+                continue
+            sites.append((int(fields[0]), float(fields[1]), float(fields[2])))
+    return sites
+
+
+def write_path_gain_map(path, sites, tx_height, x0, y0, step, gain_db, los):
+    num_sites, ny, nx = gain_db.shape
+    with open(path, "wb") as f:
+        f.write(struct.pack(HEADER_FMT, MAGIC, VERSION, num_sites, nx, ny, 0, x0, y0, step))
+        for cell_id, x, y in sites:
+            f.write(struct.pack(SITE_FMT, x, y, tx_height, cell_id, 0))
+        f.write(np.ascontiguousarray(gain_db, dtype="<f4").tobytes())
+        f.write(np.ascontiguousarray(los, dtype=np.uint8).tobytes())
+
+
+def read_path_gain_map(path):
+    """검증용: (header dict, sites, gain_db, los) 를 np.memmap 으로 반환"""
+    with open(path, "rb") as f:
+        header = struct.unpack(HEADER_FMT, f.read(struct.calcsize(HEADER_FMT)))
+    magic, version, num_sites, nx, ny, _, x0, y0, step = header
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(f"{path}: unknown format")
+    offset = struct.calcsize(HEADER_FMT)
+    sites = np.memmap(path, dtype=np.dtype([("x", "<f8"), ("y", "<f8"), ("z", "<f8"),
+                                            ("cellId", "<u4"), ("reserved", "<u4")]),
+                      mode="r", offset=offset, shape=(num_sites,))
+    offset += num_sites * struct.calcsize(SITE_FMT)
+    gain_db = np.memmap(path, dtype="<f4", mode="r", offset=offset, shape=(num_sites, ny, nx))
+    offset += gain_db.nbytes
+    los = np.memmap(path, dtype=np.uint8, mode="r", offset=offset, shape=(num_sites, ny, nx))
+    return {"x0": x0, "y0": y0, "step": step, "nx": nx, "ny": ny}, sites, gain_db, los
+
+
+def compute_radio_maps(args, sites):
+    # Sionna RT 1.x (mitsuba 3) API
+    from sionna.rt import load_scene, Transmitter, PlanarArray, RadioMapSolver
+
+    scene = load_scene(str(args.scene))
+    scene.frequency = args.frequency
+    # 시나리오 안테나가 isotropic 이므로 동일하게
+    scene.tx_array = PlanarArray(num_rows=1, num_cols=1, pattern="iso", polarization="V")
+    scene.rx_array = PlanarArray(num_rows=1, num_cols=1, pattern="iso", polarization="V")
+
+    ox, oy = args.origin
+    for cell_id, x, y in sites:
+        scene.add(Transmitter(name=f"cell{cell_id}", position=[x - ox, y - oy, args.tx_height]))
+
+    xs = [x for _, x, _ in sites]
+    ys = [y for _, _, y in sites]
+    if args.area:
+        xmin, ymin, xmax, ymax = args.area
+    else:
+        xmin, xmax = min(xs) - args.margin, max(xs) + args.margin
+        ymin, ymax = min(ys) - args.margin, max(ys) + args.margin
+    center = [(xmin + xmax) / 2 - ox, (ymin + ymax) / 2 - oy, args.rx_height]
+    size = [xmax - xmin, ymax - ymin]
+
+    solver = RadioMapSolver()
+    common = dict(center=center, orientation=[0, 0, 0], size=size,
+                  cell_size=[args.step, args.step], samples_per_tx=args.samples)
+    print(f"🛰️ Radio map: {len(sites)} cells, {size[0]:.0f} x {size[1]:.0f} m, step {args.step} m")
+    rm = solver(scene, max_depth=args.max_depth, los=True, specular_reflection=True,
+                diffuse_reflection=args.diffuse, refraction=True, **common)
+    # 직접파만 (max_depth=0) 계산해서 0 이 아니면 LOS
+    rm_los = solver(scene, max_depth=0, los=True, specular_reflection=False,
+                    diffuse_reflection=False, refraction=False, **common)
+
+    gain = np.asarray(rm.path_gain.numpy(), dtype=np.float64)
+    gain_db = 10 * np.log10(np.maximum(gain, 1e-30))
+    gain_db = np.maximum(gain_db, args.min_gain_db).astype(np.float32)
+    los = (np.asarray(rm_los.path_gain.numpy()) > 0).astype(np.uint8)
+
+    centers = np.asarray(rm.cell_centers.numpy())
+    x0 = float(centers[0, 0, 0]) + ox
+    y0 = float(centers[0, 0, 1]) + oy
+    return x0, y0, gain_db, los
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Export per-cell Sionna path gain grids for ns-3")
+    parser.add_argument("--scene", type=Path, required=True, help="Sionna scene xml (xml_convert.py output)")
+    parser.add_argument("--cell-map", type=Path, default=Path("cell_map.txt"), help="scenario cell map")
+    parser.add_argument("--out", type=Path, default=Path("path_gain.bin"))
+    parser.add_argument("--origin", type=float, nargs=2, default=[0.0, 0.0],
+                        help="ns-3 coordinates of the scene origin")
+    parser.add_argument("--area", type=float, nargs=4, metavar=("XMIN", "YMIN", "XMAX", "YMAX"),
+                        help="grid extent in ns-3 coordinates (default: sites + margin)")
+    parser.add_argument("--margin", type=float, default=300.0)
+    parser.add_argument("--step", type=float, default=2.0, help="grid spacing [m]")
+    parser.add_argument("--frequency", type=float, default=3.5e9)
+    parser.add_argument("--tx-height", type=float, default=10.0, help="gNB height (scenario: 10 m)")
+    parser.add_argument("--rx-height", type=float, default=1.5)
+    parser.add_argument("--max-depth", type=int, default=5)
+    parser.add_argument("--diffuse", action="store_true")
+    parser.add_argument("--samples", type=int, default=10**7)
+    parser.add_argument("--min-gain-db", type=float, default=-250.0, help="floor for cells without paths")
+    args = parser.parse_args()
+
+    sites = load_cell_map(args.cell_map)
+    if not sites:
+        raise SystemExit(f"❌ No cells in {args.cell_map}")
+
+    x0, y0, gain_db, los = compute_radio_maps(args, sites)
+    write_path_gain_map(args.out, sites, args.tx_height, x0, y0, args.step, gain_db, los)
+
+    size_mb = args.out.stat().st_size / 1e6
+    print(f"✅ {args.out}: {gain_db.shape[0]} cells, {gain_db.shape[2]} x {gain_db.shape[1]} points, "
+          f"LOS {los.mean() * 100:.1f}%, {size_mb:.1f} MB")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,261 @@
+/*
+ * log_kpm_measurements 이름 처리 벤치마크 (ns / measurement item)
+ *
+ *   gcc -O2 -o bench_meas_names bench_meas_names.c
+ *   ./bench_meas_names [repeat] cu-cp-cell-2.txt cu-cp-cell-3.txt ...
+ *
+ * Rebuilds the measurement names of each cu-cp indication from the recorded
+ * traces (one indication = the rows of one cell with the same timestamp:
+ * "L3servingSINR3gpp_cell_<c>_UEID_<ue>" + "L3neighSINRListOf_UEID_<ue>_of_Cell_<c>"
+ * per UE) and times the old dispatch (two passes of strncmp + sscanf) against
+ * meas_name_cache.h (one pass, hash lookup). Without trace files a synthetic
+ * run of 7 cells x 50 UEs x 1000 indications is used.
+ */
+
+#include "meas_name_cache.h"
+#include <stdbool.h>
+#include <time.h>
+
+typedef struct {
+    uint8_t* buf;
+    size_t len;
+} name_t;
+
+typedef struct {
+    name_t* items;
+    size_t len;
+    size_t cap;
+} indication_t;
+
+static indication_t* indications = NULL;
+static size_t num_indications = 0;
+static size_t cap_indications = 0;
+static size_t num_items = 0;
+
+static indication_t* new_indication(void) {
+    if (num_indications == cap_indications) {
+        cap_indications = cap_indications ? cap_indications * 2 : 1024;
+        indications = realloc(indications, cap_indications * sizeof(indication_t));
+        if (indications == NULL) {
+            fprintf(stderr, "❌ Out of memory\n");
+            exit(1);
+        }
+    }
+    indication_t* ind = &indications[num_indications++];
+    memset(ind, 0, sizeof(*ind));
+    return ind;
+}
+
+static void add_name(indication_t* ind, const char* name) {
+    if (ind->len == ind->cap) {
+        ind->cap = ind->cap ? ind->cap * 2 : 64;
+        ind->items = realloc(ind->items, ind->cap * sizeof(name_t));
+        if (ind->items == NULL) {
+            fprintf(stderr, "❌ Out of memory\n");
+            exit(1);
+        }
+    }
+    // 기존 코드가 buf 를 C 문자열로 쓰므로 NUL 포함해서 복사 (len 에는 미포함)
+    size_t len = strlen(name);
+    name_t* n = &ind->items[ind->len++];
+    n->buf = malloc(len + 1);
+    memcpy(n->buf, name, len + 1);
+    n->len = len;
+    num_items++;
+}
+
+static void add_ue(indication_t* ind, unsigned cell, unsigned ue) {
+    char name[MEAS_NAME_CACHE_MAX_LEN + 1];
+    snprintf(name, sizeof(name), "L3servingSINR3gpp_cell_%u_UEID_%u", cell, ue);
+    add_name(ind, name);
+    snprintf(name, sizeof(name), "L3neighSINRListOf_UEID_%u_of_Cell_%u", ue, cell);
+    add_name(ind, name);
+}
+
+static int column_index(char* header, const char* column) {
+    int idx = 0;
+    for (char* tok = strtok(header, ",\r\n"); tok != NULL; tok = strtok(NULL, ",\r\n"), idx++) {
+        if (strcmp(tok, column) == 0) {
+            return idx;
+        }
+    }
+    return -1;
+}
+
+static bool load_trace(const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "❌ Can't open file %s\n", path);
+        return false;
+    }
+
+    char line[8192];
+    char header[8192];
+    if (fgets(line, sizeof(line), fp) == NULL) {
+        fclose(fp);
+        return false;
+    }
+    strcpy(header, line);
+    int col_ts = column_index(header, "timestamp");
+    strcpy(header, line);
+    int col_imsi = column_index(header, "UE (imsi)");
+    strcpy(header, line);
+    int col_cell = column_index(header, "L3 serving Id(m_cellId)");
+    if (col_ts < 0 || col_imsi < 0 || col_cell < 0) {
+        fprintf(stderr, "❌ %s: not a cu-cp trace\n", path);
+        fclose(fp);
+        return false;
+    }
+
+    indication_t* ind = NULL;
+    char last_ts[64] = "";
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char ts[64] = "";
+        long imsi = -1, cell = -1;
+        int idx = 0;
+        for (char* tok = strtok(line, ",\r\n"); tok != NULL; tok = strtok(NULL, ",\r\n"), idx++) {
+            if (idx == col_ts) {
+                snprintf(ts, sizeof(ts), "%s", tok);
+            } else if (idx == col_imsi) {
+                imsi = strtol(tok, NULL, 10);
+            } else if (idx == col_cell) {
+                cell = strtol(tok, NULL, 10);
+            }
+        }
+        if (imsi < 0 || cell < 0) {
+            continue;
+        }
+        if (ind == NULL || strcmp(ts, last_ts) != 0) {
+            ind = new_indication();
+            strcpy(last_ts, ts);
+        }
+        add_ue(ind, (unsigned)cell, (unsigned)imsi);
+    }
+    fclose(fp);
+    return true;
+}
+
+static void load_synthetic(void) {
+    for (unsigned t = 0; t < 1000; t++) {
+        for (unsigned cell = 2; cell <= 8; cell++) {
+            indication_t* ind = new_indication();
+            for (unsigned ue = 1; ue <= 50; ue++) {
+                add_ue(ind, cell, ue);
+            }
+        }
+    }
+}
+
+// =============================================================================
+// 기존 방식: 이름마다 strncmp + sscanf, serving / neighbor 두 번 순회
+// =============================================================================
+static bool isMeasNameContains(const char* meas_name, const char* name) {
+    return strncmp(meas_name, name, strlen(name)) == 0;
+}
+
+static uint64_t dispatch_old(indication_t const* ind) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < ind->len; i++) {
+        const char* name = (const char*)ind->items[i].buf;
+        if (isMeasNameContains(name, "L3servingSINR3gpp_cell_")) {
+            unsigned short cell, ue;
+            if (sscanf(name, "L3servingSINR3gpp_cell_%hu_UEID_%hu", &cell, &ue) == 2) {
+                sum += cell + ue;
+            }
+        }
+    }
+    for (size_t i = 0; i < ind->len; i++) {
+        const char* name = (const char*)ind->items[i].buf;
+        if (isMeasNameContains(name, "L3neighSINRListOf_UEID_")) {
+            unsigned short cell, ue;
+            if (sscanf(name, "L3neighSINRListOf_UEID_%hu_of_Cell_%hu", &ue, &cell) == 2) {
+                sum += cell + ue;
+            }
+        }
+    }
+    return sum;
+}
+
+// =============================================================================
+// 캐시: 한 번 순회, 이름당 해시 조회
+// =============================================================================
+static uint64_t dispatch_cached(meas_name_cache_t* cache, indication_t const* ind) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < ind->len; i++) {
+        meas_name_info_t const* info = meas_name_lookup(cache, ind->items[i].buf, ind->items[i].len);
+        if (info->kind != MEAS_NAME_OTHER) {
+            sum += info->cellID + info->ueID;
+        }
+    }
+    return sum;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char* argv[]) {
+    int repeat = 10;
+    int first_file = 1;
+    if (argc > 1 && strtol(argv[1], NULL, 10) > 0 && strstr(argv[1], ".txt") == NULL) {
+        repeat = (int)strtol(argv[1], NULL, 10);
+        first_file = 2;
+    }
+
+    for (int i = first_file; i < argc; i++) {
+        load_trace(argv[i]);
+    }
+    if (num_items == 0) {
+        printf("📁 No trace files, synthetic indications\n");
+        load_synthetic();
+    }
+    printf("📊 %zu indications, %zu measurement items, %d repeats\n",
+           num_indications, num_items, repeat);
+
+    // 기존 방식
+    uint64_t sum_old = 0;
+    double t0 = now_ns();
+    for (int r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < num_indications; i++) {
+            sum_old += dispatch_old(&indications[i]);
+        }
+    }
+    double old_ns = (now_ns() - t0) / ((double)num_items * repeat);
+
+    // 캐시 (첫 번째 repeat 에 이름이 채워짐 → 따로 측정)
+    meas_name_cache_t cache;
+    meas_name_cache_init(&cache);
+    uint64_t sum_cached = 0;
+    t0 = now_ns();
+    for (size_t i = 0; i < num_indications; i++) {
+        sum_cached += dispatch_cached(&cache, &indications[i]);
+    }
+    double cold_ns = (now_ns() - t0) / (double)num_items;
+    t0 = now_ns();
+    for (int r = 1; r < repeat; r++) {
+        for (size_t i = 0; i < num_indications; i++) {
+            sum_cached += dispatch_cached(&cache, &indications[i]);
+        }
+    }
+    double warm_ns = repeat > 1 ? (now_ns() - t0) / ((double)num_items * (repeat - 1)) : cold_ns;
+
+    printf("🐢 strncmp + sscanf (2 passes): %8.1f ns/item\n", old_ns);
+    printf("🔥 interned (1 pass, first):    %8.1f ns/item (%zu names cached)\n", cold_ns, cache.count);
+    printf("🔥 interned (1 pass, warm):     %8.1f ns/item (x%.1f)\n", warm_ns, old_ns / warm_ns);
+    if (sum_old != sum_cached) {
+        printf("❌ Results differ: %lu vs %lu\n", (unsigned long)sum_old, (unsigned long)sum_cached);
+        return 1;
+    }
+
+    meas_name_cache_free(&cache);
+    for (size_t i = 0; i < num_indications; i++) {
+        for (size_t j = 0; j < indications[i].len; j++) {
+            free(indications[i].items[j].buf);
+        }
+        free(indications[i].items);
+    }
+    free(indications);
+    return 0;
+}
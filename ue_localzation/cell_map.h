@@ -0,0 +1,143 @@
+/*
+ * Cell position map shared by the localization xApps
+ * 🔥 시나리오가 쓰는 cell_map.txt (cellId,x,y,site,sector,azimuth,image) 를 시작 시 로드
+ *
+ * The scenario writes the map once the gNBs are installed (cellMapFile). The
+ * path is taken from the CELL_MAP_FILE environment variable, "cell_map.txt"
+ * in the working directory otherwise. Rows with image > 0 (wrap-around
+ * copies) are skipped: the xApps only need the real cell positions.
+ *
+ * cell_map_load_index builds the cellID -> position lookup the xApps use,
+ * falling back to the xApp's built-in table when the map is missing.
+ */
+
+#ifndef CELL_MAP_H
+#define CELL_MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "xapp_logger.h"
+
+// cell IDs above this value are not indexed (cell_map_find returns NULL)
+#define CELL_MAP_MAX_CELL_ID 4095
+#define CELL_MAP_DEFAULT_FILE "cell_map.txt"
+
+typedef struct {
+    uint16_t cellID;
+    double x;
+    double y;
+} cell_map_entry_t;
+
+static inline const char* cell_map_path(void) {
+    const char *path = getenv("CELL_MAP_FILE");
+    return (path != NULL && path[0] != '\0') ? path : CELL_MAP_DEFAULT_FILE;
+}
+
+// Returns the number of cells read into *out (malloc'd, freed by the caller),
+// 0 if the file is missing or empty
+static inline size_t cell_map_load(const char *path, cell_map_entry_t **out) {
+    *out = NULL;
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+    size_t capacity = 0;
+    cell_map_entry_t *entries = NULL;
+    char line[256];
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        // header or blank line
+        if (line[0] < '0' || line[0] > '9') {
+            continue;
+        }
+
+        char *p = line;
+        char *end = NULL;
+        unsigned long cellID = strtoul(p, &end, 10);
+        if (end == p || *end != ',') continue;
+        p = end + 1;
+        double x = strtod(p, &end);
+        if (end == p || *end != ',') continue;
+        p = end + 1;
+        double y = strtod(p, &end);
+        if (end == p) continue;
+
+        // optional site,sector,azimuth,image: skip to the 4th remaining field
+        long image = 0;
+        int field = 0;
+        for (char *c = end; *c != '\0' && *c != '\n'; c++) {
+            if (*c == ',' && ++field == 4) {
+                image = strtol(c + 1, NULL, 10);
+                break;
+            }
+        }
+        if (image != 0 || cellID > CELL_MAP_MAX_CELL_ID) {
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            cell_map_entry_t *grown = realloc(entries, capacity * sizeof(cell_map_entry_t));
+            if (grown == NULL) {
+                break;
+            }
+            entries = grown;
+        }
+        entries[count].cellID = (uint16_t)cellID;
+        entries[count].x = x;
+        entries[count].y = y;
+        count++;
+    }
+    fclose(f);
+
+    if (count == 0) {
+        free(entries);
+        return 0;
+    }
+    *out = entries;
+    return count;
+}
+
+// cellID -> position (시작 시 한 번 만들고 이후 읽기만 함)
+typedef struct {
+    cell_map_entry_t* table;
+    size_t len;
+    bool from_file;              // table 은 cell_map_load 가 할당한 것
+    cell_map_entry_t* index[CELL_MAP_MAX_CELL_ID + 1];
+} cell_map_index_t;
+
+// 시나리오의 cell map 이 있으면 그것을, 없으면 builtin 테이블을 사용
+static inline void cell_map_load_index(cell_map_index_t* m, cell_map_entry_t* builtin, size_t builtin_len) {
+    memset(m, 0, sizeof(*m));
+    cell_map_entry_t* entries = NULL;
+    size_t n = cell_map_load(cell_map_path(), &entries);
+    if (n > 0) {
+        m->table = entries;
+        m->len = n;
+        m->from_file = true;
+        xlog_info("📍 Cell map: %zu cells from %s\n", n, cell_map_path());
+    } else {
+        m->table = builtin;
+        m->len = builtin_len;
+        xlog_warn("⚠️  Cell map %s not found, using the built-in %zu-cell table\n",
+                  cell_map_path(), builtin_len);
+    }
+
+    for (size_t i = 0; i < m->len; i++) {
+        if (m->table[i].cellID <= CELL_MAP_MAX_CELL_ID) {
+            m->index[m->table[i].cellID] = &m->table[i];
+        }
+    }
+}
+
+// NULL: 모르는 cell
+static inline cell_map_entry_t const* cell_map_find(cell_map_index_t const* m, uint16_t cellID) {
+    return cellID <= CELL_MAP_MAX_CELL_ID ? m->index[cellID] : NULL;
+}
+
+#endif // CELL_MAP_H
@@ -0,0 +1,167 @@
+/*
+ * Epoch aligner for the xApps
+ * 🔥 UE 개수를 세는 대신 collectStartTime (epoch) 기준으로 측정값을 모아서 batch 로 방출
+ *
+ * Every E2 node reports one indication per period with the same
+ * collectStartTime, so the records of one epoch arrive spread over several
+ * indications, possibly after the first indications of the next epoch.
+ * Records are kept per epoch, oldest first, and an epoch is closed once
+ * reorder_window newer epochs have been seen (XAPP_REORDER_EPOCHS, default 1:
+ * the records of an epoch are accepted until the epoch after next begins).
+ * Closed epochs are emitted in collectStartTime order with the sequence
+ * (epoch - first_epoch) / period_ms (the relative_timestamp of the outputs),
+ * first_epoch being the first emitted epoch. A missing epoch leaves a gap in
+ * the sequence, as the offline alignment (timestamp - t0) // 100 of
+ * python/make_csv_split_offline.py does.
+ *
+ * The watermark is the last closed epoch: records at or below it are late and
+ * dropped (counted in late_records), so an epoch is emitted exactly once
+ * whatever the number of UEs, cells or E2 nodes. epoch_aligner_flush closes
+ * everything (shutdown). The emit callback must not add records itself.
+ */
+
+#ifndef EPOCH_ALIGNER_H
+#define EPOCH_ALIGNER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EPOCH_ALIGNER_MAX_OPEN 16
+#define EPOCH_ALIGNER_DEFAULT_WINDOW 1
+
+typedef struct {
+    uint64_t epoch;              // collectStartTime
+    uint64_t sequence;           // (epoch - first_epoch) / period_ms (emit 할 때 할당)
+    unsigned char* records;      // count x elem_size, 도착 순서
+    size_t count;
+    size_t cap;
+} epoch_batch_t;
+
+typedef void (*epoch_emit_fn)(epoch_batch_t const* batch, void* ctx);
+
+typedef struct {
+    size_t elem_size;
+    uint64_t period_ms;          // indication 주기 (collectStartTime 간격)
+    size_t reorder_window;       // 닫기 전에 기다리는 newer epoch 개수
+    epoch_emit_fn emit;
+    void* ctx;
+
+    // [0, num_open): 열린 epoch (오래된 것부터), 그 뒤: 재사용할 빈 batch
+    epoch_batch_t open[EPOCH_ALIGNER_MAX_OPEN + 1];
+    size_t num_open;
+
+    bool has_watermark;
+    uint64_t watermark;          // 마지막으로 닫은 epoch
+    uint64_t first_epoch;        // 처음 닫은 epoch (sequence 0)
+    uint64_t late_records;
+} epoch_aligner_t;
+
+static inline size_t epoch_aligner_default_window(void) {
+    const char* env = getenv("XAPP_REORDER_EPOCHS");
+    if (env == NULL || env[0] == '\0') {
+        return EPOCH_ALIGNER_DEFAULT_WINDOW;
+    }
+    long n = atol(env);
+    if (n < 0) n = 0;
+    if (n > EPOCH_ALIGNER_MAX_OPEN - 1) n = EPOCH_ALIGNER_MAX_OPEN - 1;
+    return (size_t)n;
+}
+
+static inline void epoch_aligner_init(epoch_aligner_t* a, size_t elem_size, uint64_t period_ms,
+                                      size_t reorder_window, epoch_emit_fn emit, void* ctx) {
+    memset(a, 0, sizeof(*a));
+    a->elem_size = elem_size;
+    a->period_ms = period_ms;
+    a->reorder_window = reorder_window < EPOCH_ALIGNER_MAX_OPEN ? reorder_window : EPOCH_ALIGNER_MAX_OPEN - 1;
+    a->emit = emit;
+    a->ctx = ctx;
+}
+
+// 가장 오래된 열린 epoch 을 방출, 버퍼는 빈 batch 로 재사용
+static inline void epoch_aligner_close_oldest(epoch_aligner_t* a) {
+    epoch_batch_t batch = a->open[0];
+    if (!a->has_watermark) {
+        a->first_epoch = batch.epoch;
+    }
+    // 닫은 개수가 아니라 collectStartTime 에서: 빠진 epoch 이 있어도 뒤의 행이 밀리지 않음
+    uint64_t elapsed = batch.epoch - a->first_epoch;
+    batch.sequence = a->period_ms > 0 ? elapsed / a->period_ms : elapsed;
+    a->has_watermark = true;
+    a->watermark = batch.epoch;
+    if (a->emit != NULL) {
+        a->emit(&batch, a->ctx);
+    }
+
+    memmove(&a->open[0], &a->open[1], (a->num_open - 1) * sizeof(epoch_batch_t));
+    a->num_open--;
+    batch.count = 0;
+    a->open[a->num_open] = batch;
+}
+
+// epoch 의 열린 batch (없으면 순서에 맞게 새로 엶)
+static inline epoch_batch_t* epoch_aligner_batch(epoch_aligner_t* a, uint64_t epoch) {
+    size_t p = 0;
+    while (p < a->num_open && a->open[p].epoch < epoch) {
+        p++;
+    }
+    if (p < a->num_open && a->open[p].epoch == epoch) {
+        return &a->open[p];
+    }
+
+    epoch_batch_t spare = a->open[a->num_open];
+    memmove(&a->open[p + 1], &a->open[p], (a->num_open - p) * sizeof(epoch_batch_t));
+    spare.epoch = epoch;
+    spare.count = 0;
+    a->open[p] = spare;
+    a->num_open++;
+    return &a->open[p];
+}
+
+// false: watermark 이하 (늦게 도착) 또는 메모리 부족, 레코드는 버림
+static inline bool epoch_aligner_add(epoch_aligner_t* a, uint64_t epoch, void const* record) {
+    if (a->has_watermark && epoch <= a->watermark) {
+        a->late_records++;
+        return false;
+    }
+
+    epoch_batch_t* b = epoch_aligner_batch(a, epoch);
+    if (b->count == b->cap) {
+        size_t cap = b->cap ? b->cap * 2 : 256;
+        unsigned char* grown = realloc(b->records, cap * a->elem_size);
+        if (grown == NULL) {
+            return false;
+        }
+        b->records = grown;
+        b->cap = cap;
+    }
+    memcpy(b->records + b->count * a->elem_size, record, a->elem_size);
+    b->count++;
+
+    // 창보다 많이 열려 있으면 오래된 것부터 닫기 (창보다 오래된 새 epoch 은 이 레코드만으로 닫힘)
+    while (a->num_open > a->reorder_window + 1) {
+        epoch_aligner_close_oldest(a);
+    }
+    return true;
+}
+
+static inline void const* epoch_batch_at(epoch_aligner_t const* a, epoch_batch_t const* b, size_t i) {
+    return b->records + i * a->elem_size;
+}
+
+// 열린 epoch 을 모두 방출 (종료 시)
+static inline void epoch_aligner_flush(epoch_aligner_t* a) {
+    while (a->num_open > 0) {
+        epoch_aligner_close_oldest(a);
+    }
+}
+
+static inline void epoch_aligner_free(epoch_aligner_t* a) {
+    for (size_t i = 0; i <= EPOCH_ALIGNER_MAX_OPEN; i++) {
+        free(a->open[i].records);
+    }
+    epoch_aligner_init(a, a->elem_size, a->period_ms, a->reorder_window, a->emit, a->ctx);
+}
+
+#endif // EPOCH_ALIGNER_H
@@ -0,0 +1,96 @@
+/*
+ * Indication inter-arrival monitor for the xApps
+ * 🔥 KPM indication 도착 간격 (wall clock) 과 주기 대비 jitter 측정
+ *
+ * Every E2 node sends one indication per period, all with the same
+ * collectStartTime: the first indication with a new collectStartTime opens an
+ * epoch. For each epoch the wall-clock inter-arrival from the previous epoch,
+ * its deviation from the subscription period and the spread of the previous
+ * epoch (first to last indication) are recorded, optionally one csv row per
+ * epoch. With the paced scenario (speedFactor) the deviation should stay
+ * close to 0 at speedFactor 1.
+ */
+
+#ifndef INDICATION_JITTER_H
+#define INDICATION_JITTER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+    double period_ms;
+    uint64_t epoch;              // collectStartTime of the current epoch
+    int64_t epoch_first_us;      // wall arrival of its first indication
+    int64_t epoch_last_us;       // wall arrival of its last indication
+    uint64_t epochs;
+    uint64_t intervals;
+    double mean_ms;              // inter-arrival, Welford
+    double m2_ms;
+    double max_dev_ms;           // max |inter-arrival - period|
+    double max_spread_ms;
+    FILE* csv;
+} indication_jitter_t;
+
+static inline void indication_jitter_init(indication_jitter_t* j, uint64_t period_ms, const char* csv_path) {
+    memset(j, 0, sizeof(*j));
+    j->period_ms = (double)period_ms;
+    if (csv_path != NULL) {
+        j->csv = fopen(csv_path, "w");
+        if (j->csv != NULL) {
+            fprintf(j->csv, "epoch,arrival_us,interarrival_ms,deviation_ms,prev_spread_ms\n");
+        }
+    }
+}
+
+// now_us: wall clock (time_now_us) at the reception of the indication
+static inline void indication_jitter_on_indication(indication_jitter_t* j, uint64_t epoch, int64_t now_us) {
+    if (j->epochs > 0 && epoch == j->epoch) {
+        j->epoch_last_us = now_us;
+        return;
+    }
+
+    if (j->epochs > 0) {
+        double interarrival = (now_us - j->epoch_first_us) / 1000.0;
+        double deviation = interarrival - j->period_ms;
+        double spread = (j->epoch_last_us - j->epoch_first_us) / 1000.0;
+
+        j->intervals++;
+        double delta = interarrival - j->mean_ms;
+        j->mean_ms += delta / j->intervals;
+        j->m2_ms += delta * (interarrival - j->mean_ms);
+        if (fabs(deviation) > j->max_dev_ms) j->max_dev_ms = fabs(deviation);
+        if (spread > j->max_spread_ms) j->max_spread_ms = spread;
+
+        if (j->csv != NULL) {
+            fprintf(j->csv, "%lu,%ld,%.3f,%.3f,%.3f\n", (unsigned long)epoch, (long)now_us,
+                    interarrival, deviation, spread);
+        }
+    }
+
+    j->epoch = epoch;
+    j->epoch_first_us = now_us;
+    j->epoch_last_us = now_us;
+    j->epochs++;
+}
+
+static inline void indication_jitter_print(indication_jitter_t const* j) {
+    if (j->intervals < 2) {
+        return;
+    }
+    double std_ms = sqrt(j->m2_ms / (j->intervals - 1));
+    printf("⏱️  Indications: %lu epochs, inter-arrival %.1f ± %.1f ms (period %.0f ms), "
+           "max deviation %.1f ms, max burst spread %.1f ms\n",
+           (unsigned long)j->epochs, j->mean_ms, std_ms, j->period_ms, j->max_dev_ms, j->max_spread_ms);
+}
+
+static inline void indication_jitter_close(indication_jitter_t* j) {
+    indication_jitter_print(j);
+    if (j->csv != NULL) {
+        fclose(j->csv);
+        j->csv = NULL;
+    }
+}
+
+#endif // INDICATION_JITTER_H
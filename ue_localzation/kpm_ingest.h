@@ -0,0 +1,348 @@
+/*
+ * KPM ingestion shared by the xApps
+ * 🔥 구독 생성 / indication 파싱을 한 곳에서: xApp 은 샘플 콜백 (plug-in) 만 구현
+ *
+ * Subscription: kpm_ingest_subscribe builds the same REPORT subscription for
+ * every E2 node with a KPM RAN function (format 1 event trigger every
+ * period_ms, format 4 action definition over all the measurements the node
+ * offers, one matching condition) and kpm_ingest_unsubscribe removes it.
+ *
+ * Parsing: kpm_ingest_indication walks the per-UE reports of a cu-cp
+ * indication once. Measurement names are resolved through meas_name_cache.h;
+ * for each UE report the serving SINR sample is emitted first, then the
+ * (SINR, cellID) pairs of its neighbor list, each through the on_sample
+ * callback together with the indication's collectStartTime. Everything
+ * app-specific (epoch alignment, output format) happens in the callback.
+ *
+ * The other building blocks are the shared headers next to this one:
+ * ue_table.h (per-UE state), ue_window.h (per-UE windows: running sums,
+ * top-K neighbors, one emit per UE and sequence), epoch_aligner.h (epoch
+ * windows), xapp_logger.h / predictor_link.h (file and socket sinks).
+ *
+ * A kpm_ingest_t is not thread safe; the xApps call it from the indication
+ * callback under their own lock.
+ */
+
+#ifndef KPM_INGEST_H
+#define KPM_INGEST_H
+
+#include "../../../../src/xApp/e42_xapp_api.h"
+#include "../../../../src/xApp/sm_ran_function.h"
+#include "../../../../src/util/e.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "meas_name_cache.h"
+#include "ue_window.h"
+
+#define KPM_INGEST_RAN_FUNC_ID 2
+
+typedef enum {
+    KPM_SAMPLE_SERVING = 0,
+    KPM_SAMPLE_NEIGHBOR,
+} kpm_sample_type_e;
+
+typedef struct {
+    kpm_sample_type_e type;
+    uint16_t ueID;
+    uint16_t cellID;             // serving: serving cell, neighbor: neighbor cell
+    uint16_t reportCellID;       // 측정 이름의 cell (neighbor 목록을 보고한 serving cell)
+    bool integer;                // INTEGER_MEAS_VALUE 로 온 serving SINR (인코딩된 값)
+    double sinr;
+    uint64_t timestamp;          // collectStartTime
+} kpm_sample_t;
+
+typedef void (*kpm_sample_fn)(kpm_sample_t const* sample, void* ctx);
+
+// matching condition (IsStat 비교)
+typedef struct {
+    test_cond_e cond;
+    int value;
+} kpm_ingest_filter_t;
+
+// 한 UE report 의 neighbor 목록 항목 (serving 샘플 뒤에 처리)
+typedef struct {
+    size_t item;
+    uint16_t ueID;
+    uint16_t cellID;
+} kpm_neigh_item_t;
+
+typedef struct {
+    kpm_sample_fn on_sample;
+    void* ctx;
+    meas_name_cache_t names;
+    kpm_neigh_item_t* neigh_items;
+    size_t num_neigh_items;
+    size_t neigh_items_cap;
+    uint64_t indications;
+    uint64_t samples;
+} kpm_ingest_t;
+
+// =============================================================================
+// SUBSCRIPTION
+// =============================================================================
+
+static inline label_info_lst_t kpm_ingest_label(void) {
+    label_info_lst_t label_item = {0};
+    label_item.noLabel = ecalloc(1, sizeof(enum_value_e));
+    *label_item.noLabel = TRUE_ENUM_VALUE;
+    return label_item;
+}
+
+static inline test_info_lst_t kpm_ingest_filter_predicate(test_cond_type_e type, test_cond_e cond, int value) {
+    test_info_lst_t dst = {0};
+
+    dst.test_cond_type = type;
+    dst.IsStat = TRUE_TEST_COND_TYPE;
+
+    dst.test_cond = calloc(1, sizeof(test_cond_e));
+    assert(dst.test_cond != NULL && "Memory allocation failed for test_cond");
+    *dst.test_cond = cond;
+
+    dst.test_cond_value = calloc(1, sizeof(test_cond_value_t));
+    assert(dst.test_cond_value != NULL && "Memory allocation failed for test_cond_value");
+    dst.test_cond_value->type = INTEGER_TEST_COND_VALUE;
+
+    int64_t *int_value = calloc(1, sizeof(int64_t));
+    assert(int_value != NULL && "Memory allocation failed for int_value");
+    *int_value = value;
+    dst.test_cond_value->int_value = int_value;
+    return dst;
+}
+
+// node 가 제공하는 측정 이름 전부를 label 없이 요청
+static inline kpm_act_def_format_1_t kpm_ingest_act_def_frm_1(ric_report_style_item_t const* report_item,
+                                                              uint64_t period_ms) {
+    assert(report_item != NULL);
+
+    kpm_act_def_format_1_t ad_frm_1 = {0};
+    size_t const sz = report_item->meas_info_for_action_lst_len;
+
+    ad_frm_1.meas_info_lst_len = sz;
+    ad_frm_1.meas_info_lst = calloc(sz, sizeof(meas_info_format_1_lst_t));
+    assert(ad_frm_1.meas_info_lst != NULL && "Memory exhausted");
+
+    for (size_t i = 0; i < sz; i++) {
+        meas_info_format_1_lst_t* meas_item = &ad_frm_1.meas_info_lst[i];
+        meas_item->meas_type.type = NAME_MEAS_TYPE;
+        meas_item->meas_type.name = copy_byte_array(report_item->meas_info_for_action_lst[i].name);
+
+        meas_item->label_info_lst_len = 1;
+        meas_item->label_info_lst = ecalloc(1, sizeof(label_info_lst_t));
+        meas_item->label_info_lst[0] = kpm_ingest_label();
+    }
+
+    ad_frm_1.gran_period_ms = period_ms;
+    ad_frm_1.cell_global_id = NULL;
+
+#if defined KPM_V2_03 || defined KPM_V3_00
+    ad_frm_1.meas_bin_range_info_lst_len = 0;
+    ad_frm_1.meas_bin_info_lst = NULL;
+#endif
+
+    return ad_frm_1;
+}
+
+static inline kpm_sub_data_t kpm_ingest_gen_subs(kpm_ran_function_def_t const* ran_func, uint64_t period_ms,
+                                                 kpm_ingest_filter_t filter) {
+    assert(ran_func != NULL);
+    assert(ran_func->ric_event_trigger_style_list != NULL);
+
+    kpm_sub_data_t kpm_sub = {0};
+
+    assert(ran_func->ric_event_trigger_style_list[0].format_type == FORMAT_1_RIC_EVENT_TRIGGER);
+    kpm_sub.ev_trg_def.type = FORMAT_1_RIC_EVENT_TRIGGER;
+    kpm_sub.ev_trg_def.kpm_ric_event_trigger_format_1.report_period_ms = period_ms;
+
+    kpm_sub.sz_ad = 1;
+    kpm_sub.ad = calloc(kpm_sub.sz_ad, sizeof(kpm_act_def_t));
+    assert(kpm_sub.ad != NULL && "Memory exhausted");
+
+    ric_report_style_item_t* const report_item = &ran_func->ric_report_style_list[0];
+
+    if(report_item->act_def_format_type == FORMAT_4_ACTION_DEFINITION) {
+        kpm_sub.ad[0].type = FORMAT_4_ACTION_DEFINITION;
+
+        kpm_sub.ad[0].frm_4.matching_cond_lst_len = 1;
+        kpm_sub.ad[0].frm_4.matching_cond_lst = calloc(1, sizeof(matching_condition_format_4_lst_t));
+        assert(kpm_sub.ad[0].frm_4.matching_cond_lst != NULL && "Memory exhausted");
+
+        kpm_sub.ad[0].frm_4.matching_cond_lst[0].test_info_lst =
+            kpm_ingest_filter_predicate(IsStat_TEST_COND_TYPE, filter.cond, filter.value);
+
+        kpm_sub.ad[0].frm_4.action_def_format_1 = kpm_ingest_act_def_frm_1(report_item, period_ms);
+    }
+
+    return kpm_sub;
+}
+
+// RAN function 목록에서 id 의 위치 (없으면 sz)
+static inline size_t kpm_ingest_find_sm_idx(sm_ran_function_t const* rf, size_t sz, int id) {
+    for (size_t i = 0; i < sz; i++) {
+        if (rf[i].id == id)
+            return i;
+    }
+    return sz;
+}
+
+// KPM 을 제공하는 node 마다 구독, 결과는 nodes->len 개 (kpm_ingest_unsubscribe 로 해제)
+static inline sm_ans_xapp_t* kpm_ingest_subscribe(e2_node_arr_xapp_t const* nodes, uint64_t period_ms,
+                                                  kpm_ingest_filter_t filter, sm_cb cb) {
+    sm_ans_xapp_t* hndl = calloc(nodes->len, sizeof(sm_ans_xapp_t));
+    assert(hndl != NULL);
+
+    for (size_t i = 0; i < nodes->len; ++i) {
+        e2_node_connected_xapp_t* n = &nodes->n[i];
+        size_t const idx = kpm_ingest_find_sm_idx(n->rf, n->len_rf, KPM_INGEST_RAN_FUNC_ID);
+
+        if (idx < n->len_rf &&
+            n->rf[idx].defn.type == KPM_RAN_FUNC_DEF_E &&
+            n->rf[idx].defn.kpm.ric_report_style_list != NULL) {
+
+            kpm_sub_data_t kpm_sub = kpm_ingest_gen_subs(&n->rf[idx].defn.kpm, period_ms, filter);
+            hndl[i] = report_sm_xapp_api(&n->id, KPM_INGEST_RAN_FUNC_ID, &kpm_sub, cb);
+            assert(hndl[i].success == true);
+            free_kpm_sub_data(&kpm_sub);
+        }
+    }
+    return hndl;
+}
+
+static inline void kpm_ingest_unsubscribe(sm_ans_xapp_t* hndl, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        if (hndl[i].success == true)
+            rm_report_sm_xapp_api(hndl[i].u.handle);
+    }
+    free(hndl);
+}
+
+// =============================================================================
+// INDICATION PARSING
+// =============================================================================
+
+static inline void kpm_ingest_init(kpm_ingest_t* k, kpm_sample_fn on_sample, void* ctx) {
+    memset(k, 0, sizeof(*k));
+    k->on_sample = on_sample;
+    k->ctx = ctx;
+    meas_name_cache_init(&k->names);
+}
+
+static inline void kpm_ingest_free(kpm_ingest_t* k) {
+    meas_name_cache_free(&k->names);
+    free(k->neigh_items);
+    k->neigh_items = NULL;
+    k->num_neigh_items = 0;
+    k->neigh_items_cap = 0;
+}
+
+static inline void kpm_ingest_emit(kpm_ingest_t* k, kpm_sample_t const* sample) {
+    k->samples++;
+    k->on_sample(sample, k->ctx);
+}
+
+// UE report 하나: 이름은 캐시에서 (종류, cellID, ueID) 로 조회
+// serving 은 바로 방출, neighbor 는 모아뒀다가 serving 샘플 뒤에 방출
+static inline void kpm_ingest_ue_report(kpm_ingest_t* k, kpm_ind_msg_format_1_t const* msg_frm_1,
+                                        uint64_t timestamp) {
+    assert(msg_frm_1->meas_info_lst_len > 0);
+
+    if(msg_frm_1->meas_info_lst_len != msg_frm_1->meas_data_lst_len) {
+        return;
+    }
+
+    k->num_neigh_items = 0;
+    for(size_t i = 0; i < msg_frm_1->meas_info_lst_len; i++) {
+        meas_type_t const* meas_type = &msg_frm_1->meas_info_lst[i].meas_type;
+        if(meas_type->type != NAME_MEAS_TYPE) {
+            continue;
+        }
+        meas_name_info_t const* info = meas_name_lookup(&k->names, meas_type->name.buf, meas_type->name.len);
+
+        if(info->kind == MEAS_NAME_SERVING_SINR) {
+            meas_data_lst_t const* data_item = &msg_frm_1->meas_data_lst[i];
+            if(data_item->meas_record_len == 0) {
+                continue;
+            }
+            meas_record_lst_t const record_item = data_item->meas_record_lst[0];
+
+            if(record_item.value == REAL_MEAS_VALUE || record_item.value == INTEGER_MEAS_VALUE) {
+                kpm_sample_t sample = {
+                    .type = KPM_SAMPLE_SERVING,
+                    .ueID = info->ueID,
+                    .cellID = info->cellID,
+                    .reportCellID = info->cellID,
+                    .integer = record_item.value == INTEGER_MEAS_VALUE,
+                    .sinr = (record_item.value == REAL_MEAS_VALUE) ?
+                            record_item.real_val : (double)record_item.int_val,
+                    .timestamp = timestamp,
+                };
+                kpm_ingest_emit(k, &sample);
+            }
+        } else if(info->kind == MEAS_NAME_NEIGH_SINR_LIST) {
+            if (k->num_neigh_items == k->neigh_items_cap) {
+                size_t cap = k->neigh_items_cap ? k->neigh_items_cap * 2 : 64;
+                kpm_neigh_item_t* grown = realloc(k->neigh_items, cap * sizeof(kpm_neigh_item_t));
+                if (grown == NULL) {
+                    continue;
+                }
+                k->neigh_items = grown;
+                k->neigh_items_cap = cap;
+            }
+            k->neigh_items[k->num_neigh_items].item = i;
+            k->neigh_items[k->num_neigh_items].ueID = info->ueID;
+            k->neigh_items[k->num_neigh_items].cellID = info->cellID;
+            k->num_neigh_items++;
+        }
+    }
+
+    // neighbor 데이터는 2개씩 온다 (SINR, NeighborID)
+    for(size_t n = 0; n < k->num_neigh_items; n++) {
+        kpm_neigh_item_t const* item = &k->neigh_items[n];
+        meas_data_lst_t const* data_item = &msg_frm_1->meas_data_lst[item->item];
+        for(size_t j = 0; j + 1 < data_item->meas_record_len; j += 2) {
+            meas_record_lst_t const sinr = data_item->meas_record_lst[j];
+            meas_record_lst_t const neighID = data_item->meas_record_lst[j + 1];
+
+            if(sinr.value == REAL_MEAS_VALUE && neighID.value == INTEGER_MEAS_VALUE) {
+                kpm_sample_t sample = {
+                    .type = KPM_SAMPLE_NEIGHBOR,
+                    .ueID = item->ueID,
+                    .cellID = (uint16_t)neighID.int_val,
+                    .reportCellID = item->cellID,
+                    .sinr = sinr.real_val,
+                    .timestamp = timestamp,
+                };
+                kpm_ingest_emit(k, &sample);
+            }
+        }
+    }
+}
+
+// indication 의 format 3 메시지 (UE 별 report 목록)
+static inline kpm_ind_msg_format_3_t const* kpm_ingest_msg(sm_ag_if_rd_t const* rd) {
+    assert(rd != NULL);
+    assert(rd->type == INDICATION_MSG_AGENT_IF_ANS_V0);
+    assert(rd->ind.type == KPM_STATS_V3_0);
+    return &rd->ind.kpm.ind.msg.frm_3;
+}
+
+// indication 의 collectStartTime (시뮬레이션 시간, epoch)
+static inline uint64_t kpm_ingest_collect_start_time(sm_ag_if_rd_t const* rd) {
+    assert(rd != NULL);
+    return rd->ind.kpm.ind.hdr.kpm_ric_ind_hdr_format_1.collectStartTime;
+}
+
+// indication 전체: UE report 마다 kpm_ingest_ue_report
+static inline void kpm_ingest_indication(kpm_ingest_t* k, sm_ag_if_rd_t const* rd) {
+    kpm_ind_msg_format_3_t const* msg_frm_3 = kpm_ingest_msg(rd);
+    uint64_t const timestamp = kpm_ingest_collect_start_time(rd);
+
+    k->indications++;
+    for (size_t i = 0; i < msg_frm_3->ue_meas_report_lst_len; i++) {
+        kpm_ingest_ue_report(k, &msg_frm_3->meas_report_per_ue[i].ind_msg_format_1, timestamp);
+    }
+}
+
+#endif // KPM_INGEST_H
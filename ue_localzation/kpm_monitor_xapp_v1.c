@@ -18,6 +18,8 @@
 #include <unistd.h>
 #include <signal.h>
 #include <stdarg.h>  // va_list, va_start, va_end 등을 위해
+#include "kpm_ingest.h"
+#include "xapp_logger.h"
 
 
 
@@ -25,101 +27,21 @@
 static pthread_mutex_t mtx;
 static bool monitoring_active = true;
 static uint64_t const period_ms = 100;  // 100ms 주기
+static kpm_ingest_filter_t const kpm_filter = { LESSTHAN_TEST_COND, 40 };   // 인코딩된 SINR < 40 인경우에만
 static int indication_counter = 0;
-static FILE *log_file = NULL;
+static xlog_sink_t *log_file = NULL;
 static bool log_to_file = true;
 
-// Orange 스타일 KPM Label 생성
-static label_info_lst_t fill_kpm_label(void)
-{
-    label_info_lst_t label_item = {0};
-    label_item.noLabel = ecalloc(1, sizeof(enum_value_e));
-    *label_item.noLabel = TRUE_ENUM_VALUE;
-    return label_item;
-}
-
-static
-test_info_lst_t filter_predicate(test_cond_type_e type, test_cond_e cond, int value)
-{
-  test_info_lst_t dst = {0};
-
-  dst.test_cond_type = type;
-    dst.IsStat = TRUE_TEST_COND_TYPE;
-
-    // Allocate memory for test_cond and set its value
-    dst.test_cond = calloc(1, sizeof(test_cond_e));
-    assert(dst.test_cond != NULL && "Memory allocation failed for test_cond");
-    *dst.test_cond = cond;
-
-    // Allocate memory for test_cond_value
-    dst.test_cond_value = calloc(1, sizeof(test_cond_value_t));
-    assert(dst.test_cond_value != NULL && "Memory allocation failed for test_cond_value");
-    dst.test_cond_value->type = INTEGER_TEST_COND_VALUE;
-
-    // Allocate memory for int_value and set its value
-    int64_t *int_value = calloc(1, sizeof(int64_t));
-    assert(int_value != NULL && "Memory allocation failed for int_value");
-    *int_value = value; 
-    dst.test_cond_value->int_value = int_value;
-  return dst;
-}
-
-static
-kpm_act_def_format_1_t fill_act_def_frm_1(ric_report_style_item_t const* report_item)
-{
-  assert(report_item != NULL);
-
-  kpm_act_def_format_1_t ad_frm_1 = {0};
-
-  size_t const sz = report_item->meas_info_for_action_lst_len;
-
-  // [1, 65535]
-  ad_frm_1.meas_info_lst_len = sz;
-  ad_frm_1.meas_info_lst = calloc(sz, sizeof(meas_info_format_1_lst_t));
-  assert(ad_frm_1.meas_info_lst != NULL && "Memory exhausted");
-
-  for (size_t i = 0; i < sz; i++) {
-    meas_info_format_1_lst_t* meas_item = &ad_frm_1.meas_info_lst[i];
-    // 8.3.9
-    // Measurement Name
-    meas_item->meas_type.type = NAME_MEAS_TYPE;
-    meas_item->meas_type.name = copy_byte_array(report_item->meas_info_for_action_lst[i].name);
-
-    // [1, 2147483647]
-    // 8.3.11
-    meas_item->label_info_lst_len = 1;
-    meas_item->label_info_lst = ecalloc(1, sizeof(label_info_lst_t));
-    meas_item->label_info_lst[0] = fill_kpm_label();
-  }
-
-  // 8.3.8 [0, 4294967295]
-  ad_frm_1.gran_period_ms = period_ms;
-
-  // 8.3.20 - OPTIONAL
-  ad_frm_1.cell_global_id = NULL;
-
-#if defined KPM_V2_03 || defined KPM_V3_00
-  // [0, 65535]
-  ad_frm_1.meas_bin_range_info_lst_len = 0;
-  ad_frm_1.meas_bin_info_lst = NULL;
-#endif
-
-  return ad_frm_1;
-}
-
 static void log_both(const char* format, ...) {
     va_list args1, args2;
     va_start(args1, format);
     va_copy(args2, args1);
     
     // Console 출력
-    vprintf(format, args1);
+    xlog_vprintf(xlog_console(), format, args1);
     
     // 파일 출력
-    if (log_file != NULL) {
-        vfprintf(log_file, format, args2);
-        fflush(log_file);
-    }
+    xlog_vprintf(log_file, format, args2);
     
     va_end(args1);
     va_end(args2);
@@ -132,57 +54,6 @@ static void signal_handler(int signal) {
     monitoring_active = false;
 }
 
-// Orange 스타일 helper 함수들
-static bool eq_sm(sm_ran_function_t const* elem, int const id) {
-    return elem->id == id;
-}
-
-static size_t find_sm_idx(sm_ran_function_t* rf, size_t sz, 
-                         bool (*f)(sm_ran_function_t const*, int const), int const id) {
-    for (size_t i = 0; i < sz; i++) {
-        if (f(&rf[i], id))
-            return i;
-    }
-    assert(0 != 0 && "SM ID could not be found in the RAN Function List");
-}
-
-// Orange 스타일 측정값 파싱 구조체
-struct InfoObj { 
-    uint16_t cellID;
-    uint16_t ueID;
-};
-
-// Orange 스타일 문자열 파싱 함수들
-static struct InfoObj parseServingMsg(const char* msg) {
-    struct InfoObj info;
-    // "L3servingSINR3gpp_cell_2_UEID_13" 형식 파싱
-    int ret = sscanf(msg, "L3servingSINR3gpp_cell_%hd_UEID_%hd", &info.cellID, &info.ueID);
-    
-    if (ret == 2)
-        return info;
-    
-    info.cellID = -1;
-    info.ueID = -1;
-    return info;
-}
-
-static struct InfoObj parseNeighMsg(const char* msg) {
-    struct InfoObj info;
-    // "L3neighSINRListOf_UEID_13_of_Cell_2" 형식 파싱
-    int ret = sscanf(msg, "L3neighSINRListOf_UEID_%hd_of_Cell_%hd", &info.ueID, &info.cellID);
-    
-    if (ret == 2)
-        return info;
-    
-    info.ueID = -1;
-    info.cellID = -1;
-    return info;
-}
-
-static bool isMeasNameContains(const char* meas_name, const char* name) {
-    return strncmp(meas_name, name, strlen(name)) == 0;
-}
-
 // Orange 스타일 측정값 출력 함수들
 static void log_real_value(byte_array_t name, meas_record_lst_t meas_record)
 {
@@ -248,79 +119,30 @@ static check_meas_type match_meas_type[END_MEAS_TYPE] = {
     match_id_meas_type,
 };
 
-// Orange 스타일 KPM 측정값 로깅 함수
-static void log_kpm_measurements(kpm_ind_msg_format_1_t const* msg_frm_1)
+// 한 UE report: serving 을 출력하고 neighbor 는 모았다가 한 줄로 (kpm_ingest 샘플 콜백, mtx 안)
+static int current_ue = -1;
+static struct {
+    int neighbor_id;
+    double sinr;
+} neighbors[20];
+static int neighbor_count = 0;
+
+static void on_kpm_sample(kpm_sample_t const* s, void* ctx)
 {
-    assert(msg_frm_1->meas_info_lst_len > 0 && "Cannot correctly print measurements");
-    
-    if(msg_frm_1->meas_info_lst_len != msg_frm_1->meas_data_lst_len) {
-        return;
+    (void)ctx;
+    if (s->type == KPM_SAMPLE_SERVING) {
+        current_ue = s->ueID;
+        neighbor_count = 0;
+        log_both("\n📱 UE %d - Cell %d: %.2f dB\n", s->ueID, s->cellID, s->sinr);
+    } else if (s->ueID == current_ue && neighbor_count < 20) {
+        neighbors[neighbor_count].neighbor_id = s->cellID;
+        neighbors[neighbor_count].sinr = s->sinr;
+        neighbor_count++;
     }
+}
 
-    // 현재 UE의 정보를 저장할 변수들
-    int current_ue = -1;
-    int current_cell = -1;
-    double serving_sinr = 0.0;
-    
-    // Neighbor 정보를 임시 저장할 구조체
-    struct {
-        int neighbor_id;
-        double sinr;
-    } neighbors[20];
-    int neighbor_count = 0;
-
-    // Orange 스타일 측정값 처리
-    for(size_t i = 0; i < msg_frm_1->meas_info_lst_len; i++) {
-        meas_type_t const meas_type = msg_frm_1->meas_info_lst[i].meas_type;
-        meas_data_lst_t const data_item = msg_frm_1->meas_data_lst[i];
-        
-        for(size_t j = 0; j < data_item.meas_record_len;) {
-            meas_record_lst_t const record_item = data_item.meas_record_lst[j];
-            
-            if(meas_type.type == NAME_MEAS_TYPE) {
-                // Serving SINR 파싱
-                if(isMeasNameContains((char*)meas_type.name.buf, "L3servingSINR3gpp_cell_")) {
-                    // 이전 UE 정보가 있으면 출력
-                    if(current_ue != -1 && neighbor_count > 0) {
-                        log_both("╰─ Neighbors: ");
-                        for(int k = 0; k < neighbor_count; k++) {
-                            log_both("Cell %d (%.2f dB)%s", 
-                                   neighbors[k].neighbor_id, 
-                                   neighbors[k].sinr,
-                                   k < neighbor_count-1 ? ", " : "\n");
-                        }
-                        neighbor_count = 0;
-                    }
-                    
-                    struct InfoObj info = parseServingMsg((char*)meas_type.name.buf);
-                    serving_sinr = record_item.real_val;
-                    current_ue = info.ueID;
-                    current_cell = info.cellID;
-                    
-                    log_both("\n📱 UE %d - Cell %d: %.2f dB\n", 
-                           info.ueID, info.cellID, serving_sinr);
-                           
-                } else if(isMeasNameContains((char*)meas_type.name.buf, "L3neighSINRListOf_UEID_")) {
-                    // Neighbor SINR 파싱
-                    struct InfoObj info = parseNeighMsg((char*)meas_type.name.buf);
-                    
-                    if(info.ueID == current_ue && neighbor_count < 20) {
-                        meas_record_lst_t const sinr = record_item;
-                        meas_record_lst_t const NeighbourID = data_item.meas_record_lst[j + 1];
-                        
-                        neighbors[neighbor_count].neighbor_id = NeighbourID.int_val;
-                        neighbors[neighbor_count].sinr = sinr.real_val;
-                        neighbor_count++;
-                    }
-                    j += 2;
-                    continue;
-                }
-            }
-            j++;
-        }
-    }
-    
-    // 마지막 UE의 neighbor 정보 출력
+static void log_neighbors(void)
+{
     if(current_ue != -1 && neighbor_count > 0) {
         log_both("╰─ Neighbors: ");
         for(int k = 0; k < neighbor_count; k++) {
@@ -330,8 +152,12 @@ static void log_kpm_measurements(kpm_ind_msg_format_1_t const* msg_frm_1)
                    k < neighbor_count-1 ? ", " : "\n");
         }
     }
+    current_ue = -1;
+    neighbor_count = 0;
 }
 
+static kpm_ingest_t ingest;   // 측정 이름 캐시 + 파서 상태
+
 // Orange 스타일 UE ID 로깅
 static void log_ue_id_e2sm(ue_id_e2sm_t const ue_id_e2sm) {
     switch (ue_id_e2sm.type) {
@@ -373,13 +199,8 @@ static void log_ue_id_e2sm(ue_id_e2sm_t const ue_id_e2sm) {
 // Orange 스타일 메인 콜백 함수
 static void sm_cb_kpm(sm_ag_if_rd_t const* rd)
 {
-    assert(rd != NULL);
-    assert(rd->type == INDICATION_MSG_AGENT_IF_ANS_V0);
-    assert(rd->ind.type == KPM_STATS_V3_0);
-
-    // Orange 스타일 데이터 추출
-    kpm_ind_data_t const* ind = &rd->ind.kpm.ind;
-    kpm_ind_msg_format_3_t const* msg_frm_3 = &ind->msg.frm_3;
+    kpm_ind_msg_format_3_t const* msg_frm_3 = kpm_ingest_msg(rd);
+    uint64_t const collect_start_time = kpm_ingest_collect_start_time(rd);
 
     {
         lock_guard(&mtx);
@@ -388,8 +209,8 @@ static void sm_cb_kpm(sm_ag_if_rd_t const* rd)
 
         // Orange 스타일 UE별 측정값 처리
         for (size_t i = 0; i < msg_frm_3->ue_meas_report_lst_len; i++) {
-            // Orange 스타일 측정값 로그
-            log_kpm_measurements(&msg_frm_3->meas_report_per_ue[i].ind_msg_format_1);
+            kpm_ingest_ue_report(&ingest, &msg_frm_3->meas_report_per_ue[i].ind_msg_format_1, collect_start_time);
+            log_neighbors();
         }
         
         log_both("\n");
@@ -398,61 +219,20 @@ static void sm_cb_kpm(sm_ag_if_rd_t const* rd)
 
 
 
-// Orange 스타일 KPM subscription 생성
-static kpm_sub_data_t gen_kpm_subs(kpm_ran_function_def_t const* ran_func)
-{
-    assert(ran_func != NULL);
-    assert(ran_func->ric_event_trigger_style_list != NULL);
-
-    kpm_sub_data_t kpm_sub = {0};
-
-    // Event Trigger 설정
-    assert(ran_func->ric_event_trigger_style_list[0].format_type == FORMAT_1_RIC_EVENT_TRIGGER);
-    kpm_sub.ev_trg_def.type = FORMAT_1_RIC_EVENT_TRIGGER;
-    kpm_sub.ev_trg_def.kpm_ric_event_trigger_format_1.report_period_ms = period_ms;
-
-    // Action Definition - RAN function의 report style 사용
-    kpm_sub.sz_ad = 1;
-    kpm_sub.ad = calloc(kpm_sub.sz_ad, sizeof(kpm_act_def_t));
-    assert(kpm_sub.ad != NULL && "Memory exhausted");
-
-    // Orange처럼 report style에서 가져오기
-    ric_report_style_item_t* const report_item = &ran_func->ric_report_style_list[0];
-    
-    // Report Style 4 사용 (matching condition 포함)
-    if(report_item->act_def_format_type == FORMAT_4_ACTION_DEFINITION) {
-        kpm_sub.ad[0].type = FORMAT_4_ACTION_DEFINITION;
-        
-        // Matching condition 설정
-        kpm_sub.ad[0].frm_4.matching_cond_lst_len = 1;
-        kpm_sub.ad[0].frm_4.matching_cond_lst = calloc(1, sizeof(matching_condition_format_4_lst_t));
-        
-        // Filter 설정
-        test_cond_type_e const type = IsStat_TEST_COND_TYPE;
-        test_cond_e const condition = LESSTHAN_TEST_COND;
-        int const value = 40;
-        kpm_sub.ad[0].frm_4.matching_cond_lst[0].test_info_lst = 
-            filter_predicate(type, condition, value);
-        
-        // Action Definition Format 1
-        kpm_sub.ad[0].frm_4.action_def_format_1 = fill_act_def_frm_1(report_item);
-    }
-
-    return kpm_sub;
-}
-
 int main(int argc, char *argv[]) 
 {
     //log_both("🎯 === KPM Monitor xApp (Orange 기반) ===\n");
     //log_both("📡 100ms 주기로 RIC Indication 메시지 수신 및 출력\n");
     //log_both("🔥 SINR, Throughput, PRB 사용률 등 실시간 모니터링\n\n");
     
+    xlog_init();
+
     // Signal handler 설정
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
     // 로그 파일 열기
-    log_file = fopen("xapp_log.txt", "w");
+    log_file = xlog_open("xapp_log.txt");
     if (log_file == NULL) {
         log_both("⚠️  Warning: Could not create log file, output will be console only\n");
         log_to_file = false;
@@ -475,28 +255,10 @@ int main(int argc, char *argv[])
     pthread_mutexattr_t attr = {0};
     int rc = pthread_mutex_init(&mtx, &attr);
     assert(rc == 0);
+    kpm_ingest_init(&ingest, on_kpm_sample, NULL);
 
     // Orange 스타일 KPM subscription
-    sm_ans_xapp_t* hndl = calloc(nodes.len, sizeof(sm_ans_xapp_t));
-    assert(hndl != NULL);
-
-    int const KPM_ran_function = 2;
-    for (size_t i = 0; i < nodes.len; ++i) {
-        e2_node_connected_xapp_t* n = &nodes.n[i];
-        size_t const idx = find_sm_idx(n->rf, n->len_rf, eq_sm, KPM_ran_function);
-        
-        if (idx < n->len_rf && 
-            n->rf[idx].defn.type == KPM_RAN_FUNC_DEF_E &&
-            n->rf[idx].defn.kpm.ric_report_style_list != NULL) {
-            
-            //log_both("🔧 Setting up KPM subscription for node %zu...\n", i);
-            kpm_sub_data_t kpm_sub = gen_kpm_subs(&n->rf[idx].defn.kpm);
-            hndl[i] = report_sm_xapp_api(&n->id, KPM_ran_function, &kpm_sub, sm_cb_kpm);
-            assert(hndl[i].success == true);
-            free_kpm_sub_data(&kpm_sub);
-            //log_both("✅ KPM subscription successful for node %zu!\n", i);
-        }
-    }
+    sm_ans_xapp_t* hndl = kpm_ingest_subscribe(&nodes, period_ms, kpm_filter, sm_cb_kpm);
 
     //log_both("\n🎯 === KPM 실시간 모니터링 시작 ===\n");
     //log_both("📊 100ms마다 RIC Indication 메시지 수신 중...\n");
@@ -517,20 +279,17 @@ int main(int argc, char *argv[])
     // Orange 스타일 cleanup
     //log_both("\n🛑 [INFO] Stopping KPM monitor...\n");
     // cleanup 부분에 추가
-    if (log_file != NULL) {
-        fclose(log_file);
-        //log_both("📝 Log file closed: xapp_log.txt\n");
-    }
-
-    for (int i = 0; i < nodes.len; ++i) {
-        if (hndl[i].success == true)
-            rm_report_sm_xapp_api(hndl[i].u.handle);
-    }
-    free(hndl);
+    kpm_ingest_unsubscribe(hndl, nodes.len);
 
     while(try_stop_xapp_api() == false)
         usleep(1000);
 
+    xlog_close(log_file);   // 콜백이 모두 끝난 뒤
+    log_file = NULL;
+    xlog_shutdown();
+
+    kpm_ingest_free(&ingest);
+
     rc = pthread_mutex_destroy(&mtx);
     assert(rc == 0);
 
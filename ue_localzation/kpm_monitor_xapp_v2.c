@@ -17,16 +17,14 @@
 #include <unistd.h>
 #include <signal.h>
 #include <stdarg.h>
+#include "cell_map.h"
+#include "ue_table.h"
+#include "kpm_ingest.h"
+#include "xapp_logger.h"
 
-// Cell Position Structure
-typedef struct {
-    uint16_t cellID;
-    double x;
-    double y;
-} cell_position_t;
 
 // Cell Position Mapping (ns-O-RAN 시뮬레이터 기준)
-static cell_position_t cell_positions[] = {
+static cell_map_entry_t cell_positions[] = {
     {2, 800.0, 800.0},         // gNB 1 중앙 위치 (LTE eNB + mmWave gNB 공존)
     {3, 1200.0, 800.0},        // gNB 2 동쪽 (0도, 400m)
     {4, 1000.0, 1146.0},      // gNB 3 북동쪽 (60도, 400m)
@@ -36,101 +34,27 @@ static cell_position_t cell_positions[] = {
     {8, 1000.0, 453.0},       // gNB 7 남동쪽 (300도, 400m)
 };
 
-static size_t num_cells = sizeof(cell_positions) / sizeof(cell_position_t);
-
 // Global variables
 static pthread_mutex_t mtx;
 static bool monitoring_active = true;
 static uint64_t const period_ms = 100;  
+static kpm_ingest_filter_t const kpm_filter = { GREATERTHAN_TEST_COND, 2 };   // neighbor cell 3개 이상인 경우에만
 static int indication_counter = 0;
-static FILE *log_file = NULL;
+static xlog_sink_t *log_file = NULL;
 static bool log_to_file = true;
 
 // Cell position 조회 함수
-static cell_position_t* get_cell_position(uint16_t cellID) {
-    for (size_t i = 0; i < num_cells; i++) {
-        if (cell_positions[i].cellID == cellID) {
-            return &cell_positions[i];
-        }
-    }
-    return NULL; // Cell not found
-}
-
-// Orange 스타일 KPM Label 생성
-static label_info_lst_t fill_kpm_label(void)
-{
-    label_info_lst_t label_item = {0};
-    label_item.noLabel = ecalloc(1, sizeof(enum_value_e));
-    *label_item.noLabel = TRUE_ENUM_VALUE;
-    return label_item;
-}
-
-static test_info_lst_t filter_predicate(test_cond_type_e type, test_cond_e cond, int value)
-{
-    test_info_lst_t dst = {0};
-
-    dst.test_cond_type = type;
-    dst.IsStat = TRUE_TEST_COND_TYPE;
-
-    dst.test_cond = calloc(1, sizeof(test_cond_e));
-    assert(dst.test_cond != NULL && "Memory allocation failed for test_cond");
-    *dst.test_cond = cond;
-
-    dst.test_cond_value = calloc(1, sizeof(test_cond_value_t));
-    assert(dst.test_cond_value != NULL && "Memory allocation failed for test_cond_value");
-    dst.test_cond_value->type = INTEGER_TEST_COND_VALUE;
-
-    int64_t *int_value = calloc(1, sizeof(int64_t));
-    assert(int_value != NULL && "Memory allocation failed for int_value");
-    *int_value = value; 
-    dst.test_cond_value->int_value = int_value;
-    return dst;
-}
-
-static kpm_act_def_format_1_t fill_act_def_frm_1(ric_report_style_item_t const* report_item)
-{
-    assert(report_item != NULL);
-
-    kpm_act_def_format_1_t ad_frm_1 = {0};
-
-    size_t const sz = report_item->meas_info_for_action_lst_len;
-
-    ad_frm_1.meas_info_lst_len = sz;
-    ad_frm_1.meas_info_lst = calloc(sz, sizeof(meas_info_format_1_lst_t));
-    assert(ad_frm_1.meas_info_lst != NULL && "Memory exhausted");
-
-    for (size_t i = 0; i < sz; i++) {
-        meas_info_format_1_lst_t* meas_item = &ad_frm_1.meas_info_lst[i];
-        meas_item->meas_type.type = NAME_MEAS_TYPE;
-        meas_item->meas_type.name = copy_byte_array(report_item->meas_info_for_action_lst[i].name);
-
-        meas_item->label_info_lst_len = 1;
-        meas_item->label_info_lst = ecalloc(1, sizeof(label_info_lst_t));
-        meas_item->label_info_lst[0] = fill_kpm_label();
-    }
-
-    ad_frm_1.gran_period_ms = period_ms;
-    ad_frm_1.cell_global_id = NULL;
-
-#if defined KPM_V2_03 || defined KPM_V3_00
-    ad_frm_1.meas_bin_range_info_lst_len = 0;
-    ad_frm_1.meas_bin_info_lst = NULL;
-#endif
-
-    return ad_frm_1;
-}
+// 시나리오의 cell map 이 있으면 그것을, 없으면 위의 7-cell 테이블을 사용
+static cell_map_index_t cell_map;
 
 static void log_both(const char* format, ...) {
     va_list args1, args2;
     va_start(args1, format);
     va_copy(args2, args1);
     
-    vprintf(format, args1);
+    xlog_vprintf(xlog_console(), format, args1);
     
-    if (log_file != NULL) {
-        vfprintf(log_file, format, args2);
-        fflush(log_file);
-    }
+    xlog_vprintf(log_file, format, args2);
     
     va_end(args1);
     va_end(args2);
@@ -142,62 +66,13 @@ static void signal_handler(int signal) {
     monitoring_active = false;
 }
 
-// Orange 스타일 helper 함수들
-static bool eq_sm(sm_ran_function_t const* elem, int const id) {
-    return elem->id == id;
-}
-
-static size_t find_sm_idx(sm_ran_function_t* rf, size_t sz, 
-                         bool (*f)(sm_ran_function_t const*, int const), int const id) {
-    for (size_t i = 0; i < sz; i++) {
-        if (f(&rf[i], id))
-            return i;
-    }
-    assert(0 != 0 && "SM ID could not be found in the RAN Function List");
-}
-
-// Orange 스타일 측정값 파싱 구조체
-struct InfoObj { 
-    uint16_t cellID;
-    uint16_t ueID;
-};
-
-// Orange 스타일 문자열 파싱 함수들
-static struct InfoObj parseServingMsg(const char* msg) {
-    struct InfoObj info;
-    int ret = sscanf(msg, "L3servingSINR3gpp_cell_%hd_UEID_%hd", &info.cellID, &info.ueID);
-    
-    if (ret == 2)
-        return info;
-    
-    info.cellID = -1;
-    info.ueID = -1;
-    return info;
-}
-
-static struct InfoObj parseNeighMsg(const char* msg) {
-    struct InfoObj info;
-    int ret = sscanf(msg, "L3neighSINRListOf_UEID_%hd_of_Cell_%hd", &info.ueID, &info.cellID);
-    
-    if (ret == 2)
-        return info;
-    
-    info.ueID = -1;
-    info.cellID = -1;
-    return info;
-}
-
-static bool isMeasNameContains(const char* meas_name, const char* name) {
-    return strncmp(meas_name, name, strlen(name)) == 0;
-}
-
 // SINR 데이터 구조체 (neighbor와 serving 정보 저장)
 typedef struct {
     uint64_t timestamp;
     uint16_t ueID;
     uint16_t servingCellID;
     double servingSINR;
-    cell_position_t* servingPos;
+    cell_map_entry_t const* servingPos;
     
     // Neighbor 정보들
     struct {
@@ -208,8 +83,7 @@ typedef struct {
 } sinr_measurement_t;
 
 // 측정값을 저장할 임시 구조체 배열
-static sinr_measurement_t measurements[100]; // UE별 최대 100개
-static size_t num_measurements = 0;
+static ue_table_t measurements;   // ueID -> sinr_measurement_t (UE 수 제한 없음)
 
 // neighbor SINR 정렬을 위한 비교 함수
 static int compare_neighbors_by_sinr(const void* a, const void* b) {
@@ -226,8 +100,8 @@ static int compare_neighbors_by_sinr(const void* a, const void* b) {
 
 // 새로운 형식으로 SINR 데이터 출력 (한 줄에 모든 정보)
 static void output_sinr_data_oneline(void) {
-    for (size_t i = 0; i < num_measurements; i++) {
-        sinr_measurement_t* m = &measurements[i];
+    for (size_t i = 0; i < ue_table_count(&measurements); i++) {
+        sinr_measurement_t* m = ue_table_at(&measurements, i);
         
         // ✅ neighbor들을 SINR 좋은 순으로 정렬
         if (m->num_neighbors > 1) {
@@ -260,104 +134,40 @@ static void output_sinr_data_oneline(void) {
         );
     }
     
-    // 측정값 배열 초기화
-    num_measurements = 0;
+    // 측정값 초기화 (저장소는 재사용)
+    ue_table_clear(&measurements);
 }
 
-// 간소화된 KPM 측정값 로깅 함수
-static void log_kpm_measurements(kpm_ind_msg_format_1_t const* msg_frm_1, uint64_t timestamp)
+// kpm_ingest 샘플 콜백 (mtx 안): serving 은 UE 측정값을 새로 시작, neighbor 는 그 UE 에 추가
+static void on_kpm_sample(kpm_sample_t const* s, void* ctx)
 {
-    assert(msg_frm_1->meas_info_lst_len > 0);
-    
-    if(msg_frm_1->meas_info_lst_len != msg_frm_1->meas_data_lst_len) {
+    (void)ctx;
+    if (s->type == KPM_SAMPLE_SERVING) {
+        sinr_measurement_t* m = ue_table_get_or_create(&measurements, s->ueID, NULL);
+        if (m != NULL) {
+            m->timestamp = s->timestamp / 1000;
+            m->ueID = s->ueID;
+            m->servingCellID = s->cellID;
+            m->servingSINR = s->sinr;
+            m->servingPos = cell_map_find(&cell_map, s->cellID);
+            m->num_neighbors = 0;
+        }
         return;
     }
 
-    uint64_t timestamp_ms = timestamp / 1000;
-
-    // 먼저 serving 정보를 수집
-    for(size_t i = 0; i < msg_frm_1->meas_info_lst_len; i++) {
-        meas_type_t const meas_type = msg_frm_1->meas_info_lst[i].meas_type;
-        meas_data_lst_t const data_item = msg_frm_1->meas_data_lst[i];
-        
-        if(meas_type.type == NAME_MEAS_TYPE) {
-            // Serving SINR 처리
-            if(isMeasNameContains((char*)meas_type.name.buf, "L3servingSINR3gpp_cell_")) {
-                struct InfoObj info = parseServingMsg((char*)meas_type.name.buf);
-                
-                if(info.cellID != UINT16_MAX && info.ueID != UINT16_MAX && 
-                   data_item.meas_record_len > 0) {
-                    
-                    meas_record_lst_t const record_item = data_item.meas_record_lst[0];
-                    
-                    if(record_item.value == REAL_MEAS_VALUE || record_item.value == INTEGER_MEAS_VALUE) {
-                        // 새로운 측정값 추가
-                        if (num_measurements < 100) {
-                            sinr_measurement_t* m = &measurements[num_measurements];
-                            m->timestamp = timestamp_ms;
-                            m->ueID = info.ueID;
-                            m->servingCellID = info.cellID;
-                            m->servingSINR = (record_item.value == REAL_MEAS_VALUE) ? 
-                                           record_item.real_val : (double)record_item.int_val;
-                            m->servingPos = get_cell_position(info.cellID);
-                            m->num_neighbors = 0;
-                            
-                            num_measurements++;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    // 다음으로 neighbor 정보를 수집하여 기존 측정값에 추가
-    for(size_t i = 0; i < msg_frm_1->meas_info_lst_len; i++) {
-        meas_type_t const meas_type = msg_frm_1->meas_info_lst[i].meas_type;
-        meas_data_lst_t const data_item = msg_frm_1->meas_data_lst[i];
-        
-        if(meas_type.type == NAME_MEAS_TYPE) {
-            // Neighbor SINR 처리
-            if(isMeasNameContains((char*)meas_type.name.buf, "L3neighSINRListOf_UEID_")) {
-                struct InfoObj info = parseNeighMsg((char*)meas_type.name.buf);
-                
-                if(info.cellID != UINT16_MAX && info.ueID != UINT16_MAX) {
-                    // 해당 UE의 측정값 찾기
-                    for (size_t m_idx = 0; m_idx < num_measurements; m_idx++) {
-                        if (measurements[m_idx].ueID == info.ueID) {
-                            // neighbor 데이터가 2개씩 온다 (SINR, NeighborID)
-                            for(size_t j = 0; j + 1 < data_item.meas_record_len; j += 2) {
-                                meas_record_lst_t const sinr = data_item.meas_record_lst[j];
-                                meas_record_lst_t const neighID = data_item.meas_record_lst[j + 1];
-                                
-                                if(sinr.value == REAL_MEAS_VALUE && neighID.value == INTEGER_MEAS_VALUE) {
-                                    if (measurements[m_idx].num_neighbors < 10) {
-                                        size_t n_idx = measurements[m_idx].num_neighbors;
-                                        measurements[m_idx].neighbors[n_idx].neighCellID = neighID.int_val;
-                                        measurements[m_idx].neighbors[n_idx].neighSINR = sinr.real_val;
-                                        measurements[m_idx].num_neighbors++;
-                                    }
-                                }
-                            }
-                            break;
-                        }
-                    }
-                }
-            }
-        }
+    sinr_measurement_t* m = ue_table_find(&measurements, s->ueID);
+    if (m != NULL && m->num_neighbors < 10) {
+        m->neighbors[m->num_neighbors].neighCellID = s->cellID;
+        m->neighbors[m->num_neighbors].neighSINR = s->sinr;
+        m->num_neighbors++;
     }
 }
 
+static kpm_ingest_t ingest;   // 측정 이름 캐시 + 파서 상태 (콜백은 mtx 안에서 실행)
+
 // Orange 스타일 메인 콜백 함수 (새로운 출력 형식)
 static void sm_cb_kpm(sm_ag_if_rd_t const* rd)
 {
-    assert(rd != NULL);
-    assert(rd->type == INDICATION_MSG_AGENT_IF_ANS_V0);
-    assert(rd->ind.type == KPM_STATS_V3_0);
-
-    kpm_ind_data_t const* ind = &rd->ind.kpm.ind;
-    kpm_ric_ind_hdr_format_1_t const* hdr_frm_1 = &ind->hdr.kpm_ric_ind_hdr_format_1;
-    kpm_ind_msg_format_3_t const* msg_frm_3 = &ind->msg.frm_3;
-
     {
         lock_guard(&mtx);
         
@@ -369,59 +179,25 @@ static void sm_cb_kpm(sm_ag_if_rd_t const* rd)
         indication_counter++;
 
         // UE별 측정값 처리
-        for (size_t i = 0; i < msg_frm_3->ue_meas_report_lst_len; i++) {
-            log_kpm_measurements(&msg_frm_3->meas_report_per_ue[i].ind_msg_format_1, 
-                                hdr_frm_1->collectStartTime);
-        }
+        kpm_ingest_indication(&ingest, rd);
         
         // 수집된 데이터를 새로운 형식(한 줄)으로 출력
         output_sinr_data_oneline();
     }
 }
 
-// Orange 스타일 KPM subscription 생성
-static kpm_sub_data_t gen_kpm_subs(kpm_ran_function_def_t const* ran_func)
-{
-    assert(ran_func != NULL);
-    assert(ran_func->ric_event_trigger_style_list != NULL);
-
-    kpm_sub_data_t kpm_sub = {0};
-
-    assert(ran_func->ric_event_trigger_style_list[0].format_type == FORMAT_1_RIC_EVENT_TRIGGER);
-    kpm_sub.ev_trg_def.type = FORMAT_1_RIC_EVENT_TRIGGER;
-    kpm_sub.ev_trg_def.kpm_ric_event_trigger_format_1.report_period_ms = period_ms;
-
-    kpm_sub.sz_ad = 1;
-    kpm_sub.ad = calloc(kpm_sub.sz_ad, sizeof(kpm_act_def_t));
-    assert(kpm_sub.ad != NULL && "Memory exhausted");
-
-    ric_report_style_item_t* const report_item = &ran_func->ric_report_style_list[0];
-    
-    if(report_item->act_def_format_type == FORMAT_4_ACTION_DEFINITION) {
-        kpm_sub.ad[0].type = FORMAT_4_ACTION_DEFINITION;
-        
-        kpm_sub.ad[0].frm_4.matching_cond_lst_len = 1;
-        kpm_sub.ad[0].frm_4.matching_cond_lst = calloc(1, sizeof(matching_condition_format_4_lst_t));
-        
-        test_cond_type_e const type = IsStat_TEST_COND_TYPE;
-        test_cond_e const condition = GREATERTHAN_TEST_COND;
-        int const value = 2; // neighbor cell 3개 이상인 경우에만
-        kpm_sub.ad[0].frm_4.matching_cond_lst[0].test_info_lst = 
-            filter_predicate(type, condition, value);
-        
-        kpm_sub.ad[0].frm_4.action_def_format_1 = fill_act_def_frm_1(report_item);
-    }
-
-    return kpm_sub;
-}
-
 int main(int argc, char *argv[]) 
 {
+    xlog_init();
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
+    cell_map_load_index(&cell_map, cell_positions, sizeof(cell_positions) / sizeof(cell_positions[0]));
+    ue_table_init(&measurements, sizeof(sinr_measurement_t));
+    kpm_ingest_init(&ingest, on_kpm_sample, NULL);
+
     // CSV 형식으로 로그 파일 열기
-    log_file = fopen("sinr_ml_dataset.csv", "w");
+    log_file = xlog_open("sinr_ml_dataset.csv");
     if (log_file == NULL) {
         log_to_file = false;
     }
@@ -438,24 +214,7 @@ int main(int argc, char *argv[])
     int rc = pthread_mutex_init(&mtx, &attr);
     assert(rc == 0);
 
-    sm_ans_xapp_t* hndl = calloc(nodes.len, sizeof(sm_ans_xapp_t));
-    assert(hndl != NULL);
-
-    int const KPM_ran_function = 2;
-    for (size_t i = 0; i < nodes.len; ++i) {
-        e2_node_connected_xapp_t* n = &nodes.n[i];
-        size_t const idx = find_sm_idx(n->rf, n->len_rf, eq_sm, KPM_ran_function);
-        
-        if (idx < n->len_rf && 
-            n->rf[idx].defn.type == KPM_RAN_FUNC_DEF_E &&
-            n->rf[idx].defn.kpm.ric_report_style_list != NULL) {
-            
-            kpm_sub_data_t kpm_sub = gen_kpm_subs(&n->rf[idx].defn.kpm);
-            hndl[i] = report_sm_xapp_api(&n->id, KPM_ran_function, &kpm_sub, sm_cb_kpm);
-            assert(hndl[i].success == true);
-            free_kpm_sub_data(&kpm_sub);
-        }
-    }
+    sm_ans_xapp_t* hndl = kpm_ingest_subscribe(&nodes, period_ms, kpm_filter, sm_cb_kpm);
 
     // 메인 루프
     while(monitoring_active) {
@@ -463,19 +222,18 @@ int main(int argc, char *argv[])
     }
 
     // cleanup
-    if (log_file != NULL) {
-        fclose(log_file);
-    }
-
-    for (int i = 0; i < nodes.len; ++i) {
-        if (hndl[i].success == true)
-            rm_report_sm_xapp_api(hndl[i].u.handle);
-    }
-    free(hndl);
+    kpm_ingest_unsubscribe(hndl, nodes.len);
 
     while(try_stop_xapp_api() == false)
         usleep(1000);
 
+    xlog_close(log_file);   // 콜백이 모두 끝난 뒤
+    log_file = NULL;
+    xlog_shutdown();
+
+    ue_table_free(&measurements);
+    kpm_ingest_free(&ingest);
+
     rc = pthread_mutex_destroy(&mtx);
     assert(rc == 0);
 
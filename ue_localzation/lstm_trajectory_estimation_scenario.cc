@@ -34,8 +34,14 @@
 #include <chrono>
 #include <cmath>
 #include <fstream>
+#include <unordered_map>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <numeric>
 #include "ns3/isotropic-antenna-model.h"
 #include "ns3/mmwave-bearer-stats-connector.h"
+#include "ns3/sionna-path-gain-model.h"
 
 using namespace ns3;
 using namespace mmwave;
@@ -46,9 +52,11 @@ std::map<uint16_t, std::set<uint64_t>> imsi_list;
 std::map<uint16_t, Ptr<Node>> cellid_node;
 std::map<uint32_t, uint16_t> ue_cellid_usinghandover;
 std::map<uint64_t, uint32_t> ueimsi_nodeid;
-int ue_assoc_list[100] = {0}; // Increased for 56 UEs
+std::unordered_map<uint64_t, uint16_t> ue_serving_cell; // imsi -> serving mmWave cell, from the RRC traces
+std::set<uint16_t> mmwave_cell_ids;
 double maxXAxis;
 double maxYAxis;
+std::ofstream ue_position_file; // kept open for the whole run
 
 NS_LOG_COMPONENT_DEFINE ("PositionPredictionScenario");
 
@@ -91,53 +99,60 @@ PrintGnuplottableUeListToFile(std::string filename) {
 }
 
 void
-PrintGnuplottableEnbListToFile(uint64_t m_startTime) {
+PrintGnuplottableEnbListToFile(NetDeviceContainer lteEnbDevs, NetDeviceContainer mmWaveEnbDevs,
+                               uint64_t m_startTime) {
+    // base stations do not move, their positions are written once
     uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now().GetMilliSeconds();
     
     std::string filename1 = "enbs.txt";
     std::string filename2 = "gnbs.txt";
     
-    for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
-        Ptr<Node> node = *it;
-        int nDevs = node->GetNDevices();
-        for (int j = 0; j < nDevs; j++) {
-            Ptr<LteEnbNetDevice> enbdev = node->GetDevice(j)->GetObject<LteEnbNetDevice>();
-            Ptr<MmWaveEnbNetDevice> mmdev = node->GetDevice(j)->GetObject<MmWaveEnbNetDevice>();
-            if (enbdev) {
-                Vector pos = node->GetObject<MobilityModel>()->GetPosition();
-                std::ofstream outFile1;
-                outFile1.open(filename1.c_str(), std::ios_base::out | std::ios_base::app);
-                if (!outFile1.is_open()) {
-                    NS_LOG_ERROR("Can't open file " << filename1);
-                    return;
-                }
-                // Simplified output format (removed energy data)
-                outFile1 << timestamp << "," << enbdev->GetCellId() << "," << pos.x << "," << pos.y << ","
-                         << m_startTime << std::endl;
-                outFile1.close();
-            } else if (mmdev) {
-                Vector pos = node->GetObject<MobilityModel>()->GetPosition();
-                std::ofstream outFile2;
-                outFile2.open(filename2.c_str(), std::ios_base::out | std::ios_base::app);
-                if (!outFile2.is_open()) {
-                    NS_LOG_ERROR("Can't open file " << filename2);
-                    return;
-                }
-                
-                // Track UE associations for position prediction
-                auto ueMap = mmdev->GetUeMap();
-                for (const auto &ue: ueMap) {
-                    uint64_t imsi_assoc = ue.second->GetImsi();
-                    ue_assoc_list[imsi_assoc - 1] = mmdev->GetCellId();
-                }
-                
-                uint16_t cell_id = mmdev->GetCellId();
-                // Simplified output format (removed energy data)
-                outFile2 << timestamp << "," << cell_id << "," << pos.x << "," << pos.y << ","
-                         << m_startTime << std::endl;
-                outFile2.close();
-            }
-        }
+    std::ofstream outFile1;
+    outFile1.open(filename1.c_str(), std::ios_base::out | std::ios_base::app);
+    if (!outFile1.is_open()) {
+        NS_LOG_ERROR("Can't open file " << filename1);
+        return;
+    }
+    for (uint32_t i = 0; i < lteEnbDevs.GetN(); i++) {
+        Ptr<LteEnbNetDevice> enbdev = DynamicCast<LteEnbNetDevice>(lteEnbDevs.Get(i));
+        Vector pos = enbdev->GetNode()->GetObject<MobilityModel>()->GetPosition();
+        // Simplified output format (removed energy data)
+        outFile1 << timestamp << "," << enbdev->GetCellId() << "," << pos.x << "," << pos.y << ","
+                 << m_startTime << std::endl;
+    }
+    outFile1.close();
+
+    std::ofstream outFile2;
+    outFile2.open(filename2.c_str(), std::ios_base::out | std::ios_base::app);
+    if (!outFile2.is_open()) {
+        NS_LOG_ERROR("Can't open file " << filename2);
+        return;
+    }
+    for (uint32_t i = 0; i < mmWaveEnbDevs.GetN(); i++) {
+        Ptr<MmWaveEnbNetDevice> mmdev = DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(i));
+        Vector pos = mmdev->GetNode()->GetObject<MobilityModel>()->GetPosition();
+        outFile2 << timestamp << "," << mmdev->GetCellId() << "," << pos.x << "," << pos.y << ","
+                 << m_startTime << std::endl;
+    }
+    outFile2.close();
+}
+
+// ConnectionEstablished / HandoverEndOk: fired by the RRC of the new serving cell
+void
+NotifyUeServingCell(std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti) {
+    // the LTE eNB fires them too, only the mmWave cell is logged
+    if (mmwave_cell_ids.find(cellId) != mmwave_cell_ids.end()) {
+        ue_serving_cell[imsi] = cellId;
+    }
+}
+
+// UeContextRemoved: the source context is released after HandoverEndOk at the target,
+// so the entry is dropped only if it still points to this cell (RLF, release)
+void
+NotifyUeServingCellRemoved(std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti) {
+    auto it = ue_serving_cell.find(imsi);
+    if (it != ue_serving_cell.end() && it->second == cellId) {
+        ue_serving_cell.erase(it);
     }
 }
 
@@ -166,41 +181,272 @@ ClearFile(std::string Filename, uint64_t m_startTime) {
 }
 
 void
-PrintPosition(Ptr<Node> node, int iterator, std::string Filename, uint64_t m_startTime) {
+SampleUePositions(NodeContainer ueNodes, Time period, uint64_t m_startTime) {
+    // one event per period for all the UEs, rows go to the persistent position sink
     uint64_t timestamp = m_startTime + (uint64_t) Simulator::Now().GetMilliSeconds();
 
-    int imsi;
-    Ptr<Node> node1 = NodeList::GetNode(iterator);
-    int nDevs = node->GetNDevices();
-    std::string filename = Filename;
-    std::ofstream outFile;
-    for (int j = 0; j < nDevs; j++) {
-        Ptr<McUeNetDevice> mcuedev = node1->GetDevice(j)->GetObject<McUeNetDevice>();
-        if (mcuedev) {
-            imsi = int(mcuedev->GetImsi());
-            int serving_cell = ue_assoc_list[imsi - 1];
-            if (serving_cell == 0) {
-                serving_cell = 1;
+    std::ostringstream rows;
+    for (uint32_t u = 0; u < ueNodes.GetN(); u++) {
+        Ptr<Node> node = ueNodes.Get(u);
+        int nDevs = node->GetNDevices();
+        for (int j = 0; j < nDevs; j++) {
+            Ptr<McUeNetDevice> mcuedev = node->GetDevice(j)->GetObject<McUeNetDevice>();
+            if (mcuedev) {
+                int imsi = int(mcuedev->GetImsi());
+                auto servingIt = ue_serving_cell.find(imsi);
+                int serving_cell = servingIt != ue_serving_cell.end() ? servingIt->second : 1;
+                Vector position = node->GetObject<MobilityModel>()->GetPosition();
+                rows << timestamp << "," << imsi << "," << position.x << "," << position.y << ",mc,"
+                     << serving_cell << "," << m_startTime << "\n";
             }
-            Ptr<MobilityModel> model = node->GetObject<MobilityModel>();
-            Vector position = model->GetPosition();
-            
-            /*NS_LOG_UNCOND("Position of UE with IMSI " << imsi << " is " << model->GetPosition()
-                                                     << " at time "
-                                                     << Simulator::Now().GetSeconds()
-                                                     << ", UE connected to Cell: " << serving_cell);*/
-            
-            outFile.open(filename.c_str(), std::ios_base::out | std::ios_base::app);
-            if (!outFile.is_open()) {
-                NS_LOG_ERROR("Can't open file " << filename);
-                return;
+        }
+    }
+    // one flush per sample: a run that is killed keeps all the sampled rows
+    ue_position_file << rows.str();
+    ue_position_file.flush();
+
+    Simulator::Schedule(period, &SampleUePositions, ueNodes, period, m_startTime);
+}
+
+// gNB-gNB X2 mesh (lazy mode)
+Ptr<MmWaveHelper> x2_mmwave_helper;
+std::map<uint16_t, Ptr<Node>> x2_cell_node;
+std::set<std::pair<uint16_t, uint16_t>> x2_created_pairs;
+
+void
+AddX2InterfaceOnce(uint16_t cellA, uint16_t cellB) {
+    std::pair<uint16_t, uint16_t> key = std::minmax(cellA, cellB);
+    if (x2_created_pairs.find(key) != x2_created_pairs.end()) {
+        return;
+    }
+    auto itA = x2_cell_node.find(cellA);
+    auto itB = x2_cell_node.find(cellB);
+    if (itA == x2_cell_node.end() || itB == x2_cell_node.end()) {
+        // not a gNB pair (e.g. the LTE eNB), already connected at setup
+        return;
+    }
+    x2_created_pairs.insert(key);
+    x2_mmwave_helper->AddX2Interface(itA->second, itB->second);
+    NS_LOG_INFO("X2 created between cell " << cellA << " and cell " << cellB << " at "
+                                           << Simulator::Now().GetSeconds() << " s");
+}
+
+// Paced execution (speedFactor > 0): every pacingTick of simulated time the
+// simulator sleeps until the wall clock reaches simTime / speedFactor, so that
+// the E2 indications leave at a steady cadence. The lag is how late the
+// simulator is with respect to that schedule (0 when it had to wait).
+double pacing_speed_factor = 0;
+std::chrono::steady_clock::time_point pacing_wall_start;
+std::vector<double> pacing_lag_ms;
+std::ofstream pacing_file;
+
+void
+PaceSimulation(Time tick) {
+    if (pacing_lag_ms.empty()) {
+        pacing_wall_start = std::chrono::steady_clock::now();
+    }
+    double target = Simulator::Now().GetSeconds() / pacing_speed_factor;
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - pacing_wall_start).count();
+    double lag = wall - target;
+    if (lag < 0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(-lag));
+        lag = 0;
+    }
+    pacing_lag_ms.push_back(lag * 1000);
+    pacing_file << Simulator::Now().GetMilliSeconds() << "," << wall * 1000 << "," << lag * 1000 << "\n";
+
+    Simulator::Schedule(tick, &PaceSimulation, tick);
+}
+
+void
+PrintPacingSummary(double simTime, double wallSeconds, Time tick) {
+    if (pacing_lag_ms.empty()) {
+        return;
+    }
+    std::vector<double> lags = pacing_lag_ms;
+    std::sort(lags.begin(), lags.end());
+    double mean = std::accumulate(lags.begin(), lags.end(), 0.0) / lags.size();
+    double tickMs = tick.GetSeconds() * 1000 / pacing_speed_factor;
+    size_t late = lags.end() - std::upper_bound(lags.begin(), lags.end(), tickMs);
+    NS_LOG_UNCOND("=== Pacing (speedFactor " << pacing_speed_factor << ") ===");
+    NS_LOG_UNCOND("Lag mean " << mean << " ms, p95 " << lags[lags.size() * 95 / 100] << " ms, p99 "
+                  << lags[lags.size() * 99 / 100] << " ms, max " << lags.back() << " ms");
+    NS_LOG_UNCOND("Ticks later than one tick (" << tickMs << " ms): " << late << "/" << lags.size());
+    // when the lag keeps growing the achieved ratio is the sustainable speed factor
+    NS_LOG_UNCOND("Achieved sim/wall: " << simTime / wallSeconds
+                  << (lags.back() > 10 * tickMs ? " (not sustained, lower speedFactor)" : ""));
+}
+
+// Multi-ring hexagonal topology
+struct HexCell {
+    Vector position;
+    uint32_t site;     // 0 = centre site (co-located with the LTE eNB)
+    uint32_t sector;   // 0 for omni sites
+    double azimuth;    // boresight [deg], -1 for omni sites
+};
+
+// Sites of k rings around the centre, 1 + 3k(k+1) in total. Ring 1 keeps the
+// legacy order (0°, 60°, ..., 300°) so that the cell IDs of the 7-cell layout
+// do not change. Each site carries 1 or 3 cells (30°/150°/270° sectors).
+std::vector<HexCell>
+GenerateHexTopology(uint32_t rings, uint32_t sectors, double isd, Vector center) {
+    std::vector<Vector> sites;
+    sites.push_back(center);
+    Vector dir[6];
+    for (int d = 0; d < 6; ++d) {
+        double angle = (d * 60.0) * M_PI / 180.0;
+        dir[d] = Vector(isd * cos(angle), isd * sin(angle), 0);
+    }
+    for (uint32_t k = 1; k <= rings; ++k) {
+        // start on the 0° axis, then walk the 6 edges of the ring
+        Vector pos = Vector(center.x + k * dir[0].x, center.y + k * dir[0].y, center.z);
+        for (int edge = 0; edge < 6; ++edge) {
+            const Vector &step = dir[(edge + 2) % 6];
+            for (uint32_t s = 0; s < k; ++s) {
+                sites.push_back(pos);
+                pos = Vector(pos.x + step.x, pos.y + step.y, pos.z);
             }
+        }
+    }
+
+    std::vector<HexCell> cells;
+    cells.reserve(sites.size() * sectors);
+    for (uint32_t i = 0; i < sites.size(); ++i) {
+        for (uint32_t s = 0; s < sectors; ++s) {
+            double azimuth = (sectors == 1) ? -1.0 : 30.0 + 120.0 * s;
+            cells.push_back(HexCell{sites[i], i, s, azimuth});
+        }
+    }
+    return cells;
+}
+
+// Cell map read by the xApps at startup (CELL_MAP_FILE), one row per gNB cell.
+// With wrap-around the 6 translated copies of the layout are appended with
+// image = 1..6, for tools that need the distance to the closest image.
+void
+WriteCellMap(std::string filename, NetDeviceContainer mmWaveEnbDevs,
+             const std::vector<HexCell> &cells, bool wrapAround, uint32_t rings, double isd) {
+    std::ofstream outFile;
+    outFile.open(filename.c_str(), std::ios_base::out | std::ios_base::trunc);
+    if (!outFile.is_open()) {
+        NS_LOG_ERROR("Can't open file " << filename);
+        return;
+    }
+    outFile << "cellId,x,y,site,sector,azimuth,image" << std::endl;
+
+    std::vector<Vector> shifts;
+    shifts.push_back(Vector(0, 0, 0));
+    if (wrapAround) {
+        // translation of a (k+1, k) step in hex coordinates, |shift|^2 = (3k^2+3k+1) isd^2
+        double sx = isd * ((rings + 1) + 0.5 * rings);
+        double sy = isd * (rings * sqrt(3.0) / 2.0);
+        for (int d = 0; d < 6; ++d) {
+            double angle = (d * 60.0) * M_PI / 180.0;
+            shifts.push_back(Vector(sx * cos(angle) - sy * sin(angle),
+                                    sx * sin(angle) + sy * cos(angle), 0));
+        }
+    }
+
+    for (uint32_t image = 0; image < shifts.size(); ++image) {
+        for (uint32_t i = 0; i < mmWaveEnbDevs.GetN(); ++i) {
+            Ptr<MmWaveEnbNetDevice> mmdev = DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(i));
+            Vector pos = mmdev->GetNode()->GetObject<MobilityModel>()->GetPosition();
+            uint32_t site = (i < cells.size()) ? cells[i].site : i;
+            uint32_t sector = (i < cells.size()) ? cells[i].sector : 0;
+            double azimuth = (i < cells.size()) ? cells[i].azimuth : -1.0;
+            outFile << mmdev->GetCellId() << "," << pos.x + shifts[image].x << ","
+                    << pos.y + shifts[image].y << "," << site << "," << sector << ","
+                    << azimuth << "," << image << std::endl;
+        }
+    }
+    outFile.close();
+}
+
+// Handover statistics (proactive HO evaluation)
+std::map<uint64_t, Time> ho_start_time;      // imsi -> HandoverStart time at the source cell
+std::set<uint64_t> ho_proactive_imsi;        // UEs whose ongoing HO was triggered by a position hint
+uint32_t ho_count = 0;
+uint32_t ho_proactive_count = 0;
+uint32_t rlf_count = 0;
+double ho_interruption_sum_ms = 0;
+std::ofstream ho_stats_file;
+
+void
+NotifyHandoverStartEnb(std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti,
+                       uint16_t targetCellId) {
+    ho_start_time[imsi] = Simulator::Now();
+}
+
+void
+NotifyProactiveHandover(std::string context, uint64_t imsi, uint16_t sourceCellId,
+                        uint16_t targetCellId) {
+    ho_proactive_imsi.insert(imsi);
+    ho_proactive_count++;
+}
+
+void
+NotifyHandoverEndOkEnb(std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti) {
+    auto it = ho_start_time.find(imsi);
+    if (it == ho_start_time.end()) {
+        return;
+    }
+    double interruptionMs = (Simulator::Now() - it->second).GetSeconds() * 1000;
+    bool proactive = ho_proactive_imsi.erase(imsi) > 0;
+    ho_start_time.erase(it);
+    ho_count++;
+    ho_interruption_sum_ms += interruptionMs;
+    ho_stats_file << Simulator::Now().GetMilliSeconds() << ",ho," << imsi << "," << cellId << ","
+                  << interruptionMs << "," << proactive << std::endl;
+}
+
+void
+NotifyRadioLinkFailure(std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti) {
+    rlf_count++;
+    ho_start_time.erase(imsi);
+    ho_proactive_imsi.erase(imsi);
+    ho_stats_file << Simulator::Now().GetMilliSeconds() << ",rlf," << imsi << "," << cellId
+                  << ",," << std::endl;
+}
 
-            outFile << timestamp << "," << imsi << "," << position.x << "," << position.y << ",mc,"
-                    << serving_cell << "," << m_startTime << std::endl;
-            outFile.close();
+// In-simulator trajectory predictor (trajectoryHorizon > 0): constant-velocity
+// extrapolation of each UE, fed to its serving gNB as proactive HO hints, so that
+// runs with and without prediction (proactiveHo) can be compared without the xApp
+std::map<uint16_t, Ptr<MmWaveEnbNetDevice>> trajectory_cell_dev;
+
+void
+PredictUeTrajectories(NodeContainer ueNodes, Time period, Time horizon) {
+    std::vector<Vector> trajectory;
+    for (uint32_t u = 0; u < ueNodes.GetN(); u++) {
+        Ptr<Node> node = ueNodes.Get(u);
+        for (uint32_t j = 0; j < node->GetNDevices(); j++) {
+            Ptr<McUeNetDevice> mcuedev = node->GetDevice(j)->GetObject<McUeNetDevice>();
+            if (!mcuedev) {
+                continue;
+            }
+            uint64_t imsi = mcuedev->GetImsi();
+            auto servingIt = ue_serving_cell.find(imsi);
+            if (servingIt == ue_serving_cell.end()) {
+                break;
+            }
+            auto devIt = trajectory_cell_dev.find(servingIt->second);
+            if (devIt == trajectory_cell_dev.end()) {
+                break;
+            }
+            Ptr<MobilityModel> mobility = node->GetObject<MobilityModel>();
+            Vector position = mobility->GetPosition();
+            Vector velocity = mobility->GetVelocity();
+            trajectory.clear();
+            for (Time t = period; t <= horizon; t += period) {
+                double dt = t.GetSeconds();
+                trajectory.push_back(Vector(position.x + velocity.x * dt,
+                                            position.y + velocity.y * dt, position.z));
+            }
+            devIt->second->NotifyPredictedTrajectory(imsi, trajectory);
+            break;
         }
     }
+
+    Simulator::Schedule(period, &PredictUeTrajectories, ueNodes, period, horizon);
 }
 
 // Global Values for Position Prediction Scenario
@@ -238,6 +484,23 @@ static ns3::GlobalValue g_indicationPeriodicity("indicationPeriodicity",
                              "E2 Indication Periodicity reports (value in seconds)",
                              ns3::DoubleValue(0.1), ns3::MakeDoubleChecker<double>(0.01, 2.0));
 
+static ns3::GlobalValue g_positionSamplingPeriod("positionSamplingPeriod",
+                                   "Period [s] of the UE position (ue_position.txt) and BS logging",
+                                   ns3::DoubleValue(0.1),
+                                   ns3::MakeDoubleChecker<double>(0.001, 100.0));
+
+static ns3::GlobalValue g_trafficMode("trafficMode",
+                                   "DL traffic that keeps the UEs scheduled: cbr (200 B every 500 us), "
+                                   "keepalive (200 B every keepAliveInterval) or none. The SINR "
+                                   "reports do not need data, but with less traffic there is "
+                                   "less interference from the neighbour cells",
+                                   ns3::StringValue("cbr"), ns3::MakeStringChecker());
+
+static ns3::GlobalValue g_keepAliveInterval("keepAliveInterval",
+                                   "Packet interval [s] for trafficMode=keepalive",
+                                   ns3::DoubleValue(0.1),
+                                   ns3::MakeDoubleChecker<double>(0.001, 100.0));
+
 static ns3::GlobalValue g_simTime("simTime", "Simulation time in seconds", 
                                    ns3::DoubleValue(600), 
                                    ns3::MakeDoubleChecker<double>(0.1, 100000.0));
@@ -264,6 +527,26 @@ static ns3::GlobalValue g_enableE2FileLogging("enableE2FileLogging",
                               "If true, generate offline file logging instead of connecting to RIC",
                               ns3::BooleanValue(false), ns3::MakeBooleanChecker());
 
+static ns3::GlobalValue g_x2Mode("x2Mode",
+                              "gNB-gNB X2 interfaces: none (only LTE-gNB), full (all pairs), "
+                              "radius (pairs closer than x2Radius at setup, the others on their "
+                              "first HO), lazy (created on the first HO attempted between the pair)",
+                              ns3::StringValue("none"), ns3::MakeStringChecker());
+
+static ns3::GlobalValue g_x2Radius("x2Radius", "Max gNB distance [m] for x2Mode=radius",
+                                    ns3::DoubleValue(1000), ns3::MakeDoubleChecker<double>());
+
+static ns3::GlobalValue g_proactiveHo("proactiveHo",
+                              "If true, the predicted target cells sent by the xApp start the HO "
+                              "before the SINR crossover (false for the baseline run)",
+                              ns3::BooleanValue(true), ns3::MakeBooleanChecker());
+
+static ns3::GlobalValue g_trajectoryHorizon("trajectoryHorizon",
+                              "Horizon [s] of the constant-velocity trajectory of each UE fed to its "
+                              "serving gNB every indicationPeriodicity as a proactive HO hint "
+                              "(0: hints only from the xApp)",
+                              ns3::DoubleValue(0), ns3::MakeDoubleChecker<double>(0.0));
+
 static ns3::GlobalValue g_e2_func_id("KPM_E2functionID", "Function ID to subscribe",
                                       ns3::DoubleValue(2),
                                       ns3::MakeDoubleChecker<double>());
@@ -302,6 +585,50 @@ static ns3::GlobalValue interside_distance_value_cell ("IntersideDistanceCells",
                                                   ns3::DoubleValue (500),
                                                   ns3::MakeDoubleChecker<double> ());
 
+static ns3::GlobalValue g_speedFactor ("speedFactor",
+                                       "Simulated seconds per wall-clock second, to feed the "
+                                       "xApps at a steady cadence (0: as fast as possible)",
+                                       ns3::DoubleValue (0),
+                                       ns3::MakeDoubleChecker<double> (0));
+
+static ns3::GlobalValue g_pacingTick ("pacingTick",
+                                      "Simulated time [s] between two pacing checks",
+                                      ns3::DoubleValue (0.01),
+                                      ns3::MakeDoubleChecker<double> (0.001, 1.0));
+
+// Topology generator (hexRings = 0 keeps the single ring of N_MmWaveEnbNodes - 1 gNBs)
+static ns3::GlobalValue g_hexRings ("hexRings",
+                                    "Number of hexagonal rings of sites around the centre site, "
+                                    "1 + 3k(k+1) sites (0: legacy layout from N_MmWaveEnbNodes)",
+                                    ns3::UintegerValue (0),
+                                    ns3::MakeUintegerChecker<uint32_t> ());
+
+static ns3::GlobalValue g_hexSectors ("hexSectors", "Cells per site, 1 (omni) or 3 (sectors)",
+                                      ns3::UintegerValue (1),
+                                      ns3::MakeUintegerChecker<uint32_t> (1, 3));
+
+static ns3::GlobalValue g_fieldMargin ("fieldMargin",
+                                       "Margin [m] between the outer ring and the field border "
+                                       "when hexRings > 0",
+                                       ns3::DoubleValue (400),
+                                       ns3::MakeDoubleChecker<double> (0));
+
+static ns3::GlobalValue g_wrapAround ("wrapAround",
+                                      "If true, the 6 wrap-around images of the layout are "
+                                      "appended to the cell map",
+                                      ns3::BooleanValue (false), ns3::MakeBooleanChecker ());
+
+static ns3::GlobalValue g_pathGainMap ("pathGainMap",
+                                       "Sionna path gain grid (sionna-rt/export_path_gain.py) used "
+                                       "instead of the stochastic UMi pathloss and LOS model, empty "
+                                       "to keep the 3GPP models",
+                                       ns3::StringValue (""),
+                                       ns3::MakeStringChecker ());
+
+static ns3::GlobalValue g_cellMapFile ("cellMapFile", "Cell position map read by the xApps",
+                                       ns3::StringValue ("cell_map.txt"),
+                                       ns3::MakeStringChecker ());
+
 int
 main(int argc, char *argv[]) {
     LogComponentEnableAll(LOG_PREFIX_ALL);
@@ -338,6 +665,8 @@ main(int argc, char *argv[]) {
     std::string e2TermIp = stringValue.Get();
     GlobalValue::GetValueByName("enableE2FileLogging", booleanValue);
     bool enableE2FileLogging = booleanValue.Get();
+    GlobalValue::GetValueByName("proactiveHo", booleanValue);
+    bool proactiveHo = booleanValue.Get();
     GlobalValue::GetValueByName("KPM_E2functionID", doubleValue);
     double g_e2_func_id = doubleValue.Get();
     GlobalValue::GetValueByName("RC_E2functionID", doubleValue);
@@ -418,6 +747,7 @@ main(int argc, char *argv[]) {
 
     // 진섭 : 휴리스틱 핸드오버 활성화용 
     Config::SetDefault("ns3::LteEnbRrc::AllowAutonomousHoWithE2", BooleanValue(true));
+    Config::SetDefault("ns3::LteEnbRrc::EnableProactiveHo", BooleanValue(proactiveHo));
 
     Config::SetDefault("ns3::LteEnbRrc::OutageThreshold", DoubleValue(outageThreshold));
     Config::SetDefault("ns3::LteEnbRrc::SecondaryCellHandoverMode", StringValue(handoverMode));
@@ -443,19 +773,57 @@ main(int argc, char *argv[]) {
     Config::SetDefault("ns3::MmWavePhyMacCommon::CenterFreq", DoubleValue(centerFrequency));
 
     Ptr<MmWaveHelper> mmwaveHelper = CreateObject<MmWaveHelper>();
-    mmwaveHelper->SetPathlossModelType("ns3::ThreeGppUmiStreetCanyonPropagationLossModel");
-    mmwaveHelper->SetChannelConditionModelType("ns3::ThreeGppUmiStreetCanyonChannelConditionModel");
+    GlobalValue::GetValueByName("pathGainMap", stringValue);
+    std::string pathGainMap = stringValue.Get();
+    if (pathGainMap.empty()) {
+        mmwaveHelper->SetPathlossModelType("ns3::ThreeGppUmiStreetCanyonPropagationLossModel");
+        mmwaveHelper->SetChannelConditionModelType("ns3::ThreeGppUmiStreetCanyonChannelConditionModel");
+    } else {
+        // building-aware pathloss/LOS from the Sionna grid, 3GPP UMi fast fading on top
+        Config::SetDefault("ns3::SionnaPropagationLossModel::MapFile", StringValue(pathGainMap));
+        Config::SetDefault("ns3::SionnaChannelConditionModel::MapFile", StringValue(pathGainMap));
+        mmwaveHelper->SetPathlossModelType("ns3::SionnaPropagationLossModel");
+        mmwaveHelper->SetChannelConditionModelType("ns3::SionnaChannelConditionModel");
+        NS_LOG_UNCOND("Path gain map: " << pathGainMap);
+    }
 
     Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper>();
     mmwaveHelper->SetEpcHelper(epcHelper);
 
     // Enhanced network topology: 7 base stations total
     GlobalValue::GetValueByName("N_MmWaveEnbNodes", uintegerValue);
-    uint8_t nMmWaveEnbNodes = uintegerValue.Get(); // 6 gNBs
+    uint32_t nMmWaveEnbNodes = uintegerValue.Get(); // 6 gNBs
     uint8_t nLteEnbNodes = 1; // 1 eNB
     GlobalValue::GetValueByName("N_Ues", uintegerValue);
     uint32_t nUeNodes = uintegerValue.Get(); // 56 UEs
 
+    GlobalValue::GetValueByName("hexRings", uintegerValue);
+    uint32_t hexRings = uintegerValue.Get();
+    GlobalValue::GetValueByName("hexSectors", uintegerValue);
+    uint32_t hexSectors = uintegerValue.Get();
+    GlobalValue::GetValueByName("fieldMargin", doubleValue);
+    double fieldMargin = doubleValue.Get();
+    GlobalValue::GetValueByName("wrapAround", booleanValue);
+    bool wrapAround = booleanValue.Get();
+    GlobalValue::GetValueByName("cellMapFile", stringValue);
+    std::string cellMapFile = stringValue.Get();
+    if (hexSectors != 1 && hexSectors != 3) {
+        NS_FATAL_ERROR("hexSectors must be 1 or 3");
+    }
+
+    std::vector<HexCell> hexCells;
+    if (hexRings > 0) {
+        // the field grows with the layout, the centre site stays in the middle
+        maxXAxis = 2 * (hexRings * isd_cell + fieldMargin);
+        maxYAxis = maxXAxis;
+        hexCells = GenerateHexTopology(hexRings, hexSectors, isd_cell,
+                                       Vector(maxXAxis / 2, maxYAxis / 2, 10));
+        nMmWaveEnbNodes = hexCells.size();
+        NS_LOG_UNCOND("Hex topology: " << hexRings << " rings, " << hexSectors
+                      << " cells/site, field " << maxXAxis << "x" << maxYAxis
+                      << " (N_MmWaveEnbNodes ignored)");
+    }
+
     NS_LOG_UNCOND("=== Network Configuration ===");
     NS_LOG_UNCOND("mmWave gNBs: " << unsigned(nMmWaveEnbNodes));
     NS_LOG_UNCOND("LTE eNBs: " << unsigned(nLteEnbNodes));
@@ -505,24 +873,38 @@ main(int argc, char *argv[]) {
 
     // Central position: LTE eNB and first mmWave gNB co-located
     enbPositionAlloc->Add(centerPosition);
-    enbPositionAlloc->Add(centerPosition);
-    
-    NS_LOG_UNCOND("=== Base Station Positions ===");
-    NS_LOG_UNCOND("eNB 1 & gNB 2: (" << centerPosition.x << ", " << centerPosition.y << ")");
 
-    // Place 6 mmWave gNBs in hexagonal pattern around center
-    for (uint8_t i = 0; i < (nMmWaveEnbNodes - 1); ++i) { // 6번반복
-        double angle = (i * 60.0) * M_PI / 180.0; // FIXED: 60 degrees apart for 6 stations
-        double x = centerPosition.x + isd_cell * cos(angle);
-        double y = centerPosition.y + isd_cell * sin(angle);
-        enbPositionAlloc->Add(Vector(x, y, 10));
-        NS_LOG_UNCOND("gNB " << unsigned(i+3) << ": (" << x << ", " << y << ")");
+    NS_LOG_UNCOND("=== Base Station Positions ===");
+    if (hexRings > 0) {
+        // sector cells of a site are co-located (isotropic elements: the azimuth
+        // is only exported in the cell map)
+        for (const HexCell &cell : hexCells) {
+            enbPositionAlloc->Add(cell.position);
+        }
+        NS_LOG_UNCOND("eNB 1 & site 0: (" << centerPosition.x << ", " << centerPosition.y << "), "
+                      << hexCells.size() << " gNB cells, see " << cellMapFile);
+    } else {
+        enbPositionAlloc->Add(centerPosition);
+        NS_LOG_UNCOND("eNB 1 & gNB 2: (" << centerPosition.x << ", " << centerPosition.y << ")");
+
+        // Place 6 mmWave gNBs in hexagonal pattern around center
+        for (uint32_t i = 0; i < (nMmWaveEnbNodes - 1); ++i) { // 6번반복
+            double angle = (i * 60.0) * M_PI / 180.0; // FIXED: 60 degrees apart for 6 stations
+            double x = centerPosition.x + isd_cell * cos(angle);
+            double y = centerPosition.y + isd_cell * sin(angle);
+            enbPositionAlloc->Add(Vector(x, y, 10));
+            NS_LOG_UNCOND("gNB " << unsigned(i+3) << ": (" << x << ", " << y << ")");
+        }
     }
 
     MobilityHelper enbmobility;
     enbmobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
     enbmobility.SetPositionAllocator(enbPositionAlloc);
     enbmobility.Install(allEnbNodes);
+    if (!pathGainMap.empty()) {
+        // 그리드가 이 배치로 export 됐는지 한 번만 확인
+        SionnaPathGainMap::Open(pathGainMap)->CheckSites(mmWaveEnbNodes);
+    }
 
     // Enhanced UE mobility for prediction
     MobilityHelper uemobility;
@@ -581,14 +963,41 @@ for (uint32_t i = 0; i < ueNodes.GetN(); ++i) {
 
     // Add X2 interfaces for handover support
     mmwaveHelper->AddX2Interface(lteEnbNodes, mmWaveEnbNodes);
-    /*
+
     // Add X2 interfaces between mmWave gNBs for enhanced handover
-    for (uint16_t i = 0; i < mmWaveEnbNodes.GetN(); ++i) {
-        for (uint16_t j = i+1; j < mmWaveEnbNodes.GetN(); ++j) {
-            mmwaveHelper->AddX2Interface(mmWaveEnbNodes.Get(i), mmWaveEnbNodes.Get(j));
+    GlobalValue::GetValueByName("x2Mode", stringValue);
+    std::string x2Mode = stringValue.Get();
+    GlobalValue::GetValueByName("x2Radius", doubleValue);
+    double x2Radius = doubleValue.Get();
+    x2_mmwave_helper = mmwaveHelper;
+    for (uint32_t i = 0; i < mmWaveEnbDevs.GetN(); ++i) {
+        Ptr<MmWaveEnbNetDevice> mmdev = DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(i));
+        x2_cell_node[mmdev->GetCellId()] = mmWaveEnbNodes.Get(i);
+    }
+    if (x2Mode == "full" || x2Mode == "radius") {
+        for (uint16_t i = 0; i < mmWaveEnbNodes.GetN(); ++i) {
+            for (uint16_t j = i+1; j < mmWaveEnbNodes.GetN(); ++j) {
+                Vector posI = mmWaveEnbNodes.Get(i)->GetObject<MobilityModel>()->GetPosition();
+                Vector posJ = mmWaveEnbNodes.Get(j)->GetObject<MobilityModel>()->GetPosition();
+                if (x2Mode == "full" || CalculateDistance(posI, posJ) <= x2Radius) {
+                    mmwaveHelper->AddX2Interface(mmWaveEnbNodes.Get(i), mmWaveEnbNodes.Get(j));
+                    x2_created_pairs.insert(std::minmax(
+                        DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(i))->GetCellId(),
+                        DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(j))->GetCellId()));
+                }
+            }
+        }
+    } else if (x2Mode != "lazy" && x2Mode != "none") {
+        NS_FATAL_ERROR("Unknown x2Mode " << x2Mode);
+    }
+    if (x2Mode == "lazy" || x2Mode == "radius") {
+        // radius: a HO towards a gNB beyond x2Radius gets its X2 on demand instead of failing
+        for (uint32_t i = 0; i < mmWaveEnbDevs.GetN(); ++i) {
+            DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(i))->GetRrc()
+                ->SetX2SetupRequiredCallback(MakeCallback(&AddX2InterfaceOnce));
         }
     }
-    */
+    NS_LOG_UNCOND("X2 mode " << x2Mode << ", gNB-gNB X2 links at setup: " << x2_created_pairs.size());
     // Attach UEs to closest base station
     mmwaveHelper->AttachToClosestEnb(mcUeDevs, mmWaveEnbDevs, lteEnbDevs);
 
@@ -603,12 +1012,32 @@ for (uint32_t i = 0; i < ueNodes.GetN(); ++i) {
 
     ApplicationContainer clientApp;
 
+    // cbr generates ~2000 packets/s/UE, each going through RLC/MAC/PHY and the
+    // EPC: it dominates the event count while the output we need (SINR reports,
+    // positions) comes from the control channel and the mobility models
+    GlobalValue::GetValueByName("trafficMode", stringValue);
+    std::string trafficMode = stringValue.Get();
+    GlobalValue::GetValueByName("keepAliveInterval", doubleValue);
+    double keepAliveInterval = doubleValue.Get();
+    Time clientInterval = MicroSeconds(500);
+    if (trafficMode == "keepalive") {
+        clientInterval = Seconds(keepAliveInterval);
+    } else if (trafficMode != "cbr" && trafficMode != "none") {
+        NS_FATAL_ERROR("Unknown trafficMode " << trafficMode);
+    }
+    NS_LOG_UNCOND("Traffic mode " << trafficMode << ": "
+                  << (trafficMode == "none" ? 0 : 1 / clientInterval.GetSeconds())
+                  << " packets/s per UE");
+
     for (uint32_t u = 0; u < ueNodes.GetN(); ++u) {
         PacketSinkHelper dlPacketSinkHelper("ns3::UdpSocketFactory",
                                            InetSocketAddress(Ipv4Address::GetAny(), 1234));
         sinkApp.Add(dlPacketSinkHelper.Install(ueNodes.Get(u)));
+        if (trafficMode == "none") {
+            continue;
+        }
         UdpClientHelper dlClient(ueIpIface.GetAddress(u), 1234);
-        dlClient.SetAttribute("Interval", TimeValue(MicroSeconds(500)));
+        dlClient.SetAttribute("Interval", TimeValue(clientInterval));
         dlClient.SetAttribute("MaxPackets", UintegerValue(UINT32_MAX));
         dlClient.SetAttribute("PacketSize", UintegerValue(200)); // Small packets for frequent updates
         clientApp.Add(dlClient.Install(remoteHost));
@@ -628,27 +1057,56 @@ for (uint32_t i = 0; i < ueNodes.GetN(); ++i) {
     
     std::string ue_pos_out = "ue_position.txt";
     ClearFile(ue_pos_out, t_startTime_simid);
+    ue_position_file.open(ue_pos_out.c_str(), std::ios_base::out | std::ios_base::app);
+    if (!ue_position_file.is_open()) {
+        NS_FATAL_ERROR("Can't open file " << ue_pos_out);
+    }
     ClearFile("enbs.txt", t_startTime_simid);
     ClearFile("gnbs.txt", t_startTime_simid);
     
     PrintGnuplottableUeListToFile("ues.txt");
 
-    int nodecount = int(NodeList::GetNNodes());
-    int UE_iterator = nodecount - int(nUeNodes);
+    GlobalValue::GetValueByName("positionSamplingPeriod", doubleValue);
+    double samplingPeriod = doubleValue.Get();
 
-    // Frequent position logging for position prediction (every 3 seconds)
-    int numPrints = int(simTime / 0.1); // Every 0.1 seconds
+    // Frequent position logging for position prediction
+    int numPrints = int(simTime / samplingPeriod);
     NS_LOG_UNCOND("=== Logging Configuration ===");
-    NS_LOG_UNCOND("Position samples: " << numPrints << " (every 0.1 seconds)");
+    NS_LOG_UNCOND("Position samples: " << numPrints << " (every " << samplingPeriod << " seconds)");
     NS_LOG_UNCOND("Total measurement points: " << numPrints * nUeNodes);
+    // previously one PrintPosition event per UE and sample was inserted up front
+    // (~150 B each: EventImpl with bound arguments + scheduler map node)
+    NS_LOG_UNCOND("Pre-scheduled position events avoided: " << uint64_t(numPrints) * nUeNodes
+                  << " (~" << uint64_t(numPrints) * nUeNodes * 150 / (1024 * 1024) << " MB of event queue)");
 
-    for (int i = 1; i <= numPrints; i++) {
-        double scheduleTime = i * 0.1; // 0.1초마다
-        Simulator::Schedule(Seconds(scheduleTime), &PrintGnuplottableEnbListToFile, t_startTime_simid);
-        for (uint32_t j = 0; j < ueNodes.GetN(); j++) {
-            Simulator::Schedule(Seconds(scheduleTime + 0.01), &PrintPosition, ueNodes.Get(j), // 0.01초 후
-                            j + UE_iterator, ue_pos_out, t_startTime_simid);
+    PrintGnuplottableEnbListToFile(lteEnbDevs, mmWaveEnbDevs, t_startTime_simid);
+    WriteCellMap(cellMapFile, mmWaveEnbDevs, hexCells, wrapAround, std::max(hexRings, 1u), isd_cell);
+
+    // serving cell of each UE, maintained from the RRC traces
+    for (uint32_t i = 0; i < mmWaveEnbDevs.GetN(); i++) {
+        mmwave_cell_ids.insert(DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(i))->GetCellId());
+    }
+    Config::Connect("/NodeList/*/DeviceList/*/LteEnbRrc/ConnectionEstablished",
+                    MakeCallback(&NotifyUeServingCell));
+    Config::Connect("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverEndOk",
+                    MakeCallback(&NotifyUeServingCell));
+    Config::ConnectFailSafe("/NodeList/*/DeviceList/*/LteEnbRrc/UeContextRemoved",
+                            MakeCallback(&NotifyUeServingCellRemoved));
+
+    Simulator::Schedule(Seconds(samplingPeriod + 0.01), &SampleUePositions, ueNodes,
+                        Seconds(samplingPeriod), t_startTime_simid);
+
+    GlobalValue::GetValueByName("trajectoryHorizon", doubleValue);
+    double trajectoryHorizon = doubleValue.Get();
+    if (trajectoryHorizon > 0) {
+        for (uint32_t i = 0; i < mmWaveEnbDevs.GetN(); i++) {
+            Ptr<MmWaveEnbNetDevice> mmdev = DynamicCast<MmWaveEnbNetDevice>(mmWaveEnbDevs.Get(i));
+            trajectory_cell_dev[mmdev->GetCellId()] = mmdev;
         }
+        Simulator::Schedule(Seconds(indicationPeriodicity), &PredictUeTrajectories, ueNodes,
+                            Seconds(indicationPeriodicity), Seconds(trajectoryHorizon));
+        NS_LOG_UNCOND("Trajectory prediction: " << trajectoryHorizon << " s horizon, every "
+                      << indicationPeriodicity << " s");
     }
 
     if (enableTraces) {
@@ -661,20 +1119,67 @@ for (uint32_t i = 0; i < ueNodes.GetN(); ++i) {
     lteHelper->EnablePhyTraces();
     lteHelper->EnableMacTraces();
 
+    // HO interruption time / RLF statistics, to compare runs with and without prediction
+    ho_stats_file.open("ho_stats.txt", std::ios_base::out | std::ios_base::trunc);
+    ho_stats_file << "timestamp,event,imsi,cell,interruptionMs,proactive" << std::endl;
+    Config::Connect("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverStart",
+                    MakeCallback(&NotifyHandoverStartEnb));
+    Config::Connect("/NodeList/*/DeviceList/*/LteEnbRrc/HandoverEndOk",
+                    MakeCallback(&NotifyHandoverEndOkEnb));
+    Config::ConnectFailSafe("/NodeList/*/DeviceList/*/LteEnbRrc/ProactiveHandover",
+                            MakeCallback(&NotifyProactiveHandover));
+    if (!Config::ConnectFailSafe("/NodeList/*/DeviceList/*/$ns3::McUeNetDevice/MmWaveUeRrc/RadioLinkFailure",
+                                 MakeCallback(&NotifyRadioLinkFailure))) {
+        NS_LOG_UNCOND("RadioLinkFailure trace not available, RLF count will be 0");
+    }
+
     // Run simulation
     NS_LOG_UNCOND("=== Starting Position Prediction Simulation ===");
     NS_LOG_UNCOND("Simulation time: " << simTime << " seconds");
     NS_LOG_UNCOND("Expected data points for ML training: " << numPrints * nUeNodes);
     
+    GlobalValue::GetValueByName("speedFactor", doubleValue);
+    pacing_speed_factor = doubleValue.Get();
+    GlobalValue::GetValueByName("pacingTick", doubleValue);
+    Time pacingTick = Seconds(doubleValue.Get());
+    if (pacing_speed_factor > 0) {
+        pacing_file.open("pacing.txt", std::ios_base::out | std::ios_base::trunc);
+        pacing_file << "simTimeMs,wallMs,lagMs" << std::endl;
+        pacing_lag_ms.reserve(size_t(simTime / pacingTick.GetSeconds()) + 1);
+        Simulator::ScheduleNow(&PaceSimulation, pacingTick);
+        NS_LOG_UNCOND("Paced execution: speedFactor " << pacing_speed_factor << ", tick "
+                      << pacingTick.GetMilliSeconds() << " ms");
+    }
+
     Simulator::Stop(Seconds(simTime));
     NS_LOG_INFO("Run Simulation.");
+    auto wallStart = std::chrono::steady_clock::now();
     Simulator::Run();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    NS_LOG_UNCOND("Simulator::Run wall time: " << wallSeconds << " s");
+    uint64_t eventCount = Simulator::GetEventCount();
+    NS_LOG_UNCOND("Events executed: " << eventCount << " (" << eventCount / simTime
+                  << " per simulated s, " << eventCount / std::max(wallSeconds, 1e-3)
+                  << " per wall s, trafficMode " << trafficMode << ")");
+
+    PrintPacingSummary(simTime, wallSeconds, pacingTick);
+    pacing_file.close();
+    ue_position_file.close();
 
     NS_LOG_UNCOND("=== Simulation Completed ===");
     NS_LOG_UNCOND("Position data saved to: " << ue_pos_out);
     NS_LOG_UNCOND("Base station data saved to: gnbs.txt, enbs.txt");
     NS_LOG_UNCOND("UE layout saved to: ues.txt");
 
+    NS_LOG_UNCOND("=== Handover Statistics (proactiveHo " << proactiveHo << ", trajectoryHorizon "
+                  << trajectoryHorizon << " s) ===");
+    NS_LOG_UNCOND("Handovers: " << ho_count << " (proactive " << ho_proactive_count << ")");
+    NS_LOG_UNCOND("Mean HO interruption: "
+                  << (ho_count > 0 ? ho_interruption_sum_ms / ho_count : 0) << " ms");
+    NS_LOG_UNCOND("RLF: " << rlf_count);
+    NS_LOG_UNCOND("gNB-gNB X2 links (x2Mode " << x2Mode << "): " << x2_created_pairs.size());
+    ho_stats_file.close();
+
     Simulator::Destroy();
     NS_LOG_INFO("Done.");
     return 0;
@@ -0,0 +1,157 @@
+/*
+ * Interned KPM measurement names for the xApps
+ * 🔥 측정 이름 문자열 → (종류, cellID, ueID) 를 한 번만 파싱해서 캐시
+ *
+ * The cu-cp indications repeat the same names every period
+ * ("L3servingSINR3gpp_cell_<cell>_UEID_<ue>", "L3neighSINRListOf_UEID_<ue>_of_Cell_<cell>"),
+ * so the prefix compare + sscanf is done the first time a name is seen and the
+ * result is looked up by hash afterwards. Names that match neither prefix are
+ * cached as MEAS_NAME_OTHER. The buffers do not need to be NUL terminated.
+ */
+
+#ifndef MEAS_NAME_CACHE_H
+#define MEAS_NAME_CACHE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEAS_NAME_CACHE_MAX_LEN 127
+#define MEAS_NAME_CACHE_MAX_ENTRIES (1u << 20)   // past this, names are parsed but not cached
+
+typedef enum {
+    MEAS_NAME_OTHER = 0,
+    MEAS_NAME_SERVING_SINR,      // L3servingSINR3gpp_cell_%d_UEID_%d
+    MEAS_NAME_NEIGH_SINR_LIST,   // L3neighSINRListOf_UEID_%d_of_Cell_%d
+} meas_name_kind_e;
+
+typedef struct {
+    meas_name_kind_e kind;
+    uint16_t cellID;
+    uint16_t ueID;
+} meas_name_info_t;
+
+typedef struct {
+    uint64_t hash;               // 0: empty slot
+    char* name;
+    size_t len;
+    meas_name_info_t info;
+} meas_name_entry_t;
+
+typedef struct {
+    meas_name_entry_t* slots;
+    size_t capacity;             // power of two
+    size_t count;
+    meas_name_info_t uncached;   // result returned when the cache is full
+} meas_name_cache_t;
+
+static inline uint64_t meas_name_hash(const uint8_t* buf, size_t len) {
+    // FNV-1a, never 0
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= buf[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h ? h : 1;
+}
+
+static inline meas_name_info_t meas_name_parse(const uint8_t* buf, size_t len) {
+    meas_name_info_t info = {MEAS_NAME_OTHER, UINT16_MAX, UINT16_MAX};
+    char name[MEAS_NAME_CACHE_MAX_LEN + 1];
+    if (len > MEAS_NAME_CACHE_MAX_LEN) {
+        return info;
+    }
+    memcpy(name, buf, len);
+    name[len] = '\0';
+
+    unsigned short cell, ue;
+    if (sscanf(name, "L3servingSINR3gpp_cell_%hu_UEID_%hu", &cell, &ue) == 2) {
+        info.kind = MEAS_NAME_SERVING_SINR;
+    } else if (sscanf(name, "L3neighSINRListOf_UEID_%hu_of_Cell_%hu", &ue, &cell) == 2) {
+        info.kind = MEAS_NAME_NEIGH_SINR_LIST;
+    } else {
+        return info;
+    }
+    info.cellID = cell;
+    info.ueID = ue;
+    return info;
+}
+
+static inline void meas_name_cache_init(meas_name_cache_t* c) {
+    memset(c, 0, sizeof(*c));
+}
+
+static inline void meas_name_cache_grow(meas_name_cache_t* c) {
+    size_t capacity = c->capacity ? c->capacity * 2 : 1024;
+    meas_name_entry_t* slots = calloc(capacity, sizeof(meas_name_entry_t));
+    if (slots == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < c->capacity; i++) {
+        if (c->slots[i].hash == 0) {
+            continue;
+        }
+        size_t s = (size_t)c->slots[i].hash & (capacity - 1);
+        while (slots[s].hash != 0) {
+            s = (s + 1) & (capacity - 1);
+        }
+        slots[s] = c->slots[i];
+    }
+    free(c->slots);
+    c->slots = slots;
+    c->capacity = capacity;
+}
+
+static inline const meas_name_info_t* meas_name_lookup(meas_name_cache_t* c, const uint8_t* buf, size_t len) {
+    uint64_t h = meas_name_hash(buf, len);
+    if (c->capacity > 0) {
+        for (size_t s = (size_t)h & (c->capacity - 1);; s = (s + 1) & (c->capacity - 1)) {
+            meas_name_entry_t* e = &c->slots[s];
+            if (e->hash == 0) {
+                break;
+            }
+            if (e->hash == h && e->len == len && memcmp(e->name, buf, len) == 0) {
+                return &e->info;
+            }
+        }
+    }
+
+    // first time this name is seen
+    meas_name_info_t info = meas_name_parse(buf, len);
+    if (c->count >= MEAS_NAME_CACHE_MAX_ENTRIES) {
+        c->uncached = info;
+        return &c->uncached;
+    }
+    if ((c->count + 1) * 2 > c->capacity) {
+        meas_name_cache_grow(c);
+    }
+    char* name = malloc(len ? len : 1);
+    if (name == NULL || (c->count + 1) * 2 > c->capacity) {
+        free(name);
+        c->uncached = info;
+        return &c->uncached;
+    }
+    memcpy(name, buf, len);
+
+    size_t s = (size_t)h & (c->capacity - 1);
+    while (c->slots[s].hash != 0) {
+        s = (s + 1) & (c->capacity - 1);
+    }
+    c->slots[s].hash = h;
+    c->slots[s].name = name;
+    c->slots[s].len = len;
+    c->slots[s].info = info;
+    c->count++;
+    return &c->slots[s].info;
+}
+
+static inline void meas_name_cache_free(meas_name_cache_t* c) {
+    for (size_t i = 0; i < c->capacity; i++) {
+        free(c->slots[i].name);
+    }
+    free(c->slots);
+    meas_name_cache_init(c);
+}
+
+#endif // MEAS_NAME_CACHE_H
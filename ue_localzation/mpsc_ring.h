@@ -0,0 +1,108 @@
+/*
+ * Bounded lock-free MPSC ring for the xApps
+ * 🔥 FlexRIC indication 콜백 → worker 스레드로 고정 크기 레코드 전달
+ *
+ * Vyukov's bounded queue: every slot carries a sequence number, producers
+ * claim a position with one CAS on enqueue_pos and publish the slot with a
+ * release store of its sequence, so pushes never take a lock and never block.
+ * A full ring makes mpsc_ring_push return false (counted in dropped) instead
+ * of waiting for the consumer. mpsc_ring_pop must only be called from one
+ * thread. Records are copied in and out by value.
+ */
+
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MPSC_RING_SLOT_HEADER 8   // atomic sequence, keeps the record 8-byte aligned
+
+typedef struct {
+    unsigned char* slots;        // capacity x stride: sequence + record
+    size_t stride;
+    size_t elem_size;
+    size_t mask;                 // capacity - 1, capacity is a power of two
+    _Alignas(64) atomic_size_t enqueue_pos;
+    _Alignas(64) size_t dequeue_pos;   // consumer only
+    atomic_uint_fast64_t dropped;
+} mpsc_ring_t;
+
+static inline atomic_size_t* mpsc_ring_seq(mpsc_ring_t const* r, size_t pos) {
+    return (atomic_size_t*)(r->slots + (pos & r->mask) * r->stride);
+}
+
+// capacity is rounded up to a power of two
+static inline bool mpsc_ring_init(mpsc_ring_t* r, size_t capacity, size_t elem_size) {
+    size_t cap = 2;
+    while (cap < capacity) {
+        cap *= 2;
+    }
+    memset(r, 0, sizeof(*r));
+    r->elem_size = elem_size;
+    r->stride = (MPSC_RING_SLOT_HEADER + elem_size + 7) & ~(size_t)7;
+    r->mask = cap - 1;
+    r->slots = aligned_alloc(64, (cap * r->stride + 63) & ~(size_t)63);
+    if (r->slots == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(mpsc_ring_seq(r, i), i);
+    }
+    atomic_init(&r->enqueue_pos, 0);
+    atomic_init(&r->dropped, 0);
+    return true;
+}
+
+// Any thread. false: ring full, the record is dropped
+static inline bool mpsc_ring_push(mpsc_ring_t* r, void const* value) {
+    size_t pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+    atomic_size_t* seq;
+    for (;;) {
+        seq = mpsc_ring_seq(r, pos);
+        size_t s = atomic_load_explicit(seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)s - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            atomic_fetch_add_explicit(&r->dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    memcpy((unsigned char*)seq + MPSC_RING_SLOT_HEADER, value, r->elem_size);
+    atomic_store_explicit(seq, pos + 1, memory_order_release);
+    return true;
+}
+
+// Consumer thread only. false: ring empty
+static inline bool mpsc_ring_pop(mpsc_ring_t* r, void* value) {
+    size_t pos = r->dequeue_pos;
+    atomic_size_t* seq = mpsc_ring_seq(r, pos);
+    size_t s = atomic_load_explicit(seq, memory_order_acquire);
+    if ((intptr_t)s - (intptr_t)(pos + 1) < 0) {
+        return false;
+    }
+    memcpy(value, (unsigned char*)seq + MPSC_RING_SLOT_HEADER, r->elem_size);
+    r->dequeue_pos = pos + 1;
+    atomic_store_explicit(seq, pos + r->mask + 1, memory_order_release);
+    return true;
+}
+
+static inline uint64_t mpsc_ring_dropped(mpsc_ring_t* r) {
+    return atomic_load_explicit(&r->dropped, memory_order_relaxed);
+}
+
+static inline void mpsc_ring_free(mpsc_ring_t* r) {
+    free(r->slots);
+    r->slots = NULL;
+}
+
+#endif // MPSC_RING_H
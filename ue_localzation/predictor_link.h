@@ -0,0 +1,287 @@
+/*
+ * Reconnecting link to the Python predictor for the xApps
+ * 🔥 연결이 끊겨도 xApp 은 멈추지 않음: 메시지는 spool 에 쌓았다가 재연결되면 다시 전송
+ *
+ * The Unix socket is non-blocking. Every message (a binary frame or a csv
+ * line) is appended whole to a bounded spool and written from there, so a
+ * send never waits for the receiver. A message leaves the spool only once it
+ * has been written completely; when the connection breaks, the message that
+ * was half written is sent again from its start on the next connection, so
+ * the receiver always sees whole messages. Reconnection is attempted from
+ * predictor_link_send / predictor_link_poll with exponential backoff
+ * (100 ms up to 5 s). When the spool (XAPP_SPOOL_BYTES, default 4 MiB) is
+ * full, the oldest messages are dropped and counted.
+ *
+ * All functions may be called from any thread (the link has its own lock).
+ */
+
+#ifndef PREDICTOR_LINK_H
+#define PREDICTOR_LINK_H
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "xapp_logger.h"
+
+#define PREDICTOR_LINK_DEFAULT_SPOOL (4u << 20)
+#define PREDICTOR_LINK_BACKOFF_MIN_MS 100
+#define PREDICTOR_LINK_BACKOFF_MAX_MS 5000
+#define PREDICTOR_LINK_MSG_HEADER sizeof(uint32_t)   // spool 안의 메시지 길이
+
+typedef struct {
+    pthread_mutex_t mtx;
+    struct sockaddr_un addr;
+    int fd;                      // -1: 연결 안 됨
+    int64_t next_attempt_us;
+    unsigned backoff_ms;
+    bool ever_connected;
+
+    // spool: [u32 len][payload] 메시지들이 [start, end) 에 연속
+    unsigned char* spool;
+    size_t cap;
+    size_t start;
+    size_t end;
+    size_t head_sent;            // 첫 메시지에서 현재 연결로 이미 쓴 바이트
+    size_t queued;               // spool 의 메시지 수 (lag)
+
+    uint64_t sent;
+    uint64_t dropped;
+    uint64_t dropped_bytes;
+    uint64_t reconnects;
+    size_t max_queued;
+} predictor_link_t;
+
+static inline int64_t predictor_link_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static inline void predictor_link_init(predictor_link_t* l, const char* path) {
+    memset(l, 0, sizeof(*l));
+    pthread_mutex_init(&l->mtx, NULL);
+    l->addr.sun_family = AF_UNIX;
+    strncpy(l->addr.sun_path, path, sizeof(l->addr.sun_path) - 1);
+    l->fd = -1;
+    l->backoff_ms = PREDICTOR_LINK_BACKOFF_MIN_MS;
+
+    const char* env = getenv("XAPP_SPOOL_BYTES");
+    long cap = env != NULL ? atol(env) : 0;
+    l->cap = cap > 0 ? (size_t)cap : PREDICTOR_LINK_DEFAULT_SPOOL;
+    l->spool = malloc(l->cap);
+    if (l->spool == NULL) {
+        l->cap = 0;
+    }
+}
+
+// ---- l->mtx 안 ----
+
+static inline void predictor_link_disconnect(predictor_link_t* l, const char* reason) {
+    if (l->fd < 0) {
+        return;
+    }
+    close(l->fd);
+    l->fd = -1;
+    l->head_sent = 0;            // 보내다 만 메시지는 다음 연결에서 처음부터
+    l->backoff_ms = PREDICTOR_LINK_BACKOFF_MIN_MS;
+    l->next_attempt_us = predictor_link_now_us() + l->backoff_ms * 1000;
+    xlog_warn("[SOCKET] ⚠️  Python receiver lost (%s), spooling %zu message(s)\n", reason, l->queued);
+}
+
+static inline void predictor_link_try_connect(predictor_link_t* l) {
+    int64_t now = predictor_link_now_us();
+    if (l->fd >= 0 || now < l->next_attempt_us) {
+        return;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&l->addr, sizeof(l->addr)) == 0) {
+        l->fd = fd;
+        l->head_sent = 0;
+        l->backoff_ms = PREDICTOR_LINK_BACKOFF_MIN_MS;
+        if (l->ever_connected) {
+            l->reconnects++;
+        }
+        l->ever_connected = true;
+        xlog_info("[SOCKET] ✅ Connected to Python receiver at %s (%zu spooled message(s))\n",
+                  l->addr.sun_path, l->queued);
+        return;
+    }
+    // 없음 / 거부 / backlog 가득 (EAGAIN): 나중에 다시
+    if (fd >= 0) {
+        close(fd);
+    }
+    l->next_attempt_us = now + (int64_t)l->backoff_ms * 1000;
+    l->backoff_ms = l->backoff_ms * 2 < PREDICTOR_LINK_BACKOFF_MAX_MS ? l->backoff_ms * 2 : PREDICTOR_LINK_BACKOFF_MAX_MS;
+}
+
+static inline uint32_t predictor_link_msg_len(predictor_link_t const* l, size_t pos) {
+    uint32_t len;
+    memcpy(&len, l->spool + pos, sizeof(len));
+    return len;
+}
+
+// spool 의 메시지를 소켓이 받는 만큼 쓰기 (막히면 그대로 두고 반환)
+static inline void predictor_link_pump(predictor_link_t* l) {
+    while (l->fd >= 0 && l->queued > 0) {
+        uint32_t len = predictor_link_msg_len(l, l->start);
+        unsigned char* payload = l->spool + l->start + PREDICTOR_LINK_MSG_HEADER;
+        ssize_t n = send(l->fd, payload + l->head_sent, len - l->head_sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                predictor_link_disconnect(l, strerror(errno));
+            }
+            return;
+        }
+        l->head_sent += (size_t)n;
+        if (l->head_sent < len) {
+            continue;
+        }
+        l->start += PREDICTOR_LINK_MSG_HEADER + len;
+        l->head_sent = 0;
+        l->queued--;
+        l->sent++;
+    }
+    if (l->queued == 0) {
+        l->start = l->end = 0;
+    }
+}
+
+// 가장 오래된 메시지부터 버려서 need 바이트 확보 (보내는 중인 첫 메시지는 유지)
+static inline bool predictor_link_make_room(predictor_link_t* l, size_t need) {
+    if (need > l->cap) {
+        return false;
+    }
+    if (l->cap - l->end >= need) {
+        return true;
+    }
+    if (l->start > 0) {
+        memmove(l->spool, l->spool + l->start, l->end - l->start);
+        l->end -= l->start;
+        l->start = 0;
+    }
+    size_t keep = 0;             // 앞에 남겨둘 바이트 (보내는 중인 메시지)
+    if (l->head_sent > 0) {
+        keep = PREDICTOR_LINK_MSG_HEADER + predictor_link_msg_len(l, 0);
+    }
+    size_t drop_end = keep;
+    size_t dropped = 0;
+    while (l->cap - (l->end - (drop_end - keep)) < need && drop_end < l->end) {
+        drop_end += PREDICTOR_LINK_MSG_HEADER + predictor_link_msg_len(l, drop_end);
+        dropped++;
+    }
+    if (dropped > 0) {
+        memmove(l->spool + keep, l->spool + drop_end, l->end - drop_end);
+        l->end -= drop_end - keep;
+        l->queued -= dropped;
+        l->dropped += dropped;
+        l->dropped_bytes += drop_end - keep;
+    }
+    return l->cap - l->end >= need;
+}
+
+// ---- 공개 API ----
+
+// 메시지 하나 (iov 를 이어 붙인 것). false: spool 에 넣지 못하고 버림
+static inline bool predictor_link_sendv(predictor_link_t* l, struct iovec const* iov, int iovcnt) {
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
+    if (len == 0) {
+        return true;
+    }
+
+    pthread_mutex_lock(&l->mtx);
+    bool queued = len <= UINT32_MAX && predictor_link_make_room(l, PREDICTOR_LINK_MSG_HEADER + len);
+    if (queued) {
+        uint32_t len32 = (uint32_t)len;
+        memcpy(l->spool + l->end, &len32, sizeof(len32));
+        l->end += PREDICTOR_LINK_MSG_HEADER;
+        for (int i = 0; i < iovcnt; i++) {
+            memcpy(l->spool + l->end, iov[i].iov_base, iov[i].iov_len);
+            l->end += iov[i].iov_len;
+        }
+        l->queued++;
+        if (l->queued > l->max_queued) {
+            l->max_queued = l->queued;
+        }
+    } else {
+        l->dropped++;
+        l->dropped_bytes += len;
+    }
+    predictor_link_try_connect(l);
+    predictor_link_pump(l);
+    pthread_mutex_unlock(&l->mtx);
+    return queued;
+}
+
+static inline bool predictor_link_send(predictor_link_t* l, void const* data, size_t len) {
+    struct iovec iov = { .iov_base = (void*)data, .iov_len = len };
+    return predictor_link_sendv(l, &iov, 1);
+}
+
+// 주기적으로 (main 루프): 재연결 시도 + spool 전송
+static inline void predictor_link_poll(predictor_link_t* l) {
+    pthread_mutex_lock(&l->mtx);
+    predictor_link_try_connect(l);
+    predictor_link_pump(l);
+    pthread_mutex_unlock(&l->mtx);
+}
+
+static inline bool predictor_link_connected(predictor_link_t* l) {
+    pthread_mutex_lock(&l->mtx);
+    bool connected = l->fd >= 0;
+    pthread_mutex_unlock(&l->mtx);
+    return connected;
+}
+
+static inline void predictor_link_print(predictor_link_t* l) {
+    pthread_mutex_lock(&l->mtx);
+    xlog_info("[SOCKET] 📡 %s | sent %lu, spooled %zu (max %zu), dropped %lu (%lu bytes), reconnects %lu\n",
+              l->fd >= 0 ? "connected" : "waiting for receiver", (unsigned long)l->sent, l->queued,
+              l->max_queued, (unsigned long)l->dropped, (unsigned long)l->dropped_bytes,
+              (unsigned long)l->reconnects);
+    pthread_mutex_unlock(&l->mtx);
+}
+
+// 남은 spool 은 timeout_ms 동안 (재연결하면서) 보내보고 닫음
+static inline void predictor_link_close(predictor_link_t* l, unsigned timeout_ms) {
+    int64_t deadline = predictor_link_now_us() + (int64_t)timeout_ms * 1000;
+    for (;;) {
+        pthread_mutex_lock(&l->mtx);
+        predictor_link_try_connect(l);
+        predictor_link_pump(l);
+        bool done = l->queued == 0;
+        pthread_mutex_unlock(&l->mtx);
+        if (done || predictor_link_now_us() >= deadline) {
+            break;
+        }
+        usleep(10000);
+    }
+    pthread_mutex_lock(&l->mtx);
+    if (l->queued > 0) {
+        xlog_warn("[SOCKET] ⚠️  %zu message(s) not delivered\n", l->queued);
+    }
+    if (l->fd >= 0) {
+        close(l->fd);
+        l->fd = -1;
+        xlog_info("[SOCKET] 🔌 Socket closed\n");
+    }
+    free(l->spool);
+    l->spool = NULL;
+    l->cap = l->start = l->end = l->queued = 0;
+    pthread_mutex_unlock(&l->mtx);
+}
+
+#endif // PREDICTOR_LINK_H
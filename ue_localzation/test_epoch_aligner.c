@@ -0,0 +1,111 @@
+/*
+ * epoch_aligner.h 테스트 (sequence = (epoch - first_epoch) / period_ms)
+ *
+ *   gcc -O2 -o test_epoch_aligner test_epoch_aligner.c
+ *   ./test_epoch_aligner
+ *
+ * Feeds collectStartTime epochs through the aligner the way the xApps do
+ * (one record per sample, reorder window 1) and checks the emitted epochs and
+ * sequences: a skipped epoch or an epoch whose samples all arrive late must
+ * leave a gap, so that the rows after it keep the relative_timestamp of the
+ * offline alignment (timestamp - t0) // 100 in make_csv_split_offline.py.
+ */
+
+#include "epoch_aligner.h"
+#include <stdio.h>
+
+#define PERIOD_MS 100
+#define MAX_EMITTED 32
+
+typedef struct {
+    uint64_t epoch[MAX_EMITTED];
+    uint64_t sequence[MAX_EMITTED];
+    size_t count[MAX_EMITTED];
+    size_t num;
+} emitted_t;
+
+static int failures = 0;
+
+static void on_emit(epoch_batch_t const* batch, void* ctx) {
+    emitted_t* e = ctx;
+    if (e->num < MAX_EMITTED) {
+        e->epoch[e->num] = batch->epoch;
+        e->sequence[e->num] = batch->sequence;
+        e->count[e->num] = batch->count;
+        e->num++;
+    }
+}
+
+static void expect(bool ok, char const* what) {
+    if (!ok) {
+        fprintf(stderr, "❌ %s\n", what);
+        failures++;
+    }
+}
+
+// epochs[i] 를 차례로 넣고 flush, 방출된 (epoch, sequence) 를 비교
+static void run_case(char const* name, uint64_t const* epochs, size_t n,
+                     uint64_t const* want_epoch, uint64_t const* want_sequence, size_t want_num,
+                     uint64_t want_late) {
+    emitted_t e = {0};
+    epoch_aligner_t a;
+    epoch_aligner_init(&a, sizeof(uint64_t), PERIOD_MS, 1, on_emit, &e);
+    for (size_t i = 0; i < n; i++) {
+        epoch_aligner_add(&a, epochs[i], &epochs[i]);
+    }
+    epoch_aligner_flush(&a);
+
+    int before = failures;
+    expect(e.num == want_num, "number of emitted epochs");
+    for (size_t i = 0; i < want_num && i < e.num; i++) {
+        expect(e.epoch[i] == want_epoch[i], "emitted epoch");
+        expect(e.sequence[i] == want_sequence[i], "emitted sequence");
+    }
+    uint64_t late = a.late_records;
+    expect(late == want_late, "late records");
+    epoch_aligner_free(&a);
+
+    printf("%s %s:", failures == before ? "✅" : "❌", name);
+    for (size_t i = 0; i < e.num; i++) {
+        printf(" %lu->%lu", (unsigned long)e.epoch[i], (unsigned long)e.sequence[i]);
+    }
+    printf(" (late %lu)\n", (unsigned long)late);
+}
+
+int main(void) {
+    // 연속된 epoch: 0, 1, 2
+    {
+        uint64_t in[] = { 100, 100, 200, 200, 300 };
+        uint64_t ep[] = { 100, 200, 300 };
+        uint64_t sq[] = { 0, 1, 2 };
+        run_case("contiguous", in, 5, ep, sq, 3, 0);
+    }
+    // epoch 300 이 통째로 빠짐: 400 은 3 (닫은 개수 2 가 아님)
+    {
+        uint64_t in[] = { 100, 200, 400, 500 };
+        uint64_t ep[] = { 100, 200, 400, 500 };
+        uint64_t sq[] = { 0, 1, 3, 4 };
+        run_case("skipped epoch", in, 4, ep, sq, 4, 0);
+    }
+    // epoch 300 의 샘플이 모두 watermark 뒤에 도착: 버려지고 뒤의 행은 그대로
+    {
+        uint64_t in[] = { 100, 200, 400, 500, 600, 300, 300, 700 };
+        uint64_t ep[] = { 100, 200, 400, 500, 600, 700 };
+        uint64_t sq[] = { 0, 1, 3, 4, 5, 6 };
+        run_case("late epoch", in, 8, ep, sq, 6, 2);
+    }
+    // 창 안에서 순서가 바뀐 첫 epoch: first_epoch 은 처음 닫은 (가장 이른) epoch
+    {
+        uint64_t in[] = { 1200, 1100, 1300 };
+        uint64_t ep[] = { 1100, 1200, 1300 };
+        uint64_t sq[] = { 0, 1, 2 };
+        run_case("reordered start", in, 3, ep, sq, 3, 0);
+    }
+
+    if (failures > 0) {
+        printf("❌ %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✅ All epoch aligner checks passed\n");
+    return 0;
+}
@@ -16,42 +16,47 @@
 #include <unistd.h>
 #include <signal.h>
 #include <stdarg.h>
+#include "cell_map.h"
+#include "indication_jitter.h"
+#include "ue_table.h"
+#include "kpm_ingest.h"
+#include "mpsc_ring.h"
+#include "epoch_aligner.h"
+#include "xapp_logger.h"
+#include "predictor_link.h"
+#include <semaphore.h>
+#include <stdatomic.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <errno.h>
 #include <math.h>
 // =============================================================================
 // CONSTANTS & GLOBAL VARIABLES
 // =============================================================================
 #define WINDOW_SIZE 50
-#define NUM_CELLS 7
 #define MIN_NEIGHBORS_REQUIRED 3 // 최소 필요 neighbor 개수
-#define TOTAL_UES 28                             // 전체 UE 개수
+#define MIN_HISTORY_SAMPLES 5    // 이동평균을 내기 전 최소 serving 샘플 수
+#define MAX_WORKERS 16                           // 이동평균/출력 worker 최대 개수 (XAPP_WORKERS 환경변수)
+#define WORKER_RING_CAPACITY 65536               // worker 당 대기 레코드 수, 넘치면 버림
 
-static int socket_fd = -1;
-static bool socket_connected = false;
 static const char* SOCKET_PATH = "/tmp/sinr_localization.sock";
-static pthread_mutex_t mtx;
+static predictor_link_t predictor;          // socket + spool (worker 공유, 자체 lock)
+static pthread_mutex_t mtx;                 // 콜백 (ingest) 상태
 static bool monitoring_active = true;
 static uint64_t const period_ms = 100;  
+static kpm_ingest_filter_t const kpm_filter = { GREATERTHAN_TEST_COND, 2 };   // 무조건보내게설정
 static int indication_counter = 0;
-static FILE *log_file = NULL;
-static uint64_t current_sequence_timestamp = 0;  // 0, 1,2
-static int current_burst_ue_count = 0;           // 현재 burst에서 받은 UE 개수
-static bool burst_sequence_assigned[TOTAL_UES] = {false}; // UE별 sequence 할당 여부
+static xlog_sink_t *log_file = NULL;       // lstm_input_data.csv
+static indication_jitter_t ind_jitter;      // indication inter-arrival (wall clock)
+static ue_window_cfg_t const window_cfg = { WINDOW_SIZE, 5 };   // neighbor 는 윈도우 안 5개 이상
 // =============================================================================
 // DATA STRUCTURES
 // =============================================================================
 
-// Cell Position Structure
-typedef struct {
-    uint16_t cellID;
-    int x;
-    int y;
-} cell_position_t;
 
 // Cell Position Mapping (ns-O-RAN 시뮬레이터 기준)
-static cell_position_t cell_positions[] = {
+static cell_map_entry_t cell_positions[] = {
     {2, 800, 800},         // gNB 1 중앙 위치
     {3, 1300, 800},        // gNB 2 동쪽
     {4, 1050, 1233},       // gNB 3 북동쪽
@@ -61,287 +66,206 @@ static cell_position_t cell_positions[] = {
     {8, 1050, 366},        // gNB 7 남동쪽
 };
 
-// 🔥 이동평균을 위한 UE 데이터 버퍼
+struct epoch_frame;
+
+// worker 레코드 종류: kpm_sample_type_e 다음, 닫힌 epoch 의 샘플 뒤에 worker 마다 하나
+#define UE_SAMPLE_EPOCH_END 0xff
+
+// 🔥 콜백 → worker 레코드: 콜백은 측정값만 복사하고, 이동평균/파일/소켓은 worker 가 처리
 typedef struct {
+    uint8_t type;                   // kpm_sample_type_e / UE_SAMPLE_EPOCH_END
     uint16_t ueID;
-    uint16_t servingCellID;
-    
-    // Circular buffer for serving SINR
-    double serving_sinr_buffer[WINDOW_SIZE];
-    int serving_buffer_idx;
-    int serving_sample_count;
-    
-    // Neighbor buffers
-    struct {
-        uint16_t neighCellID;
-        double sinr_buffer[WINDOW_SIZE];
-        int buffer_idx;
-        int sample_count;
-        bool is_active;
-    } neighbors[10];
-
-    // 추가: 전체 측정값 히스토리 (이동평균용)
-    struct {
-        double serving_sinr;
-        double neighbor_sinrs[10];
-        uint16_t neighbor_ids[10];
-        int active_neighbor_count;
-        uint64_t timestamp;
-    } measurement_history[WINDOW_SIZE];
-
-    int active_neighbors;
-    int history_idx;        // 현재 쓰기 위치
-    int history_count;      // 누적된 측정값 개수
-    uint64_t last_timestamp;
-} ue_buffer_t;
-
-// UE 버퍼 (최대 20개 UE)
-static ue_buffer_t ue_buffers[28];
-static int num_active_ues = 0;
-
-// Orange 스타일 측정값 파싱 구조체
-struct InfoObj { 
-    uint16_t cellID;
-    uint16_t ueID;
-};
+    uint16_t cellID;                // serving cell / neighbor cell
+    double sinr;
+    uint64_t timestamp;             // collectStartTime
+    uint64_t sequence_timestamp;    // epoch sequence (aligner 가 epoch 을 닫을 때 할당)
+    struct epoch_frame* frame;      // UE_SAMPLE_EPOCH_END: 이 epoch 의 공유 frame
+} ue_sample_t;
+
+// 콜백의 샘플을 collectStartTime 별로 모았다가 epoch 이 닫히면 worker 로 (콜백, mtx 안)
+static epoch_aligner_t aligner;
+
+// 🔥 Python 예측기로 보내는 binary frame (python/utils_Standard.py 와 같은 형식, little endian)
+//   header: "SINF", version, record 크기, record 개수, epoch (collectStartTime)
+//   record: lstm_input_data.csv 한 줄과 같은 값
+#define SINR_FRAME_MAGIC "SINF"
+#define SINR_FRAME_VERSION 1
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t epoch;
+} sinr_frame_header_t;
+
+typedef struct {
+    uint64_t relative_timestamp;    // sequence timestamp
+    uint32_t imsi;
+    int32_t serving_x;
+    int32_t serving_y;
+    float serving_sinr;             // L3 serving SINR 3gpp_ma
+    float neigh_sinr[3];            // L3 neigh SINR 3gpp 1~3 (convertedSinr)_ma
+    uint32_t reserved;
+} sinr_frame_record_t;
+
+_Static_assert(sizeof(sinr_frame_header_t) == 24, "sinr frame header layout");
+_Static_assert(sizeof(sinr_frame_record_t) == 40, "sinr frame record layout");
+
+typedef struct {
+    sinr_frame_header_t header;
+    sinr_frame_record_t* records;
+    size_t cap;
+} sinr_frame_t;
+
+// 🔥 닫힌 epoch 하나 = frame 하나 (indication 당 sendmsg 한 번)
+// worker 는 자기 UE 행을 모았다가 epoch 끝 레코드에서 붙이고, 마지막 worker 가 전송
+typedef struct epoch_frame {
+    pthread_mutex_t lock;
+    sinr_frame_t frame;
+    atomic_size_t pending_workers;  // 아직 행을 붙이지 않은 worker 수
+} epoch_frame_t;
+
+// UE 해시로 나눈 worker: 자기 UE 의 버퍼만 만지므로 UE 상태에는 lock 이 없음
+typedef struct {
+    pthread_t thread;
+    mpsc_ring_t ring;
+    sem_t wake;
+    bool wake_pending;              // 이번 indication 에서 레코드를 받음 (콜백, mtx 안)
+    ue_window_set_t ues;            // ueID -> 이동평균 윈도우
+    sinr_frame_t rows;              // 이번 epoch 의 자기 UE 행 (epoch 끝에서 공유 frame 으로)
+    uint64_t processed;
+} ue_worker_t;
+
+static ue_worker_t workers[MAX_WORKERS];
+static size_t num_workers = 0;
+static atomic_bool workers_running;
+static bool ingest_active = false;  // mtx 안에서 변경
 
 // =============================================================================
 // UTILITY FUNCTIONS
 // =============================================================================
-// UE별 sequence timestamp 저장
-static uint64_t ue_sequence_timestamps[TOTAL_UES + 1] = {0}; // UE ID는 1~28
+// Cell position 조회
+// 시나리오의 cell map 이 있으면 그것을, 없으면 위의 7-cell 테이블을 사용
+static cell_map_index_t cell_map;
 
-static uint64_t assign_sequence_timestamp(uint16_t ue_id) {
-    // 🔥 이미 현재 burst에서 sequence가 할당된 UE면 기존 값 반환
-    if (burst_sequence_assigned[ue_id]) {
-        return ue_sequence_timestamps[ue_id];
+// UE 윈도우 찾기 또는 생성 (worker 의 테이블)
+static ue_window_t* get_or_create_ue_buffer(ue_window_set_t* ues, uint16_t ueID) {
+    bool created = false;
+    ue_window_t* ue_buf = ue_window_set_get(ues, ueID, &created);
+    if (created) {
+        xlog_info("📱 New UE buffer created: UE_%d (worker total: %zu)\n", ueID, ue_window_set_count(ues));
     }
-    
-    // 🔥 새로운 UE면 현재 sequence timestamp 할당
-    ue_sequence_timestamps[ue_id] = current_sequence_timestamp;
-    burst_sequence_assigned[ue_id] = true;
-    current_burst_ue_count++;
-    
-    printf("📊 UE_%d assigned sequence: %lu ms (count: %d/%d)\n", 
-           ue_id, current_sequence_timestamp, current_burst_ue_count, TOTAL_UES);
-    
-    // 🔥 28개 UE가 모두 들어오면 다음 sequence로 준비
-    if (current_burst_ue_count >= TOTAL_UES) {
-        printf("✅ Burst complete! Moving to next sequence: %lu → %lu\n", 
-               current_sequence_timestamp, current_sequence_timestamp + 1);
-        
-        // 다음 burst 준비
-        current_sequence_timestamp += 1;
-        current_burst_ue_count = 0;
-        
-        // 모든 UE의 할당 상태 초기화
-        for (int i = 0; i <= TOTAL_UES; i++) {
-            burst_sequence_assigned[i] = false;
-        }
-    }
-    
-    return ue_sequence_timestamps[ue_id];
+    return ue_buf;  // 메모리 부족이면 NULL
 }
 
-// Cell position 조회
-static cell_position_t* get_cell_position(uint16_t cellID) {
-    for (size_t i = 0; i < NUM_CELLS; i++) {
-        if (cell_positions[i].cellID == cellID) {
-            return &cell_positions[i];
-        }
-    }
-    return NULL;
+
+// =============================================================================
+// 🔥 BINARY FRAME
+// =============================================================================
+
+// text 출력과 같은 값이 되도록 소수점 1자리로
+static float round_1dp(double v) {
+    return (float)(round(v * 10.0) / 10.0);
 }
 
-// UE 버퍼 찾기 또는 생성
-static ue_buffer_t* get_or_create_ue_buffer(uint16_t ueID) {
-    // 기존 UE 찾기
-    for (int i = 0; i < num_active_ues; i++) {
-        if (ue_buffers[i].ueID == ueID) {
-            return &ue_buffers[i];
+static void append_frame_record(sinr_frame_t* frame, sinr_frame_record_t const* record) {
+    if (frame->header.count == frame->cap) {
+        size_t cap = frame->cap ? frame->cap * 2 : 64;
+        sinr_frame_record_t* grown = realloc(frame->records, cap * sizeof(sinr_frame_record_t));
+        if (grown == NULL) {
+            return;
         }
+        frame->records = grown;
+        frame->cap = cap;
     }
-    
-    // 새로운 UE 생성
-    if (num_active_ues < 28) {
-        ue_buffer_t* new_ue = &ue_buffers[num_active_ues];
-        memset(new_ue, 0, sizeof(ue_buffer_t));
-        new_ue->ueID = ueID;
-        num_active_ues++;
-        printf("📱 New UE buffer created: UE_%d (total: %d)\n", ueID, num_active_ues);
-        return new_ue;
-    }
-    
-    return NULL;  // 버퍼 가득참
+    frame->records[frame->header.count++] = *record;
 }
 
-// Orange 스타일 문자열 파싱 함수들
-static struct InfoObj parseServingMsg(const char* msg) {
-    struct InfoObj info;
-    int ret = sscanf(msg, "L3servingSINR3gpp_cell_%hd_UEID_%hd", &info.cellID, &info.ueID);
-    
-    if (ret == 2) return info;
-    
-    info.cellID = -1;
-    info.ueID = -1;
-    return info;
-}
+// header + record 들을 메시지 하나로 spool 에 (연결이 끊겨 있으면 재연결 후 전송)
+static void send_frame(sinr_frame_t* frame) {
+    if (frame->header.count == 0) {
+        return;
+    }
+    memcpy(frame->header.magic, SINR_FRAME_MAGIC, 4);
+    frame->header.version = SINR_FRAME_VERSION;
+    frame->header.record_size = sizeof(sinr_frame_record_t);
 
-static struct InfoObj parseNeighMsg(const char* msg) {
-    struct InfoObj info;
-    int ret = sscanf(msg, "L3neighSINRListOf_UEID_%hd_of_Cell_%hd", &info.ueID, &info.cellID);
-    
-    if (ret == 2) return info;
-    
-    info.ueID = -1;
-    info.cellID = -1;
-    return info;
+    struct iovec iov[2] = {
+        { .iov_base = &frame->header, .iov_len = sizeof(frame->header) },
+        { .iov_base = frame->records, .iov_len = frame->header.count * sizeof(sinr_frame_record_t) },
+    };
+    predictor_link_sendv(&predictor, iov, 2);
+    frame->header.count = 0;
 }
 
-static bool isMeasNameContains(const char* meas_name, const char* name) {
-    return strncmp(meas_name, name, strlen(name)) == 0;
+// 닫힌 epoch 의 공유 frame (콜백, mtx 안): worker 마다 epoch 끝 레코드 하나씩 받음
+static epoch_frame_t* epoch_frame_new(uint64_t epoch, size_t workers) {
+    epoch_frame_t* ef = calloc(1, sizeof(epoch_frame_t));
+    if (ef == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&ef->lock, NULL);
+    ef->frame.header.epoch = epoch;
+    atomic_init(&ef->pending_workers, workers);
+    return ef;
 }
 
+// worker 의 행을 epoch frame 에 붙이고, 마지막 worker 가 전송 후 해제
+static void epoch_frame_release(epoch_frame_t* ef, sinr_frame_t* rows) {
+    if (ef == NULL) {
+        if (rows != NULL) rows->header.count = 0;   // frame 을 못 만든 epoch: 행은 파일에만
+        return;
+    }
+    if (rows != NULL && rows->header.count > 0) {
+        pthread_mutex_lock(&ef->lock);
+        for (uint32_t i = 0; i < rows->header.count; i++) {
+            append_frame_record(&ef->frame, &rows->records[i]);
+        }
+        pthread_mutex_unlock(&ef->lock);
+        rows->header.count = 0;
+    }
+    if (atomic_fetch_sub(&ef->pending_workers, 1) == 1) {
+        send_frame(&ef->frame);   // 다른 worker 는 모두 끝남: lock 없이
+        free(ef->frame.records);
+        pthread_mutex_destroy(&ef->lock);
+        free(ef);
+    }
+}
 
 // =============================================================================
-// 🔥 50개 샘플 이동평균 처리 함수들
+// 🔥 UE 별 출력 (ue_window.h 의 누적 합 이동평균, epoch 마다 한 번)
 // =============================================================================
 
 // UE별 이동평균 계산 및 전송 (학습 데이터와 동일한 방식)
-static void check_and_send_ue_data(ue_buffer_t* ue_buf, uint64_t sequence_timestamp) {
-    
-    if (ue_buf->history_count < 5) {
-        // 진행 상황 표시 (10개 단위)
-        if (ue_buf->history_count % 10 == 0 || ue_buf->history_count <= 5) {
-            printf("📊 UE_%d: Buffering... %d/%d samples collected\n", 
+// ue_window_set 이 닫힌 epoch 에 serving 샘플이 온 UE 마다 호출 (그 epoch 의 neighbor 까지 반영)
+static void check_and_send_ue_data(ue_window_t* ue_buf, uint64_t sequence_timestamp, void* ctx) {
+    sinr_frame_t* frame = ctx;
+
+    if (ue_buf->history_count < MIN_HISTORY_SAMPLES) {
+        xlog_debug("📊 UE_%d: Buffering... %d/%d samples collected\n",
                    ue_buf->ueID, ue_buf->history_count, WINDOW_SIZE);
-        }
         return;
     }
-    printf("🎯 UE_%d: Buffer ready! Starting sliding window transmission...\n", ue_buf->ueID);
-    
-    // 🔥 슬라이딩 윈도우 크기 결정
-    int window_size = (ue_buf->history_count < WINDOW_SIZE) ? 
-                      ue_buf->history_count : WINDOW_SIZE;
-    
-    // 🔥 Serving SINR 슬라이딩 윈도우 이동평균 계산
-    double serving_sinr_sum = 0.0;
-    int valid_serving_count = 0;
-    for (int i = 0; i < window_size; i++) {
-        int read_idx;
-        if (ue_buf->history_count <= WINDOW_SIZE) {
-            read_idx = i;
-        } else {
-            read_idx = (ue_buf->history_idx - WINDOW_SIZE + i + WINDOW_SIZE) % WINDOW_SIZE;
-        }
-        
-        double sinr_val = ue_buf->measurement_history[read_idx].serving_sinr;
-        // 🔥 추가: 유효성 검사
-        if (!isnan(sinr_val)) {
-            serving_sinr_sum += sinr_val;
-            valid_serving_count++;
-        }
-    }
-    
-    double serving_sinr_ma = serving_sinr_sum / valid_serving_count;
-    
-    // 🔥 Neighbor SINR 슬라이딩 윈도우 이동평균 계산
-    typedef struct {
-        uint16_t cellID;
-        double sinr_sum;
-        int count;
-        double avg_sinr;
-    } neighbor_avg_t;
-    
-    neighbor_avg_t neighbor_avgs[50];
-    int unique_neighbors = 0;
-    
-    // 슬라이딩 윈도우 범위에서 neighbor 데이터 수집
-    for (int i = 0; i < window_size; i++) {
-        int read_idx;
-        if (ue_buf->history_count <= WINDOW_SIZE) {
-            read_idx = i;
-        } else {
-            read_idx = (ue_buf->history_idx - WINDOW_SIZE + i + WINDOW_SIZE) % WINDOW_SIZE;
-        }
-        
-        // 해당 시점의 neighbor 데이터 처리
-        for (int j = 0; j < ue_buf->measurement_history[read_idx].active_neighbor_count; j++) {
-            uint16_t neighID = ue_buf->measurement_history[read_idx].neighbor_ids[j];
-            double neighSINR = ue_buf->measurement_history[read_idx].neighbor_sinrs[j];
-
-            if (isnan(neighSINR) || neighID == 0) continue;
-
-            // 기존 neighbor 찾기
-            int found_idx = -1;
-            for (int k = 0; k < unique_neighbors; k++) {
-                if (neighbor_avgs[k].cellID == neighID) {
-                    found_idx = k;
-                    break;
-                }
-            }
-            
-            // 새로운 neighbor 추가 또는 기존 neighbor 업데이트
-            if (found_idx == -1 && unique_neighbors < 50) {
-                neighbor_avgs[unique_neighbors].cellID = neighID;
-                neighbor_avgs[unique_neighbors].sinr_sum = neighSINR;
-                neighbor_avgs[unique_neighbors].count = 1;
-                unique_neighbors++;
-            } else if (found_idx != -1) {
-                neighbor_avgs[found_idx].sinr_sum += neighSINR;
-                neighbor_avgs[found_idx].count++;
-            }
-        }
-    }
-    
-    // 각 neighbor의 평균 계산
-    for (int i = 0; i < unique_neighbors; i++) {
-        neighbor_avgs[i].avg_sinr = neighbor_avgs[i].sinr_sum / neighbor_avgs[i].count;
-    }
-    
-    // SINR 기준으로 정렬 (상위 3개만 사용)
-    for (int i = 0; i < unique_neighbors - 1; i++) {
-        for (int j = i + 1; j < unique_neighbors; j++) {
-            if (neighbor_avgs[i].avg_sinr < neighbor_avgs[j].avg_sinr) {
-                neighbor_avg_t temp = neighbor_avgs[i];
-                neighbor_avgs[i] = neighbor_avgs[j];
-                neighbor_avgs[j] = temp;
-            }
-        }
-    }
-    
-    // Top 3 neighbor 선별
-    double top3_sinr[3] = {0,0,0};  // 기본값을 낮은 값으로
-    
-    // 🔥 neighbor 선별 루프 수정
-    int valid_neighbors_count = 0;
-    for (int i = 0; i < unique_neighbors; i++) {
-        // 🔥 추가: serving cell과 동일한 neighbor 제외
-        if (neighbor_avgs[i].cellID == ue_buf->servingCellID) {
-            printf("⚠️  UE_%d: Skipping neighbor cell %d (same as serving cell)\n", 
-                ue_buf->ueID, neighbor_avgs[i].cellID);
-            continue;  // serving cell과 같으면 건너뛰기
-        }
-        
-        // 기존 조건들
-        if (neighbor_avgs[i].count >= 5) {
-            top3_sinr[valid_neighbors_count] = neighbor_avgs[i].avg_sinr;
-            valid_neighbors_count++;
-            
-            // 3개 채우면 종료
-            if (valid_neighbors_count >= 3) break;
-        }
-    }
-    
+
+    // 🔥 Serving SINR 슬라이딩 윈도우 이동평균 (누적 합)
+    double serving_sinr_ma = ue_window_serving_ma(ue_buf);
+
+    // 🔥 Neighbor SINR 이동평균 상위 3개
+    // serving cell 과 같은 cell, 윈도우 안 샘플이 5개 미만인 cell 제외
+    ue_window_neighbor_t top3[3];
+    int valid_neighbors_count = ue_window_top_neighbors(ue_buf, &window_cfg, 3, top3);
+
     // 🔥 추가: 최소 neighbor 수 체크
     if (valid_neighbors_count < MIN_NEIGHBORS_REQUIRED) {
-        printf("⚠️  UE_%d: Insufficient valid neighbors (%d), skipping transmission\n", 
-               ue_buf->ueID, valid_neighbors_count);
+        xlog_warn("⚠️  UE_%d: Insufficient valid neighbors (%d), skipping transmission\n", 
+                  ue_buf->ueID, valid_neighbors_count);
         return;
     }
     
     // Cell 위치 정보
-    cell_position_t* serving_pos = get_cell_position(ue_buf->servingCellID);
+    cell_map_entry_t const* serving_pos = cell_map_find(&cell_map, ue_buf->servingCellID);
     
     // 🔥 학습 데이터와 동일한 CSV 형태로 출력
     char line[512];
@@ -349,294 +273,230 @@ static void check_and_send_ue_data(ue_buffer_t* ue_buf, uint64_t sequence_timest
         "%lu,%d,%d,%d,%.1f,%.1f,%.1f,%.1f\n",
         sequence_timestamp,  // relative_timestamp (ms)
         ue_buf->ueID,         // imsi
-        serving_pos ? serving_pos->x : 0,  // serving_x
-        serving_pos ? serving_pos->y : 0,  // serving_y
+        serving_pos ? (int)lround(serving_pos->x) : 0,  // serving_x
+        serving_pos ? (int)lround(serving_pos->y) : 0,  // serving_y
         serving_sinr_ma,      // L3 serving SINR 3gpp_ma (소수점 1자리)
-        top3_sinr[0],        // L3 neigh SINR 3gpp 1 (convertedSinr)_ma
-        top3_sinr[1],        // L3 neigh SINR 3gpp 2 (convertedSinr)_ma
-        top3_sinr[2]         // L3 neigh SINR 3gpp 3 (convertedSinr)_ma
+        top3[0].sinr,        // L3 neigh SINR 3gpp 1 (convertedSinr)_ma
+        top3[1].sinr,        // L3 neigh SINR 3gpp 2 (convertedSinr)_ma
+        top3[2].sinr         // L3 neigh SINR 3gpp 3 (convertedSinr)_ma
     );
     
-    // 파일 및 소켓 전송
-    if (log_file) {
-        fprintf(log_file, "%s", line);
-        fflush(log_file);
-    }
+    // 파일 (worker 스레드 버퍼, flush 는 logger 스레드가 묶어서)
+    xlog_write(log_file, line, strlen(line));
     
-    if (socket_connected) {
-        send(socket_fd, line, strlen(line), MSG_NOSIGNAL);
-    }
+    // 소켓은 binary frame 으로 모아서 전송 (receiver 가 없어도 spool 에 쌓임)
+    sinr_frame_record_t record = {
+        .relative_timestamp = sequence_timestamp,
+        .imsi = ue_buf->ueID,
+        .serving_x = serving_pos ? (int)lround(serving_pos->x) : 0,
+        .serving_y = serving_pos ? (int)lround(serving_pos->y) : 0,
+        .serving_sinr = round_1dp(serving_sinr_ma),
+        .neigh_sinr = { round_1dp(top3[0].sinr), round_1dp(top3[1].sinr), round_1dp(top3[2].sinr) },
+    };
+    append_frame_record(frame, &record);
     
     // 🔥 슬라이딩 윈도우 상태 로그
-    if (ue_buf->history_count <= 10 || ue_buf->history_count % 10 == 0) {
-        if (ue_buf->history_count <= WINDOW_SIZE) {
-            printf("📈 UE_%d: MA sent [1~%d] avg=%.1f dB | Total: %d samples\n", 
-                   ue_buf->ueID, window_size, serving_sinr_ma, ue_buf->history_count);
+    if (ue_buf->total_samples <= 10 || ue_buf->total_samples % 10 == 0) {
+        if (ue_buf->total_samples <= WINDOW_SIZE) {
+            xlog_debug("📈 UE_%d: MA sent [1~%d] avg=%.1f dB | Total: %lu samples\n", 
+                       ue_buf->ueID, ue_buf->history_count, serving_sinr_ma, (unsigned long)ue_buf->total_samples);
         } else {
-            int start_sample = ue_buf->history_count - WINDOW_SIZE + 1;
-            int end_sample = ue_buf->history_count;
-            printf("🔄 UE_%d: MA sent [%d~%d] avg=%.1f dB | Sliding window: %d samples\n", 
-                   ue_buf->ueID, start_sample, end_sample, serving_sinr_ma, WINDOW_SIZE);
+            xlog_debug("🔄 UE_%d: MA sent [%lu~%lu] avg=%.1f dB | Sliding window: %d samples\n", 
+                       ue_buf->ueID, (unsigned long)(ue_buf->total_samples - WINDOW_SIZE + 1),
+                       (unsigned long)ue_buf->total_samples, serving_sinr_ma, WINDOW_SIZE);
         }
     }
 }
 
-// UE별 serving SINR 샘플 추가
-static void add_serving_sample(ue_buffer_t* ue_buf, uint16_t cellID, double sinr, uint64_t timestamp) {
-    // 🔥 1. 먼저 sequence timestamp 할당
-    uint64_t sequence_timestamp = assign_sequence_timestamp(ue_buf->ueID);
-    
-    ue_buf->servingCellID = cellID;
-    ue_buf->last_timestamp = timestamp;  // 원본은 last_timestamp에만 저장
-    
-    // 🔥 4. sequence_timestamp를 measurement_history에 저장
-    ue_buf->measurement_history[ue_buf->history_idx].serving_sinr = sinr;
-    ue_buf->measurement_history[ue_buf->history_idx].timestamp = sequence_timestamp; // ✅ sequence 사용
-    ue_buf->measurement_history[ue_buf->history_idx].active_neighbor_count = 0;
-    
-    // Circular index 업데이트
-    ue_buf->history_idx = (ue_buf->history_idx + 1) % WINDOW_SIZE;
-    if (ue_buf->history_count < WINDOW_SIZE) {
-        ue_buf->history_count++;
-    }
-    
-    // 🔥 5. sequence_timestamp를 check_and_send_ue_data에 전달
-    check_and_send_ue_data(ue_buf, sequence_timestamp); // ✅ sequence 사용
+// =============================================================================
+// 🔥 WORKERS (UE 해시 샤딩)
+// =============================================================================
+
+static ue_worker_t* worker_of(uint16_t ueID) {
+    return &workers[ue_table_hash(ueID, 1u << 16) % num_workers];
 }
 
-// UE별 neighbor SINR 샘플 추가   🔥 추가: neighbor 데이터 수집 시에도 serving cell 체크
-static void add_neighbor_sample(ue_buffer_t* ue_buf, uint16_t neighCellID, double sinr) {
-    // serving cell과 같은 neighbor는 무시
-    if (neighCellID == ue_buf->servingCellID) {
-        return;  // serving cell과 같으면 추가하지 않음
-    }
-    
-    // 기존 로직 계속...
-    int current_idx = (ue_buf->history_idx - 1 + WINDOW_SIZE) % WINDOW_SIZE;
-    
-    if (ue_buf->measurement_history[current_idx].active_neighbor_count < 10) {
-        int n_idx = ue_buf->measurement_history[current_idx].active_neighbor_count;
-        ue_buf->measurement_history[current_idx].neighbor_ids[n_idx] = neighCellID;
-        ue_buf->measurement_history[current_idx].neighbor_sinrs[n_idx] = sinr;
-        ue_buf->measurement_history[current_idx].active_neighbor_count++;
+// 콜백 (mtx 안): 레코드 복사만, worker 는 indication 끝에 깨움
+static void push_ue_sample(ue_sample_t const* sample) {
+    ue_worker_t* w = worker_of(sample->ueID);
+    if (mpsc_ring_push(&w->ring, sample)) {
+        w->wake_pending = true;
     }
 }
 
-// Neighbor 정렬을 위한 구조체
-typedef struct {
-    uint16_t cellID;
-    double avg_sinr;
-} neighbor_rank_t;
-
-// =============================================================================
-// SOCKET COMMUNICATION
-// =============================================================================
-
-static bool init_unix_socket(void) {
-    struct sockaddr_un addr;
-    
-    socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (socket_fd == -1) {
-        printf("[SOCKET] Failed to create socket: %s\n", strerror(errno));
-        return false;
-    }
-    
-    memset(&addr, 0, sizeof(addr));
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
-    
-    for (int i = 0; i < 5; i++) {
-        if (connect(socket_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
-            socket_connected = true;
-            printf("[SOCKET] ✅ Connected to Python receiver at %s\n", SOCKET_PATH);
-            return true;
-        }
-        
-        if (i == 0) {
-            printf("[SOCKET] ⚠️  Python receiver not ready. Retrying...\n");
+// aligner (콜백, mtx 안): 닫힌 epoch 의 샘플을 도착 순서대로 worker 로,
+// 그 뒤 모든 worker 에 epoch 끝 레코드 (epoch 의 frame 은 마지막 worker 가 한 번 전송)
+static void on_epoch_closed(epoch_batch_t const* batch, void* ctx) {
+    epoch_aligner_t const* a = ctx;
+    for (size_t i = 0; i < batch->count; i++) {
+        ue_sample_t sample = *(ue_sample_t const*)epoch_batch_at(a, batch, i);
+        sample.sequence_timestamp = batch->sequence;
+        push_ue_sample(&sample);
+    }
+
+    epoch_frame_t* ef = epoch_frame_new(batch->epoch, num_workers);
+    ue_sample_t end = {
+        .type = UE_SAMPLE_EPOCH_END,
+        .timestamp = batch->epoch,
+        .sequence_timestamp = batch->sequence,
+        .frame = ef,
+    };
+    for (size_t i = 0; i < num_workers; i++) {
+        if (mpsc_ring_push(&workers[i].ring, &end)) {
+            workers[i].wake_pending = true;
+        } else {
+            epoch_frame_release(ef, NULL);   // ring 이 가득 찬 worker 몫
         }
-        sleep(1);
     }
-    
-    printf("[SOCKET] ❌ Failed to connect after 5 attempts\n");
-    close(socket_fd);
-    socket_fd = -1;
-    return false;
+    xlog_debug("✅ Epoch %lu closed: sequence %lu, %zu samples\n",
+               (unsigned long)batch->epoch, (unsigned long)batch->sequence, batch->count);
 }
 
-static void close_unix_socket(void) {
-    if (socket_fd != -1) {
-        close(socket_fd);
-        socket_fd = -1;
-        socket_connected = false;
-        printf("[SOCKET] 🔌 Socket closed\n");
+static void process_ue_sample(ue_worker_t* w, ue_sample_t const* sample) {
+    if (sample->type == UE_SAMPLE_EPOCH_END) {
+        ue_window_set_flush(&w->ues);   // 이 epoch 의 UE 행을 rows 로
+        epoch_frame_release(sample->frame, &w->rows);
+        return;
     }
-}
-// =============================================================================
-// MEASUREMENT PROCESSING
-// =============================================================================
-
-static void log_kpm_measurements(kpm_ind_msg_format_1_t const* msg_frm_1, uint64_t simulation_timestamp) {
-    assert(msg_frm_1->meas_info_lst_len > 0);
-    
-    if(msg_frm_1->meas_info_lst_len != msg_frm_1->meas_data_lst_len) {
+    ue_window_t* ue_buf = get_or_create_ue_buffer(&w->ues, sample->ueID);
+    if (ue_buf == NULL) {
         return;
     }
+    // sequence_timestamp: 콜백의 epoch aligner 가 epoch 단위로 할당한 값
+    if (sample->type == KPM_SAMPLE_SERVING) {
+        ue_window_set_add_serving(&w->ues, ue_buf, sample->cellID, sample->sinr, sample->timestamp,
+                                  sample->sequence_timestamp);
+    } else {
+        ue_window_set_add_neighbor(&w->ues, ue_buf, sample->cellID, sample->sinr);
+    }
+}
 
-    // serving 정보 수집 및 50개 샘플 체크
-    for(size_t i = 0; i < msg_frm_1->meas_info_lst_len; i++) {
-        meas_type_t const meas_type = msg_frm_1->meas_info_lst[i].meas_type;
-        meas_data_lst_t const data_item = msg_frm_1->meas_data_lst[i];
-        
-        if(meas_type.type == NAME_MEAS_TYPE) {
-            if(isMeasNameContains((char*)meas_type.name.buf, "L3servingSINR3gpp_cell_")) {
-                struct InfoObj info = parseServingMsg((char*)meas_type.name.buf);
-                
-                if(info.cellID != UINT16_MAX && info.ueID != UINT16_MAX && 
-                   data_item.meas_record_len > 0) {
-                    
-                    meas_record_lst_t const record_item = data_item.meas_record_lst[0];
-                    
-                    if(record_item.value == REAL_MEAS_VALUE || record_item.value == INTEGER_MEAS_VALUE) {
-                        double sinr = (record_item.value == REAL_MEAS_VALUE) ? 
-                                     record_item.real_val : (double)record_item.int_val;
-                        
-                        ue_buffer_t* ue_buf = get_or_create_ue_buffer(info.ueID);
-                        if (ue_buf) {
-                            add_serving_sample(ue_buf, info.cellID, sinr, simulation_timestamp);
-                        }
-                    }
-                }
-            }
+static void* ue_worker_main(void* arg) {
+    ue_worker_t* w = arg;
+    ue_sample_t sample;
+    for (;;) {
+        bool running = atomic_load(&workers_running);
+        size_t n = 0;
+        while (mpsc_ring_pop(&w->ring, &sample)) {
+            process_ue_sample(w, &sample);
+            n += sample.type != UE_SAMPLE_EPOCH_END;
         }
-    }
-    
-    // neighbor 정보 수집
-    for(size_t i = 0; i < msg_frm_1->meas_info_lst_len; i++) {
-        meas_type_t const meas_type = msg_frm_1->meas_info_lst[i].meas_type;
-        meas_data_lst_t const data_item = msg_frm_1->meas_data_lst[i];
-        
-        if(meas_type.type == NAME_MEAS_TYPE) {
-            if(isMeasNameContains((char*)meas_type.name.buf, "L3neighSINRListOf_UEID_")) {
-                struct InfoObj info = parseNeighMsg((char*)meas_type.name.buf);
-                
-                if(info.cellID != UINT16_MAX && info.ueID != UINT16_MAX) {
-                    ue_buffer_t* ue_buf = get_or_create_ue_buffer(info.ueID);
-                    if (ue_buf) {
-                        // neighbor 데이터 수집
-                        for(size_t j = 0; j + 1 < data_item.meas_record_len; j += 2) {
-                            meas_record_lst_t const sinr = data_item.meas_record_lst[j];
-                            meas_record_lst_t const neighID = data_item.meas_record_lst[j + 1];
-                            
-                            if(sinr.value == REAL_MEAS_VALUE && neighID.value == INTEGER_MEAS_VALUE) {
-                                add_neighbor_sample(ue_buf, neighID.int_val, sinr.real_val);
-                            }
-                        }
-                    }
-                }
-            }
+        w->processed += n;
+        // 종료 요청 뒤에도 ring 은 끝까지 비움
+        if (!running) {
+            break;
         }
+        sem_wait(&w->wake);
     }
+    return NULL;
 }
 
-// =============================================================================
-// KPM RELATED FUNCTIONS
-// =============================================================================
-
-static label_info_lst_t fill_kpm_label(void) {
-    label_info_lst_t label_item = {0};
-    label_item.noLabel = ecalloc(1, sizeof(enum_value_e));
-    *label_item.noLabel = TRUE_ENUM_VALUE;
-    return label_item;
+static size_t default_num_workers(void) {
+    const char* env = getenv("XAPP_WORKERS");
+    long n = env != NULL ? atol(env) : sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if (n < 1) n = 1;
+    if (n > MAX_WORKERS) n = MAX_WORKERS;
+    return (size_t)n;
 }
 
-static test_info_lst_t filter_predicate(test_cond_type_e type, test_cond_e cond, int value) {
-    test_info_lst_t dst = {0};
-
-    dst.test_cond_type = type;
-    dst.IsStat = TRUE_TEST_COND_TYPE;
-
-    dst.test_cond = calloc(1, sizeof(test_cond_e));
-    assert(dst.test_cond != NULL && "Memory allocation failed for test_cond");
-    *dst.test_cond = cond;
-
-    dst.test_cond_value = calloc(1, sizeof(test_cond_value_t));
-    assert(dst.test_cond_value != NULL && "Memory allocation failed for test_cond_value");
-    dst.test_cond_value->type = INTEGER_TEST_COND_VALUE;
-
-    int64_t *int_value = calloc(1, sizeof(int64_t));
-    assert(int_value != NULL && "Memory allocation failed for int_value");
-    *int_value = value; 
-    dst.test_cond_value->int_value = int_value;
-    return dst;
+static void start_workers(size_t n) {
+    num_workers = n;
+    atomic_store(&workers_running, true);
+    for (size_t i = 0; i < num_workers; i++) {
+        ue_worker_t* w = &workers[i];
+        bool ok = mpsc_ring_init(&w->ring, WORKER_RING_CAPACITY, sizeof(ue_sample_t));
+        assert(ok && "Memory exhausted");
+        (void)ok;
+        sem_init(&w->wake, 0, 0);
+        ue_window_set_init(&w->ues, window_cfg, check_and_send_ue_data, &w->rows);
+        int rc = pthread_create(&w->thread, NULL, ue_worker_main, w);
+        assert(rc == 0);
+        (void)rc;
+    }
+    xlog_info("[INIT] 🧵 %zu worker(s), ring %d records each\n", num_workers, WORKER_RING_CAPACITY);
 }
 
-static kpm_act_def_format_1_t fill_act_def_frm_1(ric_report_style_item_t const* report_item) {
-    assert(report_item != NULL);
-
-    kpm_act_def_format_1_t ad_frm_1 = {0};
-    size_t const sz = report_item->meas_info_for_action_lst_len;
-
-    ad_frm_1.meas_info_lst_len = sz;
-    ad_frm_1.meas_info_lst = calloc(sz, sizeof(meas_info_format_1_lst_t));
-    assert(ad_frm_1.meas_info_lst != NULL && "Memory exhausted");
-
-    for (size_t i = 0; i < sz; i++) {
-        meas_info_format_1_lst_t* meas_item = &ad_frm_1.meas_info_lst[i];
-        meas_item->meas_type.type = NAME_MEAS_TYPE;
-        meas_item->meas_type.name = copy_byte_array(report_item->meas_info_for_action_lst[i].name);
+static void stop_workers(void) {
+    atomic_store(&workers_running, false);
+    for (size_t i = 0; i < num_workers; i++) {
+        sem_post(&workers[i].wake);
+    }
+    for (size_t i = 0; i < num_workers; i++) {
+        ue_worker_t* w = &workers[i];
+        pthread_join(w->thread, NULL);
+        xlog_info("🧵 Worker %zu: %lu records, %lu dropped, %zu UEs\n", i, w->processed,
+                  (unsigned long)mpsc_ring_dropped(&w->ring), ue_window_set_count(&w->ues));
+        ue_window_set_free(&w->ues);
+        free(w->rows.records);
+        memset(&w->rows, 0, sizeof(w->rows));
+        mpsc_ring_free(&w->ring);
+        sem_destroy(&w->wake);
+    }
+    num_workers = 0;
+}
 
-        meas_item->label_info_lst_len = 1;
-        meas_item->label_info_lst = ecalloc(1, sizeof(label_info_lst_t));
-        meas_item->label_info_lst[0] = fill_kpm_label();
+static void wake_workers(void) {
+    for (size_t i = 0; i < num_workers; i++) {
+        if (workers[i].wake_pending) {
+            workers[i].wake_pending = false;
+            sem_post(&workers[i].wake);
+        }
     }
+}
 
-    ad_frm_1.gran_period_ms = period_ms;
-    ad_frm_1.cell_global_id = NULL;
+static void print_worker_stats(void) {
+    if (aligner.late_records > 0) {
+        xlog_warn("⚠️  Late indications: %lu samples behind the epoch watermark dropped\n",
+                  (unsigned long)aligner.late_records);
+    }
+    uint64_t dropped = 0;
+    for (size_t i = 0; i < num_workers; i++) {
+        dropped += mpsc_ring_dropped(&workers[i].ring);
+    }
+    if (dropped > 0) {
+        xlog_warn("⚠️  Worker rings full: %lu records dropped\n", (unsigned long)dropped);
+    }
+}
 
-#if defined KPM_V2_03 || defined KPM_V3_00
-    ad_frm_1.meas_bin_range_info_lst_len = 0;
-    ad_frm_1.meas_bin_info_lst = NULL;
-#endif
+// =============================================================================
+// MEASUREMENT PROCESSING
+// =============================================================================
 
-    return ad_frm_1;
+// kpm_ingest 샘플 콜백 (mtx 안): collectStartTime 별 epoch batch 로, sequence timestamp 는 epoch 이 닫힐 때 할당
+static void on_kpm_sample(kpm_sample_t const* s, void* ctx) {
+    (void)ctx;
+    ue_sample_t sample = {
+        .type = s->type,
+        .ueID = s->ueID,
+        .cellID = s->cellID,
+        .sinr = s->sinr,
+        .timestamp = s->timestamp,
+    };
+    epoch_aligner_add(&aligner, s->timestamp, &sample);
 }
 
+static kpm_ingest_t ingest;   // 측정 이름 캐시 + 파서 상태 (콜백은 mtx 안에서 실행)
+
 // =============================================================================
 // CALLBACK FUNCTIONS
 // =============================================================================
 
 static void sm_cb_kpm(sm_ag_if_rd_t const* rd) {
-    assert(rd != NULL);
-    assert(rd->type == INDICATION_MSG_AGENT_IF_ANS_V0);
-    assert(rd->ind.type == KPM_STATS_V3_0);
-
-    kpm_ind_data_t const* ind = &rd->ind.kpm.ind;
-    kpm_ric_ind_hdr_format_1_t const* hdr_frm_1 = &ind->hdr.kpm_ric_ind_hdr_format_1;
-    kpm_ind_msg_format_3_t const* msg_frm_3 = &ind->msg.frm_3;
-
     {
         lock_guard(&mtx);
-        
-        // CSV 헤더 출력 (첫 번째 indication에서만)
-        if (indication_counter == 0) {
-            if (log_file) {
-                fprintf(log_file, "relative_timestamp,imsi,serving_x,serving_y,L3 serving SINR 3gpp_ma,L3 neigh SINR 3gpp 1 (convertedSinr)_ma,L3 neigh SINR 3gpp 2 (convertedSinr)_ma,L3 neigh SINR 3gpp 3 (convertedSinr)_ma\n");
-                fflush(log_file);
-            }
-            printf("📋 CSV header written\n");
+        if (!ingest_active) {
+            return;   // 종료 중
         }
         
         indication_counter++;
 
         // 🔥 시뮬레이션 시간 사용
-        uint64_t simulation_time = hdr_frm_1->collectStartTime;
+        uint64_t simulation_time = kpm_ingest_collect_start_time(rd);
+        indication_jitter_on_indication(&ind_jitter, simulation_time, time_now_us());
         
-        // UE별 측정값 처리 (버퍼에 누적)
-        for (size_t i = 0; i < msg_frm_3->ue_meas_report_lst_len; i++) {
-            log_kpm_measurements(&msg_frm_3->meas_report_per_ue[i].ind_msg_format_1, 
-                                simulation_time);
-        }
+        // UE별 측정값을 epoch batch 로, 닫힌 epoch 은 worker ring 으로 (이동평균/출력은 worker 에서)
+        kpm_ingest_indication(&ingest, rd);
+        wake_workers();
     }
 }
 
@@ -644,58 +504,10 @@ static void sm_cb_kpm(sm_ag_if_rd_t const* rd) {
 // HELPER FUNCTIONS
 // =============================================================================
 
-static bool eq_sm(sm_ran_function_t const* elem, int const id) {
-    return elem->id == id;
-}
-
-static size_t find_sm_idx(sm_ran_function_t* rf, size_t sz, 
-                         bool (*f)(sm_ran_function_t const*, int const), int const id) {
-    for (size_t i = 0; i < sz; i++) {
-        if (f(&rf[i], id))
-            return i;
-    }
-    assert(0 != 0 && "SM ID could not be found in the RAN Function List");
-}
-
 static void signal_handler(int signal) {
     (void)signal;
     printf("\n🛑 Received signal %d\n", signal);
-    monitoring_active = false;
-    close_unix_socket();
-}
-
-static kpm_sub_data_t gen_kpm_subs(kpm_ran_function_def_t const* ran_func) {
-    assert(ran_func != NULL);
-    assert(ran_func->ric_event_trigger_style_list != NULL);
-
-    kpm_sub_data_t kpm_sub = {0};
-
-    assert(ran_func->ric_event_trigger_style_list[0].format_type == FORMAT_1_RIC_EVENT_TRIGGER);
-    kpm_sub.ev_trg_def.type = FORMAT_1_RIC_EVENT_TRIGGER;
-    kpm_sub.ev_trg_def.kpm_ric_event_trigger_format_1.report_period_ms = period_ms;
-
-    kpm_sub.sz_ad = 1;
-    kpm_sub.ad = calloc(kpm_sub.sz_ad, sizeof(kpm_act_def_t));
-    assert(kpm_sub.ad != NULL && "Memory exhausted");
-
-    ric_report_style_item_t* const report_item = &ran_func->ric_report_style_list[0];
-    
-    if(report_item->act_def_format_type == FORMAT_4_ACTION_DEFINITION) {
-        kpm_sub.ad[0].type = FORMAT_4_ACTION_DEFINITION;
-        
-        kpm_sub.ad[0].frm_4.matching_cond_lst_len = 1;
-        kpm_sub.ad[0].frm_4.matching_cond_lst = calloc(1, sizeof(matching_condition_format_4_lst_t));
-        
-        test_cond_type_e const type = IsStat_TEST_COND_TYPE;
-        test_cond_e const condition = GREATERTHAN_TEST_COND; // 무조건보내게설정
-        int const value = 2; // 무조건보내게설정
-        kpm_sub.ad[0].frm_4.matching_cond_lst[0].test_info_lst = 
-            filter_predicate(type, condition, value);
-        
-        kpm_sub.ad[0].frm_4.action_def_format_1 = fill_act_def_frm_1(report_item);
-    }
-
-    return kpm_sub;
+    monitoring_active = false;   // socket 은 worker 종료 후 main 에서 닫음
 }
 
 // =============================================================================
@@ -703,21 +515,33 @@ static kpm_sub_data_t gen_kpm_subs(kpm_ran_function_def_t const* ran_func) {
 // =============================================================================
 
 int main(int argc, char *argv[]) {
+    xlog_init();
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
+    cell_map_load_index(&cell_map, cell_positions, sizeof(cell_positions) / sizeof(cell_positions[0]));
+    kpm_ingest_init(&ingest, on_kpm_sample, NULL);
+    epoch_aligner_init(&aligner, sizeof(ue_sample_t), period_ms, epoch_aligner_default_window(), on_epoch_closed, &aligner);
+    xlog_info("[INIT] 🕒 Epoch reorder window: %zu epoch(s)\n", aligner.reorder_window);
+    indication_jitter_init(&ind_jitter, period_ms, "indication_jitter_3gpp.csv");
+
     // CSV 로그 파일 열기
-    log_file = fopen("lstm_input_data.csv", "w");
+    log_file = xlog_open("lstm_input_data.csv");
     if (log_file == NULL) {
-        printf("⚠️  Failed to open log file\n");
+        xlog_warn("⚠️  Failed to open log file\n");
+    } else {
+        xlog_printf(log_file, "relative_timestamp,imsi,serving_x,serving_y,L3 serving SINR 3gpp_ma,L3 neigh SINR 3gpp 1 (convertedSinr)_ma,L3 neigh SINR 3gpp 2 (convertedSinr)_ma,L3 neigh SINR 3gpp 3 (convertedSinr)_ma\n");
+        xlog_info("📋 CSV header written (%s)\n", xlog_path(log_file));
     }
 
-    // Unix Socket 초기화
-    printf("[INIT] 🔥 Connecting to Python receiver (5-second interval mode)...\n");
-    if (init_unix_socket()) {
-        printf("[INIT] ✅ Python integration enabled\n");
+    // Unix Socket 초기화 (non-blocking, 끊기면 backoff 로 재연결)
+    xlog_info("[INIT] 🔥 Connecting to Python receiver...\n");
+    predictor_link_init(&predictor, SOCKET_PATH);
+    predictor_link_poll(&predictor);
+    if (predictor_link_connected(&predictor)) {
+        xlog_info("[INIT] ✅ Python integration enabled\n");
     } else {
-        printf("[INIT] ⚠️  Running without Python integration\n");
+        xlog_warn("[INIT] ⚠️  Python receiver not ready, spooling until it connects (%zu bytes)\n", predictor.cap);
     }
 
     fr_args_t args = init_fr_args(argc, argv);
@@ -732,36 +556,48 @@ int main(int argc, char *argv[]) {
     int rc = pthread_mutex_init(&mtx, &attr);
     assert(rc == 0);
 
-    sm_ans_xapp_t* hndl = calloc(nodes.len, sizeof(sm_ans_xapp_t));
-    assert(hndl != NULL);
-
-    int const KPM_ran_function = 2;
-    for (size_t i = 0; i < nodes.len; ++i) {
-        e2_node_connected_xapp_t* n = &nodes.n[i];
-        size_t const idx = find_sm_idx(n->rf, n->len_rf, eq_sm, KPM_ran_function);
-        
-        if (idx < n->len_rf && 
-            n->rf[idx].defn.type == KPM_RAN_FUNC_DEF_E &&
-            n->rf[idx].defn.kpm.ric_report_style_list != NULL) {
-            
-            kpm_sub_data_t kpm_sub = gen_kpm_subs(&n->rf[idx].defn.kpm);
-            hndl[i] = report_sm_xapp_api(&n->id, KPM_ran_function, &kpm_sub, sm_cb_kpm);
-            assert(hndl[i].success == true);
-            free_kpm_sub_data(&kpm_sub);
-        }
+    start_workers(default_num_workers());
+    {
+        lock_guard(&mtx);
+        ingest_active = true;
     }
 
+    sm_ans_xapp_t* hndl = kpm_ingest_subscribe(&nodes, period_ms, kpm_filter, sm_cb_kpm);
+
     // 메인 루프
+    int loop_count = 0;
     while(monitoring_active) {
         usleep(100000);
+        predictor_link_poll(&predictor);   // 재연결 + spool 전송
+        // 10초마다 indication 도착 간격 통계 출력
+        if (++loop_count % 100 == 0) {
+            predictor_link_print(&predictor);
+            lock_guard(&mtx);
+            indication_jitter_print(&ind_jitter);
+            print_worker_stats();
+        }
     }
 
     // cleanup
-    printf("\n🛑 Shutting down...\n");
-    close_unix_socket();
-    if (log_file != NULL) {
-        fclose(log_file);
+    xlog_info("\n🛑 Shutting down...\n");
+    kpm_ingest_unsubscribe(hndl, nodes.len);
+    {
+        lock_guard(&mtx);   // 늦게 도착한 indication 콜백은 더 이상 ring 에 넣지 않음
+        ingest_active = false;
+        epoch_aligner_flush(&aligner);   // 아직 열린 epoch 도 worker 로
+        wake_workers();
+    }
+    stop_workers();         // 남은 레코드 처리 후 종료
+    predictor_link_print(&predictor);
+    predictor_link_close(&predictor, 1000);   // 남은 spool 은 1초까지 전송
+    {
+        lock_guard(&mtx);
+        epoch_aligner_free(&aligner);
+        kpm_ingest_free(&ingest);
     }
+    indication_jitter_close(&ind_jitter);
+    xlog_close(log_file);
+    xlog_shutdown();
 
     return 0;
 }
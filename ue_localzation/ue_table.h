@@ -0,0 +1,165 @@
+/*
+ * IMSI-keyed UE table shared by the xApps
+ * 🔥 고정 크기 UE 배열 + 선형 탐색 대신 open addressing 해시 + slab 저장소
+ *
+ * Values live in slabs of UE_TABLE_SLAB_VALUES entries that are never moved,
+ * so the pointers returned by ue_table_get_or_create stay valid while the
+ * table grows. The index is a linear-probing hash (load factor <= 1/2) from
+ * the key to the insertion number, which is also the iteration order of
+ * ue_table_at. New values are zeroed.
+ */
+
+#ifndef UE_TABLE_H
+#define UE_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UE_TABLE_SLAB_VALUES 256
+#define UE_TABLE_INITIAL_CAPACITY 64   // hash slots, power of two
+
+typedef struct {
+    size_t value_size;
+    size_t count;
+
+    // value storage: slabs[i / UE_TABLE_SLAB_VALUES] + (i % UE_TABLE_SLAB_VALUES) * value_size
+    unsigned char** slabs;
+    size_t num_slabs;
+
+    // hash index: slot_keys[s] valid when slot_index[s] != 0 (insertion number + 1)
+    uint64_t* slot_keys;
+    uint32_t* slot_index;
+    size_t capacity;
+} ue_table_t;
+
+static inline size_t ue_table_hash(uint64_t key, size_t capacity) {
+    // splitmix64 finalizer: consecutive IMSIs spread over the whole table
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return (size_t)key & (capacity - 1);
+}
+
+static inline void ue_table_init(ue_table_t* t, size_t value_size) {
+    memset(t, 0, sizeof(*t));
+    t->value_size = value_size;
+}
+
+static inline void* ue_table_at(ue_table_t const* t, size_t i) {
+    return t->slabs[i / UE_TABLE_SLAB_VALUES] + (i % UE_TABLE_SLAB_VALUES) * t->value_size;
+}
+
+static inline size_t ue_table_count(ue_table_t const* t) {
+    return t->count;
+}
+
+static inline void* ue_table_find(ue_table_t const* t, uint64_t key) {
+    if (t->capacity == 0) {
+        return NULL;
+    }
+    for (size_t s = ue_table_hash(key, t->capacity);; s = (s + 1) & (t->capacity - 1)) {
+        if (t->slot_index[s] == 0) {
+            return NULL;
+        }
+        if (t->slot_keys[s] == key) {
+            return ue_table_at(t, t->slot_index[s] - 1);
+        }
+    }
+}
+
+static inline bool ue_table_rehash(ue_table_t* t, size_t capacity) {
+    uint64_t* keys = calloc(capacity, sizeof(uint64_t));
+    uint32_t* index = calloc(capacity, sizeof(uint32_t));
+    if (keys == NULL || index == NULL) {
+        free(keys);
+        free(index);
+        return false;
+    }
+    for (size_t old = 0; old < t->capacity; old++) {
+        if (t->slot_index[old] == 0) {
+            continue;
+        }
+        size_t s = ue_table_hash(t->slot_keys[old], capacity);
+        while (index[s] != 0) {
+            s = (s + 1) & (capacity - 1);
+        }
+        keys[s] = t->slot_keys[old];
+        index[s] = t->slot_index[old];
+    }
+    free(t->slot_keys);
+    free(t->slot_index);
+    t->slot_keys = keys;
+    t->slot_index = index;
+    t->capacity = capacity;
+    return true;
+}
+
+// Returns the value of key, a zeroed one if it is new (*created set), NULL if out of memory
+static inline void* ue_table_get_or_create(ue_table_t* t, uint64_t key, bool* created) {
+    if (created != NULL) {
+        *created = false;
+    }
+    void* found = ue_table_find(t, key);
+    if (found != NULL) {
+        return found;
+    }
+
+    if ((t->count + 1) * 2 > t->capacity &&
+        !ue_table_rehash(t, t->capacity ? t->capacity * 2 : UE_TABLE_INITIAL_CAPACITY)) {
+        return NULL;
+    }
+
+    // storage: a slab is allocated the first time one of its values is used
+    size_t slab = t->count / UE_TABLE_SLAB_VALUES;
+    if (slab == t->num_slabs) {
+        unsigned char** slabs = realloc(t->slabs, (t->num_slabs + 1) * sizeof(*slabs));
+        if (slabs == NULL) {
+            return NULL;
+        }
+        t->slabs = slabs;
+        t->slabs[slab] = calloc(UE_TABLE_SLAB_VALUES, t->value_size);
+        if (t->slabs[slab] == NULL) {
+            return NULL;
+        }
+        t->num_slabs++;
+    }
+
+    size_t s = ue_table_hash(key, t->capacity);
+    while (t->slot_index[s] != 0) {
+        s = (s + 1) & (t->capacity - 1);
+    }
+    t->slot_keys[s] = key;
+    t->slot_index[s] = (uint32_t)(t->count + 1);
+
+    void* value = ue_table_at(t, t->count);
+    memset(value, 0, t->value_size);
+    t->count++;
+    if (created != NULL) {
+        *created = true;
+    }
+    return value;
+}
+
+// Drops all the entries, the storage is kept for reuse
+static inline void ue_table_clear(ue_table_t* t) {
+    if (t->capacity > 0) {
+        memset(t->slot_index, 0, t->capacity * sizeof(uint32_t));
+    }
+    t->count = 0;
+}
+
+static inline void ue_table_free(ue_table_t* t) {
+    for (size_t i = 0; i < t->num_slabs; i++) {
+        free(t->slabs[i]);
+    }
+    free(t->slabs);
+    free(t->slot_keys);
+    free(t->slot_index);
+    ue_table_init(t, t->value_size);
+}
+
+#endif // UE_TABLE_H
@@ -0,0 +1,321 @@
+/*
+ * Per-UE SINR windows shared by the xApps
+ * 🔥 UE 별 측정 윈도우: 누적 합 이동평균, 상위 K neighbor, sequence 가 바뀌면 방출
+ *
+ * Each UE keeps the last cfg.size serving samples (one history slot per
+ * serving sample, the neighbor samples that follow it are attached to that
+ * slot) and running sums over the window: a new slot is added to the sums and
+ * the slot it overwrites is subtracted, so the moving average and the
+ * neighbor ranking cost O(neighbor cells) per sample instead of a pass over
+ * the window. The sums are recomputed once per window turn so the rounding
+ * error of the additions and subtractions does not build up.
+ *
+ * Neighbor samples of the serving cell, of cellID 0 or with a NaN SINR are not
+ * stored. ue_window_top_neighbors ranks the neighbor cells with at least
+ * cfg.min_neighbor_samples samples in the window by their average; a window
+ * of 1 gives the instantaneous values.
+ *
+ * A ue_window_set_t owns the windows of a group of UEs (ue_table.h) and the
+ * UEs that got a serving sample in the current sequence: they are passed to
+ * the emit callback once per sequence, in arrival order, when a serving
+ * sample of another sequence arrives or on ue_window_set_flush (epoch close).
+ * A set is not thread safe; the 3gpp xApp keeps one per worker.
+ */
+
+#ifndef UE_WINDOW_H
+#define UE_WINDOW_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ue_table.h"
+
+#define UE_WINDOW_MAX 50                 // 윈도우 최대 샘플 수
+#define UE_WINDOW_SLOT_NEIGHBORS 10      // serving 샘플 하나에 붙는 neighbor 최대 개수
+#define UE_WINDOW_MAX_NEIGHBORS 50       // 윈도우 안의 서로 다른 neighbor cell 최대 개수
+
+typedef struct {
+    int size;                    // 윈도우 샘플 수 (1 ~ UE_WINDOW_MAX)
+    int min_neighbor_samples;    // 순위에 넣을 neighbor 의 윈도우 안 최소 샘플 수
+} ue_window_cfg_t;
+
+// serving 샘플 하나 + 뒤따르는 neighbor 샘플들
+typedef struct {
+    double serving_sinr;
+    double neighbor_sinrs[UE_WINDOW_SLOT_NEIGHBORS];
+    uint16_t neighbor_ids[UE_WINDOW_SLOT_NEIGHBORS];
+    int active_neighbor_count;
+    uint64_t timestamp;          // sequence timestamp
+} ue_window_slot_t;
+
+// ue_window_top_neighbors 결과
+typedef struct {
+    uint16_t cellID;
+    double sinr;                 // 윈도우 평균
+} ue_window_neighbor_t;
+
+typedef struct {
+    uint16_t ueID;
+    uint16_t servingCellID;
+
+    ue_window_slot_t history[UE_WINDOW_MAX];
+    int history_idx;             // 다음 쓰기 위치
+    int history_count;           // 윈도우 안 샘플 수
+    uint64_t total_samples;      // 누적 serving 샘플 수
+    uint64_t last_timestamp;     // collectStartTime
+
+    // 윈도우 누적 합: 새 샘플은 더하고, 윈도우에서 밀려나는 샘플은 빼기
+    double serving_sinr_sum;
+    int serving_valid_count;
+    struct {
+        uint16_t cellID;
+        double sinr_sum;
+        int count;
+    } window_neighbors[UE_WINDOW_MAX_NEIGHBORS];
+    int window_neighbor_count;
+    int samples_since_resync;
+
+    bool pending;                // 이번 sequence 에 serving 샘플을 받았고 아직 방출 안 함
+} ue_window_t;
+
+// =============================================================================
+// PER-UE WINDOW
+// =============================================================================
+
+// cellID 의 누적 항목 (없으면 create 일 때만 추가)
+static inline int ue_window_find_neighbor(ue_window_t* w, uint16_t cellID, bool create) {
+    for (int k = 0; k < w->window_neighbor_count; k++) {
+        if (w->window_neighbors[k].cellID == cellID) {
+            return k;
+        }
+    }
+    if (!create || w->window_neighbor_count >= UE_WINDOW_MAX_NEIGHBORS) {
+        return -1;
+    }
+    int k = w->window_neighbor_count++;
+    w->window_neighbors[k].cellID = cellID;
+    w->window_neighbors[k].sinr_sum = 0.0;
+    w->window_neighbors[k].count = 0;
+    return k;
+}
+
+// 윈도우에서 밀려나는 history 한 칸을 누적 합에서 빼기
+static inline void ue_window_evict(ue_window_t* w, int slot) {
+    ue_window_slot_t const* h = &w->history[slot];
+    if (!isnan(h->serving_sinr)) {
+        w->serving_sinr_sum -= h->serving_sinr;
+        w->serving_valid_count--;
+    }
+    for (int j = 0; j < h->active_neighbor_count; j++) {
+        int k = ue_window_find_neighbor(w, h->neighbor_ids[j], false);
+        if (k < 0) continue;
+        w->window_neighbors[k].sinr_sum -= h->neighbor_sinrs[j];
+        w->window_neighbors[k].count--;
+        // 윈도우에서 사라진 cell 은 마지막 항목으로 덮어쓰기
+        if (w->window_neighbors[k].count == 0) {
+            w->window_neighbors[k] = w->window_neighbors[--w->window_neighbor_count];
+        }
+    }
+    if (w->serving_valid_count == 0) {
+        w->serving_sinr_sum = 0.0;
+    }
+}
+
+// 더하고 빼는 과정의 반올림 오차가 쌓이지 않도록 윈도우 한 바퀴마다 다시 합산
+static inline void ue_window_resync(ue_window_t* w) {
+    w->serving_sinr_sum = 0.0;
+    w->serving_valid_count = 0;
+    for (int k = 0; k < w->window_neighbor_count; k++) {
+        w->window_neighbors[k].sinr_sum = 0.0;
+    }
+    for (int i = 0; i < w->history_count; i++) {
+        ue_window_slot_t const* h = &w->history[i];
+        if (!isnan(h->serving_sinr)) {
+            w->serving_sinr_sum += h->serving_sinr;
+            w->serving_valid_count++;
+        }
+        for (int j = 0; j < h->active_neighbor_count; j++) {
+            int k = ue_window_find_neighbor(w, h->neighbor_ids[j], false);
+            if (k >= 0) {
+                w->window_neighbors[k].sinr_sum += h->neighbor_sinrs[j];
+            }
+        }
+    }
+    w->samples_since_resync = 0;
+}
+
+// serving 샘플: 새 history 칸 (윈도우가 가득 찼으면 가장 오래된 칸을 덮어씀)
+static inline void ue_window_add_serving(ue_window_t* w, ue_window_cfg_t const* cfg, uint16_t cellID, double sinr,
+                                         uint64_t timestamp, uint64_t sequence) {
+    w->servingCellID = cellID;
+    w->last_timestamp = timestamp;
+
+    if (w->history_count == cfg->size) {
+        ue_window_evict(w, w->history_idx);
+    }
+    if (!isnan(sinr)) {
+        w->serving_sinr_sum += sinr;
+        w->serving_valid_count++;
+    }
+
+    ue_window_slot_t* h = &w->history[w->history_idx];
+    h->serving_sinr = sinr;
+    h->timestamp = sequence;
+    h->active_neighbor_count = 0;
+
+    w->history_idx = (w->history_idx + 1) % cfg->size;
+    if (w->history_count < cfg->size) {
+        w->history_count++;
+    }
+    w->total_samples++;
+    if (++w->samples_since_resync >= cfg->size) {
+        ue_window_resync(w);
+    }
+}
+
+// neighbor 샘플: 마지막 serving 샘플의 칸에 붙임
+static inline void ue_window_add_neighbor(ue_window_t* w, ue_window_cfg_t const* cfg, uint16_t cellID, double sinr) {
+    // serving cell 과 같은 neighbor, 아직 serving 샘플이 없는 UE, NaN / cellID 0 은 저장하지 않음
+    if (cellID == w->servingCellID || w->history_count == 0 || isnan(sinr) || cellID == 0) {
+        return;
+    }
+
+    ue_window_slot_t* h = &w->history[(w->history_idx - 1 + cfg->size) % cfg->size];
+    if (h->active_neighbor_count >= UE_WINDOW_SLOT_NEIGHBORS) {
+        return;
+    }
+    int k = ue_window_find_neighbor(w, cellID, true);
+    if (k < 0) {
+        return;  // 윈도우 안 neighbor cell 이 UE_WINDOW_MAX_NEIGHBORS 개를 넘음
+    }
+    w->window_neighbors[k].sinr_sum += sinr;
+    w->window_neighbors[k].count++;
+
+    h->neighbor_ids[h->active_neighbor_count] = cellID;
+    h->neighbor_sinrs[h->active_neighbor_count] = sinr;
+    h->active_neighbor_count++;
+}
+
+// serving SINR 윈도우 평균 (NaN 제외, 유효한 샘플이 없으면 NaN)
+static inline double ue_window_serving_ma(ue_window_t const* w) {
+    return w->serving_valid_count > 0 ? w->serving_sinr_sum / w->serving_valid_count : NAN;
+}
+
+// 윈도우 평균이 높은 neighbor 상위 k 개 (정렬 없이 부분 선택), 채운 개수를 반환
+// serving cell 과 같은 cell, 윈도우 안 샘플이 min_neighbor_samples 개 미만인 cell 제외
+static inline int ue_window_top_neighbors(ue_window_t const* w, ue_window_cfg_t const* cfg, int k,
+                                          ue_window_neighbor_t* out) {
+    int n = 0;
+    for (int i = 0; i < w->window_neighbor_count; i++) {
+        if (w->window_neighbors[i].count < cfg->min_neighbor_samples ||
+            w->window_neighbors[i].cellID == w->servingCellID) {
+            continue;
+        }
+        double avg = w->window_neighbors[i].sinr_sum / w->window_neighbors[i].count;
+
+        int pos = n < k ? n++ : k;
+        while (pos > 0 && out[pos - 1].sinr < avg) {
+            if (pos < k) out[pos] = out[pos - 1];
+            pos--;
+        }
+        if (pos < k) {
+            out[pos].cellID = w->window_neighbors[i].cellID;
+            out[pos].sinr = avg;
+        }
+    }
+    return n;
+}
+
+// =============================================================================
+// WINDOW SET (sequence 단위 방출)
+// =============================================================================
+
+typedef void (*ue_window_emit_fn)(ue_window_t* w, uint64_t sequence, void* ctx);
+
+typedef struct {
+    ue_window_cfg_t cfg;
+    ue_table_t ues;              // ueID -> ue_window_t
+    ue_window_t** pending;       // 이번 sequence 에 serving 샘플이 온 UE (도착 순서)
+    size_t num_pending;
+    size_t pending_cap;
+    bool has_sequence;
+    uint64_t sequence;
+    ue_window_emit_fn emit;
+    void* ctx;
+} ue_window_set_t;
+
+static inline void ue_window_set_init(ue_window_set_t* s, ue_window_cfg_t cfg, ue_window_emit_fn emit, void* ctx) {
+    memset(s, 0, sizeof(*s));
+    if (cfg.size < 1) cfg.size = 1;
+    if (cfg.size > UE_WINDOW_MAX) cfg.size = UE_WINDOW_MAX;
+    s->cfg = cfg;
+    ue_table_init(&s->ues, sizeof(ue_window_t));
+    s->emit = emit;
+    s->ctx = ctx;
+}
+
+// ueID 의 윈도우 (없으면 생성, created 로 알림), 메모리 부족이면 NULL
+static inline ue_window_t* ue_window_set_get(ue_window_set_t* s, uint16_t ueID, bool* created) {
+    ue_window_t* w = ue_table_get_or_create(&s->ues, ueID, created);
+    if (w != NULL && *created) {
+        w->ueID = ueID;
+    }
+    return w;
+}
+
+static inline size_t ue_window_set_count(ue_window_set_t const* s) {
+    return ue_table_count(&s->ues);
+}
+
+// 현재 sequence 에 serving 샘플을 받은 UE 를 도착 순서대로 한 번씩 방출
+static inline void ue_window_set_flush(ue_window_set_t* s) {
+    for (size_t i = 0; i < s->num_pending; i++) {
+        ue_window_t* w = s->pending[i];
+        w->pending = false;
+        if (s->emit != NULL) {
+            s->emit(w, s->sequence, s->ctx);
+        }
+    }
+    s->num_pending = 0;
+}
+
+static inline void ue_window_set_add_serving(ue_window_set_t* s, ue_window_t* w, uint16_t cellID, double sinr,
+                                             uint64_t timestamp, uint64_t sequence) {
+    if (s->has_sequence && sequence != s->sequence) {
+        ue_window_set_flush(s);
+    }
+    s->has_sequence = true;
+    s->sequence = sequence;
+
+    ue_window_add_serving(w, &s->cfg, cellID, sinr, timestamp, sequence);
+    if (!w->pending) {
+        if (s->num_pending == s->pending_cap) {
+            size_t cap = s->pending_cap ? s->pending_cap * 2 : 64;
+            ue_window_t** grown = realloc(s->pending, cap * sizeof(ue_window_t*));
+            if (grown == NULL) {
+                return;   // 메모리 부족: 이번 sequence 에는 방출하지 않음
+            }
+            s->pending = grown;
+            s->pending_cap = cap;
+        }
+        w->pending = true;
+        s->pending[s->num_pending++] = w;
+    }
+}
+
+static inline void ue_window_set_add_neighbor(ue_window_set_t* s, ue_window_t* w, uint16_t cellID, double sinr) {
+    ue_window_add_neighbor(w, &s->cfg, cellID, sinr);
+}
+
+static inline void ue_window_set_free(ue_window_set_t* s) {
+    ue_table_free(&s->ues);
+    free(s->pending);
+    s->pending = NULL;
+    s->num_pending = 0;
+    s->pending_cap = 0;
+    s->has_sequence = false;
+}
+
+#endif // UE_WINDOW_H
@@ -0,0 +1,451 @@
+/*
+ * Asynchronous buffered logger shared by the xApps
+ * 🔥 줄마다 fflush 대신 스레드별 버퍼 + 백그라운드 flush 스레드
+ *
+ * A sink is an output file (csv, log) or the console. Each thread appends to
+ * its own buffer per sink, so writers never wait on the disk or on each
+ * other: the flusher thread moves the buffers to the file every
+ * XAPP_LOG_FLUSH_MS (default 200 ms), or sooner once a buffer holds
+ * XAPP_LOG_FLUSH_BYTES (default 64 KiB). A thread whose buffer grows past
+ * 16x that size (disk slower than the producers) writes it out itself.
+ * Lines of one thread stay in order; lines of different threads are
+ * interleaved at the granularity of a write, so a line should be written by
+ * one call (or at least by one thread).
+ *
+ * Console messages have a level (XAPP_LOG_LEVEL = error|warn|info|debug,
+ * default info): per-UE progress is debug and not even formatted otherwise.
+ *
+ * With XAPP_LOG_COMPRESS=1 the files are written as <path>.gz, one gzip
+ * member per flush (readable by zcat / pandas). Compression needs zlib:
+ * build with -DXLOG_ZLIB -lz, otherwise the files stay plain text.
+ *
+ * xlog_shutdown flushes everything; data of the last flush period is lost
+ * if the process dies without it.
+ */
+
+#ifndef XAPP_LOGGER_H
+#define XAPP_LOGGER_H
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#ifdef XLOG_ZLIB
+#include <zlib.h>
+#endif
+
+#define XLOG_MAX_SINKS 8
+#define XLOG_DEFAULT_FLUSH_MS 200
+#define XLOG_DEFAULT_FLUSH_BYTES (64 * 1024)
+#define XLOG_SYNC_FACTOR 16
+
+typedef enum {
+    XLOG_ERROR = 0,
+    XLOG_WARN,
+    XLOG_INFO,
+    XLOG_DEBUG,
+} xlog_level_e;
+
+typedef struct xlog_buffer {
+    pthread_mutex_t mtx;         // owner thread vs flusher
+    char* data;
+    size_t len;
+    size_t cap;
+    struct xlog_buffer* next;
+} xlog_buffer_t;
+
+typedef struct {
+    int id;
+    FILE* fp;
+    bool console;
+    bool gzip;
+    char path[256];
+    pthread_mutex_t mtx;         // fp, buffers list, scratch
+    xlog_buffer_t* buffers;
+    char* scratch;               // data taken from a buffer, written outside its lock
+    size_t scratch_cap;
+    unsigned char* deflated;
+    size_t deflated_cap;
+} xlog_sink_t;
+
+static struct {
+    bool started;
+    xlog_level_e level;
+    unsigned flush_ms;
+    size_t flush_bytes;
+    bool compress;
+
+    pthread_t flusher;
+    pthread_mutex_t mtx;         // sinks[], stop, cond
+    pthread_cond_t cond;
+    bool stop;
+    xlog_sink_t* sinks[XLOG_MAX_SINKS];   // index = sink id (스레드 버퍼 index), 재사용 안 함
+    int num_sinks;
+
+    xlog_sink_t console;
+} xlog_g = { .level = XLOG_INFO, .console = { .console = true } };
+
+static __thread xlog_buffer_t* xlog_tls[XLOG_MAX_SINKS];
+
+// =============================================================================
+// OUTPUT (sink->mtx 안)
+// =============================================================================
+
+static inline void xlog_sink_write_out(xlog_sink_t* s, const char* data, size_t len) {
+    if (len == 0 || s->fp == NULL) {
+        return;
+    }
+#ifdef XLOG_ZLIB
+    if (s->gzip) {
+        // 독립된 gzip member 하나
+        size_t bound = compressBound(len) + 32;
+        if (bound > s->deflated_cap) {
+            unsigned char* grown = realloc(s->deflated, bound);
+            if (grown == NULL) {
+                return;
+            }
+            s->deflated = grown;
+            s->deflated_cap = bound;
+        }
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return;
+        }
+        zs.next_in = (unsigned char*)data;
+        zs.avail_in = (uInt)len;
+        zs.next_out = s->deflated;
+        zs.avail_out = (uInt)s->deflated_cap;
+        deflate(&zs, Z_FINISH);
+        fwrite(s->deflated, 1, zs.total_out, s->fp);
+        deflateEnd(&zs);
+        return;
+    }
+#endif
+    fwrite(data, 1, len, s->fp);
+}
+
+// 한 스레드 버퍼를 파일로 (버퍼 lock 은 교체하는 동안만)
+static inline void xlog_drain_buffer(xlog_sink_t* s, xlog_buffer_t* b) {
+    pthread_mutex_lock(&b->mtx);
+    char* data = b->data;
+    size_t len = b->len;
+    size_t cap = b->cap;
+    b->data = s->scratch;
+    b->cap = s->scratch_cap;
+    b->len = 0;
+    pthread_mutex_unlock(&b->mtx);
+
+    xlog_sink_write_out(s, data, len);
+    s->scratch = data;
+    s->scratch_cap = cap;
+}
+
+static inline void xlog_flush(xlog_sink_t* s) {
+    if (s == NULL || s->fp == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&s->mtx);
+    for (xlog_buffer_t* b = s->buffers; b != NULL; b = b->next) {
+        xlog_drain_buffer(s, b);
+    }
+    if (s->fp != NULL) {
+        fflush(s->fp);
+    }
+    pthread_mutex_unlock(&s->mtx);
+}
+
+// xlog_g.mtx 안 (xlog_close 와 겹치지 않도록)
+static inline void xlog_flush_all_locked(void) {
+    for (int i = 0; i < xlog_g.num_sinks; i++) {
+        xlog_flush(xlog_g.sinks[i]);
+    }
+}
+
+static inline void xlog_flush_all(void) {
+    pthread_mutex_lock(&xlog_g.mtx);
+    xlog_flush_all_locked();
+    pthread_mutex_unlock(&xlog_g.mtx);
+}
+
+static inline void* xlog_flusher_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&xlog_g.mtx);
+    while (!xlog_g.stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += xlog_g.flush_ms / 1000;
+        deadline.tv_nsec += (long)(xlog_g.flush_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&xlog_g.cond, &xlog_g.mtx, &deadline);
+        xlog_flush_all_locked();
+    }
+    pthread_mutex_unlock(&xlog_g.mtx);
+    return NULL;
+}
+
+// =============================================================================
+// WRITE
+// =============================================================================
+
+static inline xlog_buffer_t* xlog_thread_buffer(xlog_sink_t* s) {
+    xlog_buffer_t* b = xlog_tls[s->id];
+    if (b != NULL) {
+        return b;
+    }
+    b = calloc(1, sizeof(xlog_buffer_t));
+    if (b == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&b->mtx, NULL);
+    // 생성 순서대로 drain: 먼저 쓰기 시작한 스레드 (csv 헤더) 가 앞
+    pthread_mutex_lock(&s->mtx);
+    xlog_buffer_t** tail = &s->buffers;
+    while (*tail != NULL) {
+        tail = &(*tail)->next;
+    }
+    *tail = b;
+    pthread_mutex_unlock(&s->mtx);
+    xlog_tls[s->id] = b;
+    return b;
+}
+
+// 버퍼에 len 바이트 이상 여유 (b->mtx 안)
+static inline bool xlog_reserve(xlog_buffer_t* b, size_t len) {
+    if (b->len + len <= b->cap) {
+        return true;
+    }
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + len) {
+        cap *= 2;
+    }
+    char* grown = realloc(b->data, cap);
+    if (grown == NULL) {
+        return false;
+    }
+    b->data = grown;
+    b->cap = cap;
+    return true;
+}
+
+static inline void xlog_after_write(xlog_sink_t* s, size_t used) {
+    if (used >= XLOG_SYNC_FACTOR * xlog_g.flush_bytes || !xlog_g.started) {
+        xlog_flush(s);   // flusher 가 밀리면 (또는 없으면) 직접
+    } else if (used >= xlog_g.flush_bytes) {
+        pthread_cond_signal(&xlog_g.cond);
+    }
+}
+
+static inline void xlog_write(xlog_sink_t* s, const char* data, size_t len) {
+    if (s == NULL) {
+        return;
+    }
+    xlog_buffer_t* b = xlog_thread_buffer(s);
+    if (b == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&b->mtx);
+    size_t used = b->len;
+    if (xlog_reserve(b, len)) {
+        memcpy(b->data + b->len, data, len);
+        b->len += len;
+        used = b->len;
+    }
+    pthread_mutex_unlock(&b->mtx);
+    xlog_after_write(s, used);
+}
+
+static inline void xlog_vprintf(xlog_sink_t* s, const char* format, va_list args) {
+    if (s == NULL) {
+        return;
+    }
+    if (s->console && !xlog_g.started) {
+        vprintf(format, args);   // xlog_init 전 / xlog_shutdown 후
+        return;
+    }
+    xlog_buffer_t* b = xlog_thread_buffer(s);
+    if (b == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&b->mtx);
+    va_list retry;
+    va_copy(retry, args);
+    int n = xlog_reserve(b, 256) ? vsnprintf(b->data + b->len, b->cap - b->len, format, args) : -1;
+    if (n >= 0 && (size_t)n >= b->cap - b->len) {
+        n = xlog_reserve(b, (size_t)n + 1) ? vsnprintf(b->data + b->len, b->cap - b->len, format, retry) : -1;
+    }
+    va_end(retry);
+    if (n > 0) {
+        b->len += (size_t)n;
+    }
+    size_t used = b->len;
+    pthread_mutex_unlock(&b->mtx);
+    xlog_after_write(s, used);
+}
+
+static inline void xlog_printf(xlog_sink_t* s, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static inline void xlog_printf(xlog_sink_t* s, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    xlog_vprintf(s, format, args);
+    va_end(args);
+}
+
+// 레벨 없이 콘솔로 (화면 출력이 곧 데이터인 monitor xApp 용)
+static inline xlog_sink_t* xlog_console(void) {
+    return &xlog_g.console;
+}
+
+static inline bool xlog_enabled(xlog_level_e level) {
+    return level <= xlog_g.level;
+}
+
+// 콘솔 메시지 (level 이 꺼져 있으면 포맷도 안 함)
+static inline void xlog_msg(xlog_level_e level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static inline void xlog_msg(xlog_level_e level, const char* format, ...) {
+    if (!xlog_enabled(level)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    xlog_vprintf(&xlog_g.console, format, args);
+    va_end(args);
+}
+
+#define xlog_error(...) xlog_msg(XLOG_ERROR, __VA_ARGS__)
+#define xlog_warn(...)  xlog_msg(XLOG_WARN, __VA_ARGS__)
+#define xlog_info(...)  xlog_msg(XLOG_INFO, __VA_ARGS__)
+#define xlog_debug(...) xlog_msg(XLOG_DEBUG, __VA_ARGS__)
+
+// =============================================================================
+// SINKS / LIFECYCLE
+// =============================================================================
+
+static inline bool xlog_register(xlog_sink_t* s) {
+    pthread_mutex_lock(&xlog_g.mtx);
+    bool ok = xlog_g.num_sinks < XLOG_MAX_SINKS;
+    if (ok) {
+        s->id = xlog_g.num_sinks;
+        xlog_g.sinks[xlog_g.num_sinks++] = s;
+    }
+    pthread_mutex_unlock(&xlog_g.mtx);
+    return ok;
+}
+
+static inline xlog_level_e xlog_parse_level(const char* v) {
+    if (v == NULL) return XLOG_INFO;
+    if (strcasecmp(v, "error") == 0 || strcmp(v, "0") == 0) return XLOG_ERROR;
+    if (strcasecmp(v, "warn") == 0 || strcmp(v, "1") == 0) return XLOG_WARN;
+    if (strcasecmp(v, "debug") == 0 || strcmp(v, "3") == 0) return XLOG_DEBUG;
+    return XLOG_INFO;
+}
+
+// 프로그램 시작 시 한 번 (환경변수 읽고 콘솔 sink + flush 스레드 시작)
+static inline void xlog_init(void) {
+    if (xlog_g.started) {
+        return;
+    }
+    const char* v;
+    xlog_g.level = xlog_parse_level(getenv("XAPP_LOG_LEVEL"));
+    xlog_g.flush_ms = (v = getenv("XAPP_LOG_FLUSH_MS")) != NULL && atoi(v) > 0 ? (unsigned)atoi(v) : XLOG_DEFAULT_FLUSH_MS;
+    xlog_g.flush_bytes = (v = getenv("XAPP_LOG_FLUSH_BYTES")) != NULL && atol(v) > 0 ? (size_t)atol(v) : XLOG_DEFAULT_FLUSH_BYTES;
+    xlog_g.compress = (v = getenv("XAPP_LOG_COMPRESS")) != NULL && atoi(v) != 0;
+#ifndef XLOG_ZLIB
+    if (xlog_g.compress) {
+        fprintf(stderr, "⚠️  XAPP_LOG_COMPRESS needs a build with -DXLOG_ZLIB -lz, writing plain files\n");
+        xlog_g.compress = false;
+    }
+#endif
+
+    pthread_mutex_init(&xlog_g.mtx, NULL);
+    pthread_cond_init(&xlog_g.cond, NULL);
+    xlog_g.stop = false;
+
+    xlog_sink_t* c = &xlog_g.console;
+    memset(c, 0, sizeof(*c));
+    pthread_mutex_init(&c->mtx, NULL);
+    c->fp = stdout;
+    c->console = true;
+    snprintf(c->path, sizeof(c->path), "stdout");
+    xlog_register(c);
+
+    xlog_g.started = pthread_create(&xlog_g.flusher, NULL, xlog_flusher_main, NULL) == 0;
+}
+
+// 데이터/로그 파일 (XAPP_LOG_COMPRESS 면 <path>.gz), 실패하면 NULL
+static inline xlog_sink_t* xlog_open(const char* path) {
+    xlog_sink_t* s = calloc(1, sizeof(xlog_sink_t));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->gzip = xlog_g.compress;
+    snprintf(s->path, sizeof(s->path), "%s%s", path, s->gzip ? ".gz" : "");
+    pthread_mutex_init(&s->mtx, NULL);
+    s->fp = fopen(s->path, s->gzip ? "wb" : "w");
+    if (s->fp == NULL || !xlog_register(s)) {
+        if (s->fp != NULL) {
+            fclose(s->fp);
+        }
+        pthread_mutex_destroy(&s->mtx);
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+static inline const char* xlog_path(xlog_sink_t const* s) {
+    return s != NULL ? s->path : "";
+}
+
+// 남은 데이터를 쓰고 닫음 (다른 스레드가 더 이상 쓰지 않을 때)
+static inline void xlog_close(xlog_sink_t* s) {
+    if (s == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&xlog_g.mtx);
+    xlog_g.sinks[s->id] = NULL;
+    pthread_mutex_unlock(&xlog_g.mtx);
+
+    xlog_flush(s);
+    for (xlog_buffer_t* b = s->buffers; b != NULL;) {
+        xlog_buffer_t* next = b->next;
+        pthread_mutex_destroy(&b->mtx);
+        free(b->data);
+        free(b);
+        b = next;
+    }
+    s->buffers = NULL;
+    if (!s->console) {
+        fclose(s->fp);
+    }
+    free(s->scratch);
+    free(s->deflated);
+    pthread_mutex_destroy(&s->mtx);
+    if (!s->console) {
+        free(s);
+    }
+}
+
+// 프로그램 종료 시: flush 스레드 정지, 모든 sink flush
+static inline void xlog_shutdown(void) {
+    if (!xlog_g.started) {
+        return;
+    }
+    pthread_mutex_lock(&xlog_g.mtx);
+    xlog_g.stop = true;
+    pthread_cond_signal(&xlog_g.cond);
+    pthread_mutex_unlock(&xlog_g.mtx);
+    pthread_join(xlog_g.flusher, NULL);
+    xlog_g.started = false;
+    xlog_flush_all();
+}
+
+#endif // XAPP_LOGGER_H